@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cstring>
+
+#include "archetype.hpp"
+
+namespace
+{
+
+auto alignUp(std::size_t value, std::size_t alignment) -> std::size_t
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+Archetype::Archetype(ComponentMask mask)
+    : componentMask(mask)
+{
+  std::size_t rowBytes = 0;
+  for (ComponentMask bits = mask; bits != 0; bits &= bits - 1) {
+    const auto id = static_cast<ComponentId>(std::countr_zero(bits));
+    const auto& info = componentInfo(id);
+    columns.push_back({.id = id, .size = info.size, .offset = 0});
+    rowBytes += info.size;
+  }
+
+  // As many rows as fit after the worst case padding between arrays
+  const std::size_t padding = columns.size() * cacheLineSize;
+  if (rowBytes > 0 && chunkBytes > padding) {
+    capacity = (chunkBytes - padding) / rowBytes / minChunkRows * minChunkRows;
+  } else if (rowBytes == 0) {
+    capacity = chunkBytes;
+  }
+  capacity = std::max(capacity, minChunkRows);
+
+  std::size_t offset = 0;
+  for (auto& column : columns) {
+    column.offset = offset;
+    offset = alignUp(offset + column.size * capacity, cacheLineSize);
+  }
+  bytesPerChunk = std::max(offset, cacheLineSize);
+}
+
+auto Archetype::append(Entity entity) -> std::size_t
+{
+  const std::size_t row = entities.size();
+  if (row == chunks.size() * capacity) {
+    chunks.emplace_back(bytesPerChunk);
+  } else {
+    // Rows freed by remove() keep their old values
+    for (const auto& column : columns) {
+      std::memset(component(column.id, row), 0, column.size);
+    }
+  }
+  entities.push_back(entity);
+  return row;
+}
+
+auto Archetype::remove(std::size_t row) -> Entity
+{
+  const std::size_t last = entities.size() - 1;
+  Entity moved;
+  if (row != last) {
+    for (const auto& column : columns) {
+      std::memcpy(
+          component(column.id, row), component(column.id, last), column.size);
+    }
+    entities[row] = entities[last];
+    moved = entities[row];
+  }
+  entities.pop_back();
+
+  // Free the last chunk once it is empty
+  if (entities.size() == (chunks.size() - 1) * capacity) {
+    chunks.pop_back();
+  }
+  return moved;
+}
+
+void Archetype::copyRow(std::size_t row,
+                        Archetype& source,
+                        std::size_t sourceRow)
+{
+  for (const auto& column : columns) {
+    if (source.has(column.id)) {
+      std::memcpy(component(column.id, row),
+                  source.component(column.id, sourceRow),
+                  column.size);
+    }
+  }
+}
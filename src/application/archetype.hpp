@@ -0,0 +1,142 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "component.hpp"
+#include "entities.hpp"
+
+// Generational reference to an entity in a World. A handle whose entity has
+// since been destroyed, and its slot possibly reused, is detected as stale
+// through its generation.
+struct Entity
+{
+  static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+  uint32_t index = invalidIndex;
+  uint32_t generation = 0;
+
+  [[nodiscard]] auto isValid() const -> bool { return index != invalidIndex; }
+
+  auto operator<=>(const Entity&) const = default;
+};
+
+// All entities with exactly the same set of components.
+//
+// Rows are packed into fixed-size chunks with one contiguous, cache-line
+// aligned array per component, so a query touches only the arrays it asks
+// for and hands every chunk to a single thread without sharing cache lines
+// with the next one. Rows stay dense: every chunk but the last is full, and
+// removing a row moves the last row into the hole.
+class Archetype
+{
+public:
+  // Target chunk size. Large enough that each array spans a few pages, so
+  // the hardware prefetchers keep up across a chunk; an archetype whose rows
+  // are too large for minChunkRows of them gets bigger chunks.
+  static constexpr std::size_t chunkBytes = 64 * 1024;
+
+  // Rows per chunk are a multiple of this, so arrays of 4-byte components
+  // end on cache line boundaries and fill whole SIMD registers
+  static constexpr std::size_t minChunkRows = 16;
+
+  explicit Archetype(ComponentMask mask);
+  ~Archetype() = default;
+
+  Archetype(const Archetype&) = delete;
+  Archetype& operator=(const Archetype&) = delete;
+  Archetype(Archetype&&) = delete;
+  Archetype& operator=(Archetype&&) = delete;
+
+  [[nodiscard]] auto mask() const -> ComponentMask { return componentMask; }
+
+  [[nodiscard]] auto has(ComponentId id) const -> bool
+  {
+    return (componentMask & (ComponentMask {1} << id)) != 0;
+  }
+
+  [[nodiscard]] auto size() const -> std::size_t { return entities.size(); }
+
+  [[nodiscard]] auto chunkCapacity() const -> std::size_t { return capacity; }
+
+  [[nodiscard]] auto chunkCount() const -> std::size_t
+  {
+    return chunks.size();
+  }
+
+  [[nodiscard]] auto chunkSize(std::size_t chunk) const -> std::size_t
+  {
+    return chunk + 1 < chunks.size() ? capacity
+                                     : entities.size() - chunk * capacity;
+  }
+
+  [[nodiscard]] auto entityAt(std::size_t row) const -> Entity
+  {
+    return entities[row];
+  }
+
+  // The array of component id in chunk. The archetype must have it.
+  auto column(ComponentId id, std::size_t chunk) -> std::byte*
+  {
+    return chunks[chunk].data() + columns[columnIndex(id)].offset;
+  }
+
+  template <Component T>
+  auto column(std::size_t chunk) -> typename T::Value*
+  {
+    return reinterpret_cast<typename T::Value*>(
+        column(componentId<T>(), chunk));
+  }
+
+  auto component(ComponentId id, std::size_t row) -> std::byte*
+  {
+    return column(id, row / capacity)
+        + (row % capacity) * columns[columnIndex(id)].size;
+  }
+
+  template <Component T>
+  auto component(std::size_t row) -> typename T::Value&
+  {
+    return *reinterpret_cast<typename T::Value*>(
+        component(componentId<T>(), row));
+  }
+
+  // Adds a row for entity with zeroed components and returns it
+  auto append(Entity entity) -> std::size_t;
+
+  // Removes row by moving the last row into it. Returns the entity that
+  // moved into row, or an invalid one if row was the last.
+  auto remove(std::size_t row) -> Entity;
+
+  // Copies the components both archetypes have from source's sourceRow
+  void copyRow(std::size_t row, Archetype& source, std::size_t sourceRow);
+
+private:
+  struct Column
+  {
+    ComponentId id;
+    std::size_t size;
+    std::size_t offset;  // From the start of the chunk
+  };
+
+  using Chunk =
+      std::vector<std::byte, AlignedAllocator<std::byte, cacheLineSize>>;
+
+  ComponentMask componentMask;
+  std::vector<Column> columns;  // In id order
+  std::size_t capacity = minChunkRows;
+  std::size_t bytesPerChunk = 0;
+
+  std::vector<Chunk> chunks;
+  std::vector<Entity> entities;  // By row
+
+  // Columns are in id order, so a column's index is the number of lower ids
+  [[nodiscard]] auto columnIndex(ComponentId id) const -> std::size_t
+  {
+    const ComponentMask lower = (ComponentMask {1} << id) - 1;
+    return static_cast<std::size_t>(std::popcount(componentMask & lower));
+  }
+};
@@ -0,0 +1,33 @@
+#include <array>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include "component.hpp"
+
+namespace
+{
+
+// Ids are handed out once per type, but possibly from several threads
+std::mutex registryMutex;
+std::array<ComponentInfo, maxComponents> registry;
+ComponentId registered = 0;
+
+}  // namespace
+
+auto registerComponent(const ComponentInfo& info) -> ComponentId
+{
+  const std::scoped_lock lock(registryMutex);
+  if (registered == maxComponents) {
+    throw std::runtime_error("Too many component types, cannot register "
+                             + std::string(info.name) + ".");
+  }
+  registry[registered] = info;
+  return registered++;
+}
+
+auto componentInfo(ComponentId id) -> const ComponentInfo&
+{
+  const std::scoped_lock lock(registryMutex);
+  return registry[id];
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "entities.hpp"
+
+// Components are named by tag types that declare the Value they store. This
+// lets scalar components such as PositionX live in plain float arrays the
+// entity kernels stream through, while two components of the same Value
+// type stay distinct. Values are moved between chunks with memcpy, so they
+// must be trivially copyable.
+template <typename T>
+concept Component = requires {
+  typename T::Value;
+  { T::name } -> std::convertible_to<const char*>;
+} && std::is_trivially_copyable_v<typename T::Value>
+    && alignof(typename T::Value) <= cacheLineSize;
+
+using ComponentId = uint32_t;
+
+// One bit per component; an archetype is identified by its mask
+using ComponentMask = uint64_t;
+
+constexpr ComponentId maxComponents = 64;
+
+struct ComponentInfo
+{
+  std::size_t size;
+  std::size_t alignment;
+  const char* name;
+};
+
+// Assigns the next id. Throws std::runtime_error past maxComponents.
+auto registerComponent(const ComponentInfo& info) -> ComponentId;
+
+auto componentInfo(ComponentId id) -> const ComponentInfo&;
+
+// Ids are assigned on first use, so they depend on the order in which
+// component types are first touched and are only stable within a run
+template <Component T>
+auto componentId() -> ComponentId
+{
+  static const ComponentId id =
+      registerComponent({.size = sizeof(typename T::Value),
+                         .alignment = alignof(typename T::Value),
+                         .name = T::name});
+  return id;
+}
+
+template <Component... Ts>
+auto componentMask() -> ComponentMask
+{
+  return (ComponentMask {0} | ... | (ComponentMask {1} << componentId<Ts>()));
+}
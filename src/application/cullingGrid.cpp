@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include "cullingGrid.hpp"
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+auto millisecondsSince(Clock::time_point start) -> double
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+CullingGrid::CullingGrid(float cellSize,
+                         std::size_t cellsPerTask,
+                         SimdLevel level)
+    : cellSize(cellSize)
+    , cellsPerTask(cellsPerTask)
+    , kernel(cullKernel(level))
+{
+}
+
+void CullingGrid::build(const SphereSpan& spheres)
+{
+  const auto start = Clock::now();
+  const std::size_t count = spheres.count;
+
+  cells.clear();
+  centerX.resize(count);
+  centerY.resize(count);
+  centerZ.resize(count);
+  radius.resize(count);
+  sourceIndex.resize(count);
+  cellOfSphere.resize(count);
+  if (count == 0) {
+    stats = {.buildMilliseconds = millisecondsSince(start)};
+    return;
+  }
+
+  glm::vec3 lo(std::numeric_limits<float>::max());
+  glm::vec3 hi(std::numeric_limits<float>::lowest());
+  for (std::size_t i = 0; i < count; i++) {
+    const glm::vec3 center(
+        spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i]);
+    lo = glm::min(lo, center);
+    hi = glm::max(hi, center);
+  }
+
+  // Cells cover the centers only; spheres may stick out of them
+  const std::array<float, 3> origin = {lo.x, lo.y, lo.z};
+  const std::array<float, 3> extents = {
+      hi.x - lo.x, hi.y - lo.y, hi.z - lo.z};
+  std::array<uint32_t, 3> dims {};
+  std::array<float, 3> scale {};
+  for (std::size_t axis = 0; axis < 3; axis++) {
+    const float extent = extents[axis];
+    const auto cellsAlong = std::ceil(extent / cellSize);
+    dims[axis] = std::clamp(static_cast<uint32_t>(cellsAlong),
+                            1U,
+                            maxCellsPerAxis);
+    scale[axis] =
+        extent > 0.0F ? static_cast<float>(dims[axis]) / extent : 0.0F;
+  }
+  const auto cellAlong = [&](float coordinate, std::size_t axis)
+  {
+    const auto cell =
+        static_cast<uint32_t>((coordinate - origin[axis]) * scale[axis]);
+    return std::min(cell, dims[axis] - 1);
+  };
+
+  // Counting sort by cell: count, then turn the counts into starts
+  cellStart.assign((std::size_t {dims[0]} * dims[1] * dims[2]) + 1, 0);
+  for (std::size_t i = 0; i < count; i++) {
+    const uint32_t cell = cellAlong(spheres.centerX[i], 0)
+        + (dims[0]
+           * (cellAlong(spheres.centerY[i], 1)
+              + (dims[1] * cellAlong(spheres.centerZ[i], 2))));
+    cellOfSphere[i] = cell;
+    cellStart[cell + 1]++;
+  }
+  for (std::size_t cell = 1; cell < cellStart.size(); cell++) {
+    cellStart[cell] += cellStart[cell - 1];
+  }
+
+  // Scattering advances each start to the next cell's
+  for (std::size_t i = 0; i < count; i++) {
+    const uint32_t slot = cellStart[cellOfSphere[i]]++;
+    centerX[slot] = spheres.centerX[i];
+    centerY[slot] = spheres.centerY[i];
+    centerZ[slot] = spheres.centerZ[i];
+    radius[slot] = spheres.radius[i];
+    sourceIndex[slot] = static_cast<uint32_t>(i);
+  }
+
+  uint32_t first = 0;
+  for (std::size_t cell = 0; cell + 1 < cellStart.size(); cell++) {
+    const uint32_t last = cellStart[cell];
+    if (last == first) {
+      continue;
+    }
+
+    glm::vec3 centersMin(std::numeric_limits<float>::max());
+    glm::vec3 centersMax(std::numeric_limits<float>::lowest());
+    float maxRadius = 0.0F;
+    for (uint32_t i = first; i < last; i++) {
+      const glm::vec3 center(centerX[i], centerY[i], centerZ[i]);
+      centersMin = glm::min(centersMin, center);
+      centersMax = glm::max(centersMax, center);
+      maxRadius = std::max(maxRadius, radius[i]);
+    }
+    cells.push_back({.boundsMin = centersMin - maxRadius,
+                     .boundsMax = centersMax + maxRadius,
+                     .first = first,
+                     .count = last - first});
+    first = last;
+  }
+
+  stats = {.objects = static_cast<uint32_t>(count),
+           .cells = static_cast<uint32_t>(cells.size()),
+           .buildMilliseconds = millisecondsSince(start)};
+}
+
+auto CullingGrid::cull(const FrustumPlanes& planes, TaskScheduler& scheduler)
+    -> std::span<const uint32_t>
+{
+  const auto start = Clock::now();
+  const SphereSpan spheres = sorted();
+
+  visible.resize(spheres.count);
+  visibleCount.resize(cells.size());
+  cellStates.resize(cells.size());
+  scheduler.parallelFor(
+      cells.size(),
+      cellsPerTask,
+      [&](std::size_t firstCell, std::size_t lastCell)
+      {
+        for (std::size_t c = firstCell; c < lastCell; c++) {
+          const Cell& cell = cells[c];
+          const auto state = classify(cell, planes);
+          uint32_t* out = visible.data() + cell.first;
+
+          std::size_t written = 0;
+          switch (state) {
+            case CellState::eCulled:
+              break;
+            case CellState::eInside:
+              std::copy_n(sourceIndex.begin() + cell.first, cell.count, out);
+              written = cell.count;
+              break;
+            case CellState::eIntersecting:
+              written = kernel(spheres.subspan(cell.first,
+                                               cell.first + cell.count),
+                               planes,
+                               cell.first,
+                               out);
+              for (std::size_t i = 0; i < written; i++) {
+                out[i] = sourceIndex[out[i]];
+              }
+              break;
+          }
+          cellStates[c] = state;
+          visibleCount[c] = static_cast<uint32_t>(written);
+        }
+      });
+
+  // Ranges only move towards the front, so copying forwards is safe
+  std::size_t packed = 0;
+  stats.cellsCulled = 0;
+  stats.cellsInside = 0;
+  for (std::size_t c = 0; c < cells.size(); c++) {
+    std::copy_n(visible.begin() + cells[c].first,
+                visibleCount[c],
+                visible.begin() + static_cast<std::ptrdiff_t>(packed));
+    packed += visibleCount[c];
+    stats.cellsCulled += cellStates[c] == CellState::eCulled ? 1U : 0U;
+    stats.cellsInside += cellStates[c] == CellState::eInside ? 1U : 0U;
+  }
+
+  stats.visible = static_cast<uint32_t>(packed);
+  stats.culled = stats.objects - stats.visible;
+  stats.cullMilliseconds = millisecondsSince(start);
+  return std::span(visible).first(packed);
+}
+
+auto CullingGrid::classify(const Cell& cell, const FrustumPlanes& planes)
+    -> CellState
+{
+  const glm::vec3 center = (cell.boundsMin + cell.boundsMax) * 0.5F;
+  const glm::vec3 halfExtent = (cell.boundsMax - cell.boundsMin) * 0.5F;
+
+  auto state = CellState::eInside;
+  for (const auto& plane : planes) {
+    const glm::vec3 normal(plane);
+    // Distance of the box's center, and how far its corners reach along
+    // the normal
+    const float distance = glm::dot(normal, center) + plane.w;
+    const float reach = glm::dot(glm::abs(normal), halfExtent);
+    if (distance + reach < 0.0F) {
+      return CellState::eCulled;
+    }
+    if (distance - reach < 0.0F) {
+      state = CellState::eIntersecting;
+    }
+  }
+  return state;
+}
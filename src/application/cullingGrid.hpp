@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "cullingKernels.hpp"
+#include "entities.hpp"
+#include "taskScheduler.hpp"
+
+// Frustum culling of bounding spheres on the CPU.
+//
+// build() sorts the spheres into a loose grid: each sphere goes to the cell
+// holding its center, and a cell's bounds grow to fit its largest sphere,
+// so cells may overlap but every sphere lies within its cell. The sorted
+// spheres are copied into one structure of arrays, with each cell a
+// contiguous range.
+//
+// cull() first tests the cells' boxes against the frustum on the worker
+// threads. Cells outside are skipped and cells inside are taken whole;
+// only the spheres of cells crossing a plane are tested, a SIMD register at
+// a time. Spheres usually move every frame, so the grid is rebuilt rather
+// than updated.
+class CullingGrid
+{
+public:
+  struct Stats
+  {
+    uint32_t objects = 0;
+    uint32_t visible = 0;
+    uint32_t culled = 0;
+    uint32_t cells = 0;  // Non-empty ones
+    uint32_t cellsCulled = 0;
+    uint32_t cellsInside = 0;
+    double buildMilliseconds = 0.0;
+    double cullMilliseconds = 0.0;
+  };
+
+  // Cells per axis are capped, so spheres spread over a large space get
+  // larger cells rather than a huge grid
+  static constexpr uint32_t maxCellsPerAxis = 64;
+
+  // cellsPerTask cells are tested per scheduler task
+  explicit CullingGrid(float cellSize,
+                       std::size_t cellsPerTask = 4,
+                       SimdLevel level = bestSimdLevel());
+  ~CullingGrid() = default;
+
+  CullingGrid(const CullingGrid&) = delete;
+  CullingGrid& operator=(const CullingGrid&) = delete;
+  CullingGrid(CullingGrid&&) = delete;
+  CullingGrid& operator=(CullingGrid&&) = delete;
+
+  void build(const SphereSpan& spheres);
+
+  // Indices into the spheres last built of those not entirely outside the
+  // frustum, grouped by cell. Valid until the next build() or cull().
+  auto cull(const FrustumPlanes& planes, TaskScheduler& scheduler)
+      -> std::span<const uint32_t>;
+
+  [[nodiscard]] auto getStats() const -> Stats { return stats; }
+
+private:
+  enum class CellState : uint8_t
+  {
+    eCulled,
+    eInside,
+    eIntersecting,
+  };
+
+  struct Cell
+  {
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    uint32_t first;  // Into the sorted arrays
+    uint32_t count;
+  };
+
+  float cellSize;
+  std::size_t cellsPerTask;
+  CullKernel kernel;
+
+  std::vector<Cell> cells;  // Non-empty ones, in grid order
+  // Spheres sorted by cell, and where each came from
+  AlignedFloats centerX;
+  AlignedFloats centerY;
+  AlignedFloats centerZ;
+  AlignedFloats radius;
+  std::vector<uint32_t> sourceIndex;
+
+  std::vector<uint32_t> cellOfSphere;  // In build()
+  std::vector<uint32_t> cellStart;  // In build(), by grid cell
+
+  // Each cell writes its visible spheres to its own range, which are then
+  // packed to the front
+  std::vector<uint32_t> visible;
+  std::vector<uint32_t> visibleCount;  // By cell
+  std::vector<CellState> cellStates;
+
+  Stats stats;
+
+  [[nodiscard]] auto sorted() const -> SphereSpan
+  {
+    return {.centerX = centerX.data(),
+            .centerY = centerY.data(),
+            .centerZ = centerZ.data(),
+            .radius = radius.data(),
+            .count = centerX.size()};
+  }
+
+  static auto classify(const Cell& cell, const FrustumPlanes& planes)
+      -> CellState;
+};
@@ -0,0 +1,41 @@
+#include "cullingKernels.hpp"
+
+auto cullKernel(SimdLevel level) -> CullKernel
+{
+  switch (level) {
+#if defined(ENTITY_KERNELS_AVX2)
+    case SimdLevel::eAvx2:
+      return cullSpheresAvx2;
+#endif
+#if defined(ENTITY_KERNELS_NEON)
+    case SimdLevel::eNeon:
+      return cullSpheresNeon;
+#endif
+    default:
+      return cullSpheresScalar;
+  }
+}
+
+// Reference kernel, also used for the tails of the vector kernels. Every
+// index is written and only the count decides whether it stays, so the
+// loop has no branch on the result. The vector kernels fuse the
+// multiply-adds, so spheres just touching a plane may go either way.
+auto cullSpheresScalar(const SphereSpan& spheres,
+                       const FrustumPlanes& planes,
+                       uint32_t base,
+                       uint32_t* visible) -> std::size_t
+{
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < spheres.count; i++) {
+    bool inside = true;
+    for (const auto& plane : planes) {
+      const float distance = (plane.x * spheres.centerX[i])
+          + (plane.y * spheres.centerY[i]) + (plane.z * spheres.centerZ[i])
+          + plane.w;
+      inside &= distance >= -spheres.radius[i];
+    }
+    visible[count] = base + static_cast<uint32_t>(i);
+    count += inside ? 1 : 0;
+  }
+  return count;
+}
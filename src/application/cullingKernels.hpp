@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "entityKernels.hpp"
+
+// Six inward-facing planes (xyz: normal, w: distance). A point p is inside
+// a plane when dot(plane.xyz, p) + plane.w >= 0.
+using FrustumPlanes = std::array<glm::vec4, 6>;
+
+// Bounding spheres as a structure of arrays, as seen by the culling kernels
+struct SphereSpan
+{
+  const float* centerX;
+  const float* centerY;
+  const float* centerZ;
+  const float* radius;
+  std::size_t count;
+
+  [[nodiscard]] auto subspan(std::size_t first, std::size_t last) const
+      -> SphereSpan
+  {
+    return {.centerX = centerX + first,
+            .centerY = centerY + first,
+            .centerZ = centerZ + first,
+            .radius = radius + first,
+            .count = last - first};
+  }
+};
+
+// Writes base plus the index of every sphere that is not entirely outside
+// one of the planes to visible, in order, and returns how many it wrote.
+// visible must have room for all spheres.
+using CullKernel = auto (*)(const SphereSpan& spheres,
+                            const FrustumPlanes& planes,
+                            uint32_t base,
+                            uint32_t* visible) -> std::size_t;
+
+auto cullKernel(SimdLevel level) -> CullKernel;
+
+auto cullSpheresScalar(const SphereSpan& spheres,
+                       const FrustumPlanes& planes,
+                       uint32_t base,
+                       uint32_t* visible) -> std::size_t;
+
+#if defined(ENTITY_KERNELS_AVX2)
+auto cullSpheresAvx2(const SphereSpan& spheres,
+                     const FrustumPlanes& planes,
+                     uint32_t base,
+                     uint32_t* visible) -> std::size_t;
+#endif
+
+#if defined(ENTITY_KERNELS_NEON)
+auto cullSpheresNeon(const SphereSpan& spheres,
+                     const FrustumPlanes& planes,
+                     uint32_t base,
+                     uint32_t* visible) -> std::size_t;
+#endif
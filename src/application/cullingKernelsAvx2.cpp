@@ -0,0 +1,52 @@
+// Compiled with AVX2 and FMA enabled; only called after entityKernels.cpp has
+// checked that the CPU supports both.
+
+#include <bit>
+
+#include <immintrin.h>
+
+#include "cullingKernels.hpp"
+
+auto cullSpheresAvx2(const SphereSpan& spheres,
+                     const FrustumPlanes& planes,
+                     uint32_t base,
+                     uint32_t* visible) -> std::size_t
+{
+  constexpr std::size_t width = 8;
+
+  // Ranges handed out by CullingGrid start wherever a cell does, so use
+  // unaligned loads
+  std::size_t count = 0;
+  std::size_t i = 0;
+  for (; i + width <= spheres.count; i += width) {
+    const __m256 x = _mm256_loadu_ps(spheres.centerX + i);
+    const __m256 y = _mm256_loadu_ps(spheres.centerY + i);
+    const __m256 z = _mm256_loadu_ps(spheres.centerZ + i);
+    const __m256 radius = _mm256_loadu_ps(spheres.radius + i);
+
+    // Signed distance plus radius, which is negative when outside
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (const auto& plane : planes) {
+      __m256 d = _mm256_add_ps(_mm256_set1_ps(plane.w), radius);
+      d = _mm256_fmadd_ps(z, _mm256_set1_ps(plane.z), d);
+      d = _mm256_fmadd_ps(y, _mm256_set1_ps(plane.y), d);
+      d = _mm256_fmadd_ps(x, _mm256_set1_ps(plane.x), d);
+      inside = _mm256_and_ps(
+          inside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+
+    auto mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+    const auto first = base + static_cast<uint32_t>(i);
+    while (mask != 0) {
+      const auto lane = static_cast<uint32_t>(std::countr_zero(mask));
+      visible[count++] = first + lane;
+      mask &= mask - 1;
+    }
+  }
+
+  return count
+      + cullSpheresScalar(spheres.subspan(i, spheres.count),
+                          planes,
+                          base + static_cast<uint32_t>(i),
+                          visible + count);
+}
@@ -0,0 +1,52 @@
+// Advanced SIMD is part of the AArch64 baseline, so this needs no extra
+// compiler flags or runtime check.
+
+#include <bit>
+
+#include <arm_neon.h>
+
+#include "cullingKernels.hpp"
+
+auto cullSpheresNeon(const SphereSpan& spheres,
+                     const FrustumPlanes& planes,
+                     uint32_t base,
+                     uint32_t* visible) -> std::size_t
+{
+  constexpr std::size_t width = 4;
+
+  // Lane i contributes bit i of the mask
+  const uint32x4_t laneBits = {1, 2, 4, 8};
+
+  std::size_t count = 0;
+  std::size_t i = 0;
+  for (; i + width <= spheres.count; i += width) {
+    const float32x4_t x = vld1q_f32(spheres.centerX + i);
+    const float32x4_t y = vld1q_f32(spheres.centerY + i);
+    const float32x4_t z = vld1q_f32(spheres.centerZ + i);
+    const float32x4_t radius = vld1q_f32(spheres.radius + i);
+
+    // Signed distance plus radius, which is negative when outside
+    uint32x4_t inside = vdupq_n_u32(~0U);
+    for (const auto& plane : planes) {
+      float32x4_t d = vaddq_f32(vdupq_n_f32(plane.w), radius);
+      d = vfmaq_n_f32(d, z, plane.z);
+      d = vfmaq_n_f32(d, y, plane.y);
+      d = vfmaq_n_f32(d, x, plane.x);
+      inside = vandq_u32(inside, vcgezq_f32(d));
+    }
+
+    uint32_t mask = vaddvq_u32(vandq_u32(inside, laneBits));
+    const auto first = base + static_cast<uint32_t>(i);
+    while (mask != 0) {
+      const auto lane = static_cast<uint32_t>(std::countr_zero(mask));
+      visible[count++] = first + lane;
+      mask &= mask - 1;
+    }
+  }
+
+  return count
+      + cullSpheresScalar(spheres.subspan(i, spheres.count),
+                          planes,
+                          base + static_cast<uint32_t>(i),
+                          visible + count);
+}
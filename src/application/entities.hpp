@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// Allocates on Alignment-byte boundaries, so SIMD loads never split a cache
+// line and threads working on different cache lines never share one.
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator
+{
+  using value_type = T;
+
+  template <typename U>
+  struct rebind
+  {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+
+  template <typename U>
+  explicit AlignedAllocator(const AlignedAllocator<U, Alignment>& /*other*/)
+  {
+  }
+
+  auto allocate(std::size_t count) -> T*
+  {
+    return static_cast<T*>(
+        ::operator new(count * sizeof(T), std::align_val_t {Alignment}));
+  }
+
+  void deallocate(T* pointer, std::size_t /*count*/)
+  {
+    ::operator delete(pointer, std::align_val_t {Alignment});
+  }
+
+  friend auto operator==(const AlignedAllocator& /*a*/,
+                         const AlignedAllocator& /*b*/) -> bool
+  {
+    return true;
+  }
+};
+
+constexpr std::size_t cacheLineSize = 64;
+
+using AlignedFloats =
+    std::vector<float, AlignedAllocator<float, cacheLineSize>>;
+
+// Pointers into entity arrays, as seen by the update kernels
+struct EntitySpan
+{
+  float* positionX;
+  float* positionY;
+  float* velocityX;
+  float* velocityY;
+  std::size_t count;
+
+  [[nodiscard]] auto subspan(std::size_t first, std::size_t last) const
+      -> EntitySpan
+  {
+    return {.positionX = positionX + first,
+            .positionY = positionY + first,
+            .velocityX = velocityX + first,
+            .velocityY = velocityY + first,
+            .count = last - first};
+  }
+};
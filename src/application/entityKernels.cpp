@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "entityKernels.hpp"
+
+#if defined(ENTITY_KERNELS_AVX2) && defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+namespace
+{
+
+#if defined(ENTITY_KERNELS_AVX2)
+// AVX2 and FMA are both needed, and the OS must save the YMM registers
+auto cpuHasAvx2() -> bool
+{
+#  if defined(_MSC_VER)
+  std::array<int, 4> info {};
+  __cpuid(info.data(), 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info.data(), 1);
+  const bool fma = (info[2] & (1 << 12)) != 0;
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuidex(info.data(), 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#  else
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#  endif
+}
+#endif
+
+auto detectSimdLevels() -> std::vector<SimdLevel>
+{
+  std::vector<SimdLevel> levels = {SimdLevel::eScalar};
+#if defined(ENTITY_KERNELS_NEON)
+  // Advanced SIMD is mandatory on AArch64
+  levels.push_back(SimdLevel::eNeon);
+#endif
+#if defined(ENTITY_KERNELS_AVX2)
+  if (cpuHasAvx2()) {
+    levels.push_back(SimdLevel::eAvx2);
+  }
+#endif
+  return levels;
+}
+
+}  // namespace
+
+auto availableSimdLevels() -> std::span<const SimdLevel>
+{
+  static const std::vector<SimdLevel> levels = detectSimdLevels();
+  return levels;
+}
+
+auto bestSimdLevel() -> SimdLevel
+{
+  return availableSimdLevels().back();
+}
+
+auto entityKernel(SimdLevel level) -> EntityKernel
+{
+  switch (level) {
+#if defined(ENTITY_KERNELS_AVX2)
+    case SimdLevel::eAvx2:
+      return updateEntitiesAvx2;
+#endif
+#if defined(ENTITY_KERNELS_NEON)
+    case SimdLevel::eNeon:
+      return updateEntitiesNeon;
+#endif
+    default:
+      return updateEntitiesScalar;
+  }
+}
+
+auto simdLevelName(SimdLevel level) -> const char*
+{
+  switch (level) {
+    case SimdLevel::eAvx2:
+      return "avx2";
+    case SimdLevel::eNeon:
+      return "neon";
+    default:
+      return "scalar";
+  }
+}
+
+// Reference kernel, also used for the tails of the vector kernels. The
+// vector kernels fuse the multiply-adds, so results may differ in the last
+// bit.
+void updateEntitiesScalar(const EntitySpan& entities, const EntityStep& step)
+{
+  const float dt = step.timeStep;
+  const float r = step.restitution;
+  for (std::size_t i = 0; i < entities.count; i++) {
+    const float vx = entities.velocityX[i];
+    const float vy = entities.velocityY[i] + step.gravity * dt;
+    const float px = entities.positionX[i] + vx * dt;
+    const float py = entities.positionY[i] + vy * dt;
+
+    entities.velocityX[i] = px < step.boundsMin.x ? std::abs(vx) * r
+        : px > step.boundsMax.x                   ? -std::abs(vx) * r
+                                                  : vx;
+    entities.velocityY[i] = py < step.boundsMin.y ? std::abs(vy) * r
+        : py > step.boundsMax.y                   ? -std::abs(vy) * r
+                                                  : vy;
+    entities.positionX[i] = std::clamp(px, step.boundsMin.x, step.boundsMax.x);
+    entities.positionY[i] = std::clamp(py, step.boundsMin.y, step.boundsMax.y);
+  }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include <glm/glm.hpp>
+
+#include "entities.hpp"
+
+// Parameters of one entity update step
+struct EntityStep
+{
+  float timeStep = 1.0F / 60.0F;
+  float gravity = -1.0F;
+  float restitution = 0.8F;  // Speed kept when bouncing off the bounds
+  glm::vec2 boundsMin {-1.0F};
+  glm::vec2 boundsMax {1.0F};
+};
+
+enum class SimdLevel : uint8_t
+{
+  eScalar,
+  eNeon,
+  eAvx2,
+};
+
+// Integrates velocities and positions and bounces entities off the bounds
+using EntityKernel = void (*)(const EntitySpan& entities,
+                              const EntityStep& step);
+
+// Levels this build and CPU can run, scalar first
+auto availableSimdLevels() -> std::span<const SimdLevel>;
+
+// The widest available level
+auto bestSimdLevel() -> SimdLevel;
+
+auto entityKernel(SimdLevel level) -> EntityKernel;
+
+auto simdLevelName(SimdLevel level) -> const char*;
+
+void updateEntitiesScalar(const EntitySpan& entities, const EntityStep& step);
+
+#if defined(ENTITY_KERNELS_AVX2)
+void updateEntitiesAvx2(const EntitySpan& entities, const EntityStep& step);
+#endif
+
+#if defined(ENTITY_KERNELS_NEON)
+void updateEntitiesNeon(const EntitySpan& entities, const EntityStep& step);
+#endif
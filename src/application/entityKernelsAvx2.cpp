@@ -0,0 +1,67 @@
+// Compiled with AVX2 and FMA enabled; only called after entityKernels.cpp has
+// checked that the CPU supports both.
+
+#include <immintrin.h>
+
+#include "entityKernels.hpp"
+
+namespace
+{
+
+// Clamps to [lo, hi] and returns the velocity reflected off whichever bound
+// was crossed
+inline auto bounce(__m256& position,
+                   __m256 velocity,
+                   __m256 lo,
+                   __m256 hi,
+                   __m256 restitution) -> __m256
+{
+  const __m256 signMask = _mm256_set1_ps(-0.0F);
+  const __m256 speed =
+      _mm256_mul_ps(_mm256_andnot_ps(signMask, velocity), restitution);
+  const __m256 below = _mm256_cmp_ps(position, lo, _CMP_LT_OQ);
+  const __m256 above = _mm256_cmp_ps(position, hi, _CMP_GT_OQ);
+
+  velocity = _mm256_blendv_ps(velocity, speed, below);
+  velocity = _mm256_blendv_ps(velocity, _mm256_xor_ps(speed, signMask), above);
+  position = _mm256_min_ps(_mm256_max_ps(position, lo), hi);
+  return velocity;
+}
+
+}  // namespace
+
+void updateEntitiesAvx2(const EntitySpan& entities, const EntityStep& step)
+{
+  constexpr std::size_t width = 8;
+
+  const __m256 dt = _mm256_set1_ps(step.timeStep);
+  const __m256 dv = _mm256_set1_ps(step.gravity * step.timeStep);
+  const __m256 restitution = _mm256_set1_ps(step.restitution);
+  const __m256 minX = _mm256_set1_ps(step.boundsMin.x);
+  const __m256 minY = _mm256_set1_ps(step.boundsMin.y);
+  const __m256 maxX = _mm256_set1_ps(step.boundsMax.x);
+  const __m256 maxY = _mm256_set1_ps(step.boundsMax.y);
+
+  // Spans handed out by Game start on cache lines, but benchmarks and
+  // callers may pass arbitrary offsets, so use unaligned loads; they are
+  // free when the address happens to be aligned
+  std::size_t i = 0;
+  for (; i + width <= entities.count; i += width) {
+    const __m256 vx = _mm256_loadu_ps(entities.velocityX + i);
+    const __m256 vy =
+        _mm256_add_ps(_mm256_loadu_ps(entities.velocityY + i), dv);
+    __m256 px =
+        _mm256_fmadd_ps(vx, dt, _mm256_loadu_ps(entities.positionX + i));
+    __m256 py =
+        _mm256_fmadd_ps(vy, dt, _mm256_loadu_ps(entities.positionY + i));
+
+    _mm256_storeu_ps(entities.velocityX + i,
+                     bounce(px, vx, minX, maxX, restitution));
+    _mm256_storeu_ps(entities.velocityY + i,
+                     bounce(py, vy, minY, maxY, restitution));
+    _mm256_storeu_ps(entities.positionX + i, px);
+    _mm256_storeu_ps(entities.positionY + i, py);
+  }
+
+  updateEntitiesScalar(entities.subspan(i, entities.count), step);
+}
@@ -0,0 +1,57 @@
+// Advanced SIMD is part of the AArch64 baseline, so this needs no extra
+// compiler flags or runtime check.
+
+#include <arm_neon.h>
+
+#include "entityKernels.hpp"
+
+namespace
+{
+
+// Clamps to [lo, hi] and returns the velocity reflected off whichever bound
+// was crossed
+inline auto bounce(float32x4_t& position,
+                   float32x4_t velocity,
+                   float32x4_t lo,
+                   float32x4_t hi,
+                   float32x4_t restitution) -> float32x4_t
+{
+  const float32x4_t speed = vmulq_f32(vabsq_f32(velocity), restitution);
+  const uint32x4_t below = vcltq_f32(position, lo);
+  const uint32x4_t above = vcgtq_f32(position, hi);
+
+  velocity = vbslq_f32(below, speed, velocity);
+  velocity = vbslq_f32(above, vnegq_f32(speed), velocity);
+  position = vminq_f32(vmaxq_f32(position, lo), hi);
+  return velocity;
+}
+
+}  // namespace
+
+void updateEntitiesNeon(const EntitySpan& entities, const EntityStep& step)
+{
+  constexpr std::size_t width = 4;
+
+  const float32x4_t dt = vdupq_n_f32(step.timeStep);
+  const float32x4_t dv = vdupq_n_f32(step.gravity * step.timeStep);
+  const float32x4_t restitution = vdupq_n_f32(step.restitution);
+  const float32x4_t minX = vdupq_n_f32(step.boundsMin.x);
+  const float32x4_t minY = vdupq_n_f32(step.boundsMin.y);
+  const float32x4_t maxX = vdupq_n_f32(step.boundsMax.x);
+  const float32x4_t maxY = vdupq_n_f32(step.boundsMax.y);
+
+  std::size_t i = 0;
+  for (; i + width <= entities.count; i += width) {
+    const float32x4_t vx = vld1q_f32(entities.velocityX + i);
+    const float32x4_t vy = vaddq_f32(vld1q_f32(entities.velocityY + i), dv);
+    float32x4_t px = vfmaq_f32(vld1q_f32(entities.positionX + i), vx, dt);
+    float32x4_t py = vfmaq_f32(vld1q_f32(entities.positionY + i), vy, dt);
+
+    vst1q_f32(entities.velocityX + i, bounce(px, vx, minX, maxX, restitution));
+    vst1q_f32(entities.velocityY + i, bounce(py, vy, minY, maxY, restitution));
+    vst1q_f32(entities.positionX + i, px);
+    vst1q_f32(entities.positionY + i, py);
+  }
+
+  updateEntitiesScalar(entities.subspan(i, entities.count), step);
+}
@@ -0,0 +1,94 @@
+#include "eventPump.hpp"
+
+#include <SDL3/SDL.h>
+
+namespace
+{
+
+auto translateKey(SDL_Keycode keycode) -> Key
+{
+  switch (keycode) {
+    case SDLK_LEFT:
+      return Key::eLeft;
+    case SDLK_RIGHT:
+      return Key::eRight;
+    case SDLK_UP:
+      return Key::eUp;
+    case SDLK_DOWN:
+      return Key::eDown;
+    case SDLK_SPACE:
+      return Key::eSpace;
+    default:
+      return Key::eUnknown;
+  }
+}
+
+}  // namespace
+
+auto inputClock() -> uint64_t
+{
+  return SDL_GetTicksNS();
+}
+
+EventPump::EventPump(InputQueue& queue)
+    : queue(queue)
+{
+}
+
+auto EventPump::pump() -> bool
+{
+  SDL_Event event;
+  while (SDL_PollEvent(&event)) {
+    switch (event.type) {
+      case SDL_EVENT_QUIT:
+      case SDL_EVENT_WINDOW_CLOSE_REQUESTED:
+        quit = true;
+        break;
+
+      case SDL_EVENT_KEY_DOWN:
+      case SDL_EVENT_KEY_UP:
+        if (event.key.key == SDLK_ESCAPE) {
+          quit = true;
+          break;
+        }
+        forward({.type = event.type == SDL_EVENT_KEY_DOWN
+                     ? InputEvent::Type::eKeyDown
+                     : InputEvent::Type::eKeyUp,
+                 .key = translateKey(event.key.key),
+                 .repeat = event.key.repeat,
+                 .timestamp = event.key.timestamp});
+        break;
+
+      case SDL_EVENT_MOUSE_MOTION:
+        forward({.type = InputEvent::Type::eMouseMotion,
+                 .x = event.motion.x,
+                 .y = event.motion.y,
+                 .timestamp = event.motion.timestamp});
+        break;
+
+      case SDL_EVENT_MOUSE_BUTTON_DOWN:
+      case SDL_EVENT_MOUSE_BUTTON_UP:
+        forward({.type = event.type == SDL_EVENT_MOUSE_BUTTON_DOWN
+                     ? InputEvent::Type::eMouseButtonDown
+                     : InputEvent::Type::eMouseButtonUp,
+                 .button = event.button.button,
+                 .x = event.button.x,
+                 .y = event.button.y,
+                 .timestamp = event.button.timestamp});
+        break;
+
+      default:
+        break;
+    }
+  }
+  return !quit;
+}
+
+void EventPump::forward(const InputEvent& event)
+{
+  if (queue.push(event)) {
+    stats.events++;
+  } else {
+    stats.dropped++;
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+#include "inputEvent.hpp"
+
+// Drains the platform event queue on the main thread, once per frame.
+//
+// Window and quit events are handled here. Input events are translated to
+// InputEvent, keeping their platform timestamps, and pushed into an
+// InputQueue for the game's simulation thread, so input never waits for a
+// frame or a tick to be picked up. Events that find the queue full are
+// counted and dropped rather than blocking the main thread.
+class EventPump
+{
+public:
+  struct Stats
+  {
+    uint64_t events = 0;  // Input events forwarded
+    uint64_t dropped = 0;  // Input events lost to a full queue
+  };
+
+  explicit EventPump(InputQueue& queue);
+
+  // Handles every pending event. Returns false once the application should
+  // shut down: the window was closed, quit was requested or Escape was
+  // pressed.
+  auto pump() -> bool;
+
+  [[nodiscard]] auto quitRequested() const -> bool { return quit; }
+
+  [[nodiscard]] auto getStats() const -> const Stats& { return stats; }
+
+private:
+  InputQueue& queue;
+  bool quit = false;
+  Stats stats;
+
+  void forward(const InputEvent& event);
+};
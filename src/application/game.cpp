@@ -1,13 +1,285 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <span>
+#include <utility>
+
 #include "game.hpp"
 
-Game::Game()
+namespace
+{
+
+constexpr float twoPi = 2.0F * std::numbers::pi_v<float>;
+
+}  // namespace
+
+auto GameSnapshot::alphaAt(Clock::time_point now) const -> float
+{
+  if (timeStep <= Clock::duration::zero()) {
+    return 1.0F;
+  }
+  const auto alpha = std::chrono::duration<float>(now - time)
+      / std::chrono::duration<float>(timeStep);
+  return std::clamp(alpha, 0.0F, 1.0F);
+}
+
+Game::Game(TaskScheduler& scheduler, uint32_t entityCount, float tickRate)
+    : scheduler(scheduler)
+    , timeStep(std::chrono::duration_cast<GameSnapshot::Clock::duration>(
+          std::chrono::duration<float>(1.0F / tickRate)))
+    , simdLevel(bestSimdLevel())
+    , kernel(entityKernel(simdLevel))
+{
+  step.timeStep = 1.0F / tickRate;
+  populate(entityCount);
+
+  // The initial state, so the renderer has something to show right away
+  GameSnapshot& initial = snapshots.writeSlot();
+  initial.time = GameSnapshot::Clock::now();
+  initial.timeStep = timeStep;
+  gatherPositions(initial.previousX, initial.previousY);
+  gatherPositions(initial.positionX, initial.positionY);
+  gatherSprites(initial);
+  snapshots.publish();
+
+  simulation = std::jthread([this](const std::stop_token& stopToken)
+                            { simulate(stopToken); });
+}
+
+auto Game::latestSnapshot() -> const GameSnapshot&
+{
+  snapshots.consume();
+  return snapshots.readSlot();
+}
+
+auto Game::getStats() const -> Stats
+{
+  return {.ticks = ticks.load(std::memory_order_relaxed),
+          .skippedTicks = skippedTicks.load(std::memory_order_relaxed)};
+}
+
+void Game::populate(uint32_t entityCount)
+{
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> position(-1.0F, 1.0F);
+  std::uniform_real_distribution<float> velocity(-0.5F, 0.5F);
+  std::uniform_real_distribution<float> unit(0.0F, 1.0F);
+
+  // Mostly bodies drawn as sprites, every sixteenth of them a pulsing cube,
+  // and an eighth orbiting spheres. Each combination of components is an
+  // archetype of its own.
+  const uint32_t orbiterCount = entityCount / 8;
+  for (uint32_t i = orbiterCount; i < entityCount; i++) {
+    const float x = position(random);
+    const float y = position(random);
+    const float vx = velocity(random);
+    const float vy = velocity(random);
+    if (i % 16 == 0) {
+      world.create<PositionX,
+                   PositionY,
+                   VelocityX,
+                   VelocityY,
+                   Pulse,
+                   Shape,
+                   Color,
+                   Size>(x,
+                         y,
+                         vx,
+                         vy,
+                         {.phase = twoPi * unit(random),
+                          .rate = 2.0F + 4.0F * unit(random),
+                          .size = 2.0F * entitySize},
+                         Shape::Value::eCube,
+                         glm::vec4(0.9F, 0.5F, 0.2F, 0.6F),
+                         entitySize);
+    } else {
+      world.create<PositionX,
+                   PositionY,
+                   VelocityX,
+                   VelocityY,
+                   Shape,
+                   Color,
+                   Size>(x,
+                         y,
+                         vx,
+                         vy,
+                         Shape::Value::eSprite,
+                         glm::vec4(0.0F, 0.0F, 0.0F, 0.35F),
+                         entitySize);
+    }
+  }
+
+  for (uint32_t i = 0; i < orbiterCount; i++) {
+    const Orbit::Value orbit {
+        .center = {0.5F * position(random), 0.5F * position(random)},
+        .radius = 0.05F + 0.25F * unit(random),
+        .angle = twoPi * unit(random),
+        .angularSpeed = 3.0F * position(random)};
+    world.create<PositionX, PositionY, Orbit, Shape, Color, Size>(
+        orbit.center.x + orbit.radius * std::cos(orbit.angle),
+        orbit.center.y + orbit.radius * std::sin(orbit.angle),
+        orbit,
+        Shape::Value::eSphere,
+        glm::vec4(0.3F, 0.6F, 1.0F, 0.9F),
+        1.5F * entitySize);
+  }
+}
+
+void Game::simulate(const std::stop_token& stopToken)
+{
+  auto next = GameSnapshot::Clock::now() + timeStep;
+  while (!stopToken.stop_requested()) {
+    std::this_thread::sleep_until(next);
+
+    // Run every tick that is due, up to the catch-up limit
+    const auto now = GameSnapshot::Clock::now();
+    int caughtUp = 0;
+    while (next <= now && caughtUp < maxCatchUpTicks) {
+      tick(next);
+      next += timeStep;
+      caughtUp++;
+    }
+
+    if (next <= now) {
+      const auto behind = (now - next) / timeStep + 1;
+      skippedTicks.fetch_add(static_cast<uint64_t>(behind),
+                             std::memory_order_relaxed);
+      next += behind * timeStep;
+    }
+  }
+}
+
+void Game::tick(GameSnapshot::Clock::time_point time)
+{
+  InputEvent event;
+  while (inputQueue.pop(event)) {
+    apply(event);
+    inputTimestamp = std::max(inputTimestamp, event.timestamp);
+  }
+
+  // The write slot is this thread's until it is published
+  GameSnapshot& snapshot = snapshots.writeSlot();
+  gatherPositions(snapshot.previousX, snapshot.previousY);
+  runSystems();
+  gatherPositions(snapshot.positionX, snapshot.positionY);
+  gatherSprites(snapshot);
+  snapshot.tick = ++tickCount;
+  snapshot.time = time;
+  snapshot.timeStep = timeStep;
+  snapshot.inputTimestamp = inputTimestamp;
+  snapshots.publish();
+
+  ticks.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Game::apply(const InputEvent& event)
+{
+  if (event.type != InputEvent::Type::eKeyDown || event.repeat) {
+    return;
+  }
+
+  switch (event.key) {
+    case Key::eUp:
+      step.gravity = gravityStrength;
+      break;
+    case Key::eDown:
+      step.gravity = -gravityStrength;
+      break;
+    case Key::eSpace:
+      step.gravity = 0.0F;
+      break;
+    default:
+      break;
+  }
+}
+
+void Game::runSystems()
+{
+  world.parallelEach<PositionX, PositionY, VelocityX, VelocityY>(
+      scheduler,
+      chunksPerTask,
+      [&](std::span<float> positionX,
+          std::span<float> positionY,
+          std::span<float> velocityX,
+          std::span<float> velocityY)
+      {
+        kernel({.positionX = positionX.data(),
+                .positionY = positionY.data(),
+                .velocityX = velocityX.data(),
+                .velocityY = velocityY.data(),
+                .count = positionX.size()},
+               step);
+      });
+
+  world.parallelEach<PositionX, PositionY, Orbit>(
+      scheduler,
+      chunksPerTask,
+      [&](std::span<float> positionX,
+          std::span<float> positionY,
+          std::span<Orbit::Value> orbits)
+      {
+        for (std::size_t i = 0; i < orbits.size(); i++) {
+          auto& orbit = orbits[i];
+          orbit.angle = std::remainder(
+              orbit.angle + orbit.angularSpeed * step.timeStep, twoPi);
+          positionX[i] = orbit.center.x + orbit.radius * std::cos(orbit.angle);
+          positionY[i] = orbit.center.y + orbit.radius * std::sin(orbit.angle);
+        }
+      });
+
+  world.parallelEach<Pulse, Size>(
+      scheduler,
+      chunksPerTask,
+      [&](std::span<Pulse::Value> pulses, std::span<float> sizes)
+      {
+        for (std::size_t i = 0; i < pulses.size(); i++) {
+          auto& pulse = pulses[i];
+          pulse.phase =
+              std::remainder(pulse.phase + pulse.rate * step.timeStep, twoPi);
+          sizes[i] = pulse.size * (0.75F + 0.25F * std::sin(pulse.phase));
+        }
+      });
+}
+
+void Game::gatherPositions(AlignedFloats& x, AlignedFloats& y)
+{
+  x.resize(world.count<PositionX, PositionY, Shape, Color, Size>());
+  y.resize(x.size());
+
+  // Whole chunk arrays at a time
+  std::size_t offset = 0;
+  world.each<PositionX, PositionY, Shape, Color, Size>(
+      [&](std::span<float> positionX,
+          std::span<float> positionY,
+          std::span<Shape::Value> /*shapes*/,
+          std::span<glm::vec4> /*colors*/,
+          std::span<float> /*sizes*/)
+      {
+        std::ranges::copy(positionX, x.data() + offset);
+        std::ranges::copy(positionY, y.data() + offset);
+        offset += positionX.size();
+      });
+}
+
+void Game::gatherSprites(GameSnapshot& snapshot)
 {
-  vertices = {{{0.0, -0.5}}, {{0.5, 0.5}}, {{-0.5, 0.5}}};
+  snapshot.shapes.resize(snapshot.positionX.size());
+  snapshot.colors.resize(snapshot.positionX.size());
+  snapshot.sizes.resize(snapshot.positionX.size());
 
-  // vertices = {
-  //     {{-0.5f, -0.5f}},  // Bottom-left
-  //     {{0.5f, -0.5f}},  // Bottom-right
-  //     {{0.5f, 0.5f}},  // Top-right
-  //     {{-0.5f, 0.5f}}  // Top-left
-  // };
+  // Same query as gatherPositions(), so entities line up
+  std::size_t offset = 0;
+  world.each<PositionX, PositionY, Shape, Color, Size>(
+      [&](std::span<float> /*positionX*/,
+          std::span<float> /*positionY*/,
+          std::span<Shape::Value> shapes,
+          std::span<glm::vec4> colors,
+          std::span<float> sizes)
+      {
+        std::ranges::copy(shapes, snapshot.shapes.data() + offset);
+        std::ranges::copy(colors, snapshot.colors.data() + offset);
+        std::ranges::copy(sizes, snapshot.sizes.data() + offset);
+        offset += colors.size();
+      });
 }
@@ -1,21 +1,138 @@
 #pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
 #include <vector>
 
 #include <glm/glm.hpp>
 
-struct GameVertex
+#include "entities.hpp"
+#include "entityKernels.hpp"
+#include "gameComponents.hpp"
+#include "inputEvent.hpp"
+#include "taskScheduler.hpp"
+#include "tripleBuffer.hpp"
+#include "world.hpp"
+
+using AlignedVec4s =
+    std::vector<glm::vec4, AlignedAllocator<glm::vec4, cacheLineSize>>;
+
+// What the renderer needs of the drawn entities after one simulation tick:
+// their positions before and after it for interpolation, and their sprites.
+// Entities are in query order, which only changes with structural changes,
+// and those are made before previous positions are taken.
+struct GameSnapshot
 {
-  glm::vec2 pos;
+  using Clock = std::chrono::steady_clock;
+
+  uint64_t tick = 0;
+  Clock::time_point time;  // When the simulation reached this state
+  Clock::duration timeStep {};
+  // Newest input event applied so far, on the inputClock() timeline; 0
+  // before the first one
+  uint64_t inputTimestamp = 0;
+  AlignedFloats previousX;
+  AlignedFloats previousY;
+  AlignedFloats positionX;
+  AlignedFloats positionY;
+  std::vector<Shape::Value> shapes;
+  AlignedVec4s colors;
+  AlignedFloats sizes;
+
+  [[nodiscard]] auto size() const -> std::size_t { return positionX.size(); }
+
+  // Blend factor from the previous to the current positions for a frame
+  // shown at now. Frames are shown one tick behind the simulation, so the
+  // factor goes from 0 to 1 over the tick that follows time, and stays at
+  // 1 if the simulation falls further behind.
+  [[nodiscard]] auto alphaAt(Clock::time_point now) const -> float;
 };
 
+// Simulates the entities at a fixed timestep on a thread of its own.
+//
+// Entities live in a World. Each tick runs the systems over its chunks in
+// parallel: bodies fall and bounce, orbiters circle, and pulsing entities
+// change size, and an entity may be any mix of these.
+//
+// Every tick publishes a GameSnapshot through a TripleBuffer, from which
+// the renderer takes the newest one whenever it starts a frame. Neither
+// side waits for the other: a slow frame only means the renderer skips
+// snapshots, and a slow tick means it shows the same one again. The
+// simulation thread sleeps until each tick is due, and after a stall it
+// catches up by at most maxCatchUpTicks ticks before skipping ahead, so it
+// never falls into running ever more ticks per wakeup.
+//
+// Input arrives through an InputQueue and is applied at the start of the
+// next tick.
 class Game
 {
 public:
-  Game();
+  struct Stats
+  {
+    uint64_t ticks = 0;
+    uint64_t skippedTicks = 0;  // Dropped to catch up after stalls
+  };
+
+  explicit Game(TaskScheduler& scheduler,
+                uint32_t entityCount = 1 << 16,
+                float tickRate = 120.0F);
   ~Game() = default;
 
-  // temporary
-  std::vector<GameVertex> vertices;
+  Game(const Game&) = delete;
+  Game& operator=(const Game&) = delete;
+  Game(Game&&) = delete;
+  Game& operator=(Game&&) = delete;
+
+  // The newest published snapshot. Only call from one thread, usually the
+  // render thread; the reference stays valid until the next call.
+  auto latestSnapshot() -> const GameSnapshot&;
+
+  // Filled by the EventPump on the main thread
+  auto input() -> InputQueue& { return inputQueue; }
+
+  [[nodiscard]] auto getSimdLevel() const -> SimdLevel { return simdLevel; }
+
+  [[nodiscard]] auto getStats() const -> Stats;
 
 private:
+  static constexpr int maxCatchUpTicks = 8;
+  static constexpr std::size_t inputCapacity = 1024;
+  static constexpr float gravityStrength = 1.0F;
+  static constexpr float entitySize = 0.01F;
+
+  // World chunks handed to a worker at a time
+  static constexpr std::size_t chunksPerTask = 4;
+
+  TaskScheduler& scheduler;
+  EntityStep step;
+  GameSnapshot::Clock::duration timeStep;
+
+  // Simulation thread only
+  World world;
+  SimdLevel simdLevel;
+  EntityKernel kernel;
+  uint64_t tickCount = 0;
+  uint64_t inputTimestamp = 0;
+
+  InputQueue inputQueue {inputCapacity};
+
+  TripleBuffer<GameSnapshot> snapshots;
+  std::atomic<uint64_t> ticks = 0;
+  std::atomic<uint64_t> skippedTicks = 0;
+
+  // Last, so the thread is stopped before anything it uses is destroyed
+  std::jthread simulation;
+
+  void populate(uint32_t entityCount);
+  void simulate(const std::stop_token& stopToken);
+  void tick(GameSnapshot::Clock::time_point time);
+  void apply(const InputEvent& event);
+  void runSystems();
+
+  // Copy the drawn entities' components, chunk by chunk
+  void gatherPositions(AlignedFloats& x, AlignedFloats& y);
+  void gatherSprites(GameSnapshot& snapshot);
 };
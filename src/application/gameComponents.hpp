@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// Components of the game's entities. Positions and velocities are split
+// into one float array per axis for the entity kernels.
+
+struct PositionX
+{
+  using Value = float;
+  static constexpr const char* name = "PositionX";
+};
+
+struct PositionY
+{
+  using Value = float;
+  static constexpr const char* name = "PositionY";
+};
+
+struct VelocityX
+{
+  using Value = float;
+  static constexpr const char* name = "VelocityX";
+};
+
+struct VelocityY
+{
+  using Value = float;
+  static constexpr const char* name = "VelocityY";
+};
+
+// Circles center instead of falling
+struct Orbit
+{
+  struct Value
+  {
+    glm::vec2 center;
+    float radius;
+    float angle;
+    float angularSpeed;  // Radians per second
+  };
+  static constexpr const char* name = "Orbit";
+};
+
+// Grows and shrinks Size
+struct Pulse
+{
+  struct Value
+  {
+    float phase;  // Radians
+    float rate;  // Radians per second
+    float size;  // At the peak
+  };
+  static constexpr const char* name = "Pulse";
+};
+
+// Entities with a position, Shape, Color and Size are drawn
+struct Shape
+{
+  enum class Value : uint32_t
+  {
+    eSprite,
+    eCube,
+    eSphere,
+  };
+  static constexpr const char* name = "Shape";
+};
+
+// Meshes take their colour from rgb. Sprites take it from the gradient
+// ramp at w: the colour arrays are uploaded as they are and bound as
+// graphics.slang's velocity input.
+struct Color
+{
+  using Value = glm::vec4;
+  static constexpr const char* name = "Color";
+};
+
+// Sprite diameter, or mesh scale
+struct Size
+{
+  using Value = float;
+  static constexpr const char* name = "Size";
+};
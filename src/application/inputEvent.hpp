@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+#include "spscQueue.hpp"
+
+// Keys the game reacts to; everything else arrives as eUnknown
+enum class Key : uint8_t
+{
+  eUnknown,
+  eLeft,
+  eRight,
+  eUp,
+  eDown,
+  eSpace,
+};
+
+// A platform independent input event, stamped with the time the platform
+// received it
+struct InputEvent
+{
+  enum class Type : uint8_t
+  {
+    eKeyDown,
+    eKeyUp,
+    eMouseMotion,
+    eMouseButtonDown,
+    eMouseButtonUp,
+  };
+
+  Type type = Type::eKeyDown;
+  Key key = Key::eUnknown;
+  uint8_t button = 0;  // 1 = left, 2 = middle, 3 = right
+  bool repeat = false;  // Key held down
+  float x = 0.0F;  // Cursor position in window pixels
+  float y = 0.0F;
+  uint64_t timestamp = 0;  // Nanoseconds on the inputClock() timeline
+};
+
+using InputQueue = SpscQueue<InputEvent>;
+
+// Nanoseconds on the clock input events are stamped with
+auto inputClock() -> uint64_t;
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+//
+// A ring of capacity slots indexed by two ever-increasing counters, each
+// written by one side only. Each side also caches the other side's
+// counter and only reloads it when the ring looks full or empty, so in
+// steady state a push or pop touches no cache line the other thread
+// writes.
+template <typename T>
+class SpscQueue
+{
+public:
+  // Rounded up to a power of two
+  explicit SpscQueue(std::size_t capacity)
+      : capacity(std::bit_ceil(capacity))
+      , slots(std::make_unique<T[]>(this->capacity))
+  {
+  }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+  SpscQueue(SpscQueue&&) = delete;
+  SpscQueue& operator=(SpscQueue&&) = delete;
+
+  // Producer only. Returns false, dropping value, if the queue is full.
+  auto push(const T& value) -> bool
+  {
+    const std::size_t tail = producer.tail.load(std::memory_order_relaxed);
+    if (tail - producer.cachedHead == capacity) {
+      producer.cachedHead = consumer.head.load(std::memory_order_acquire);
+      if (tail - producer.cachedHead == capacity) {
+        return false;
+      }
+    }
+    slots[tail & (capacity - 1)] = value;
+    producer.tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. Returns false if the queue is empty.
+  auto pop(T& value) -> bool
+  {
+    const std::size_t head = consumer.head.load(std::memory_order_relaxed);
+    if (head == consumer.cachedTail) {
+      consumer.cachedTail = producer.tail.load(std::memory_order_acquire);
+      if (head == consumer.cachedTail) {
+        return false;
+      }
+    }
+    value = slots[head & (capacity - 1)];
+    consumer.head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  struct alignas(64) Producer
+  {
+    std::atomic<std::size_t> tail = 0;
+    std::size_t cachedHead = 0;
+  };
+
+  struct alignas(64) Consumer
+  {
+    std::atomic<std::size_t> head = 0;
+    std::size_t cachedTail = 0;
+  };
+
+  const std::size_t capacity;
+  std::unique_ptr<T[]> slots;
+  Producer producer;
+  Consumer consumer;
+};
@@ -0,0 +1,393 @@
+#include <algorithm>
+#include <utility>
+
+#include "taskScheduler.hpp"
+
+struct TaskCounter::Task
+{
+  TaskScheduler::TaskFunction fn;
+  TaskCounter* counter = nullptr;
+  TaskAffinity affinity = TaskAffinity::eAny;
+  uint32_t spawner = 0;
+};
+
+namespace
+{
+
+// Spawner of tasks from threads outside the scheduler
+constexpr uint32_t externalThread = UINT32_MAX;
+
+// Failed steal rounds before an idle worker goes to sleep
+constexpr int idleSpins = 64;
+
+thread_local const TaskScheduler* currentScheduler = nullptr;
+thread_local uint32_t threadIndex = 0;
+
+// xorshift64, for picking steal victims
+auto nextRandom(uint64_t& state) -> uint64_t
+{
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+}  // namespace
+
+TaskScheduler::TaskScheduler(uint32_t workerCount)
+{
+  threads.resize(workerCount + 1);
+  for (uint32_t i = 0; i < threads.size(); i++) {
+    threads[i] = std::make_unique<ThreadState>();
+    threads[i]->randomState = 0x9e3779b97f4a7c15ULL * (i + 1);
+  }
+
+  currentScheduler = this;
+  threadIndex = 0;
+
+  workers.reserve(workerCount);
+  for (uint32_t i = 1; i <= workerCount; i++) {
+    workers.emplace_back([this, i](const std::stop_token& stopToken)
+                         { work(i, stopToken); });
+  }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  for (auto& worker : workers) {
+    worker.request_stop();
+  }
+  workers.clear();
+
+  // Anything still queued was never waited on
+  for (const auto& thread : threads) {
+    while (Task* task = thread->deque.pop()) {
+      delete task;
+    }
+  }
+  for (Task* task : injected) {
+    delete task;
+  }
+  for (Task* task : mainTasks) {
+    delete task;
+  }
+
+  if (currentScheduler == this) {
+    currentScheduler = nullptr;
+  }
+}
+
+auto TaskScheduler::defaultWorkerCount() -> uint32_t
+{
+  const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+  return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+auto TaskScheduler::currentThread() -> uint32_t
+{
+  return threadIndex;
+}
+
+auto TaskScheduler::spawnerIndex() const -> uint32_t
+{
+  return currentScheduler == this ? threadIndex : externalThread;
+}
+
+void TaskScheduler::spawn(TaskFunction fn,
+                          TaskCounter* counter,
+                          TaskAffinity affinity)
+{
+  if (counter != nullptr) {
+    counter->pending.fetch_add(1, std::memory_order_relaxed);
+  }
+  enqueue(new Task {.fn = std::move(fn),
+                    .counter = counter,
+                    .affinity = affinity,
+                    .spawner = spawnerIndex()});
+}
+
+void TaskScheduler::spawnAfter(TaskCounter& dependency,
+                               TaskFunction fn,
+                               TaskCounter* counter,
+                               TaskAffinity affinity)
+{
+  if (counter != nullptr) {
+    counter->pending.fetch_add(1, std::memory_order_relaxed);
+  }
+  auto* task = new Task {.fn = std::move(fn),
+                         .counter = counter,
+                         .affinity = affinity,
+                         .spawner = spawnerIndex()};
+
+  std::exception_ptr error;
+  {
+    // release() takes the continuations under the same lock once the
+    // count reaches zero, so the task is either taken by it or sees zero
+    const std::scoped_lock lock(dependency.mutex);
+    if (!dependency.done()) {
+      dependency.continuations.push_back(task);
+      return;
+    }
+    error = dependency.error;
+  }
+
+  if (error) {
+    cancel(task, error);
+  } else {
+    enqueue(task);
+  }
+}
+
+void TaskScheduler::enqueue(Task* task)
+{
+  const bool onScheduler = currentScheduler == this;
+  if (onScheduler) {
+    threads[threadIndex]->spawned.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  if (task->affinity == TaskAffinity::eMainThread) {
+    const std::scoped_lock lock(mainMutex);
+    mainTasks.push_back(task);
+    // Workers cannot run it, so there is no one to wake
+    return;
+  }
+
+  if (onScheduler) {
+    threads[threadIndex]->deque.push(task);
+  } else {
+    const std::scoped_lock lock(injectedMutex);
+    injected.push_back(task);
+    hasInjected.store(true, std::memory_order_relaxed);
+  }
+
+  epoch.fetch_add(1);
+  if (sleepers.load() > 0) {
+    const std::scoped_lock lock(sleepMutex);
+    wake.notify_one();
+  }
+}
+
+auto TaskScheduler::findTask(uint32_t index) -> Task*
+{
+  ThreadState& self = *threads[index];
+  if (Task* task = self.deque.pop()) {
+    return task;
+  }
+
+  if (index == 0) {
+    const std::scoped_lock lock(mainMutex);
+    if (!mainTasks.empty()) {
+      Task* task = mainTasks.front();
+      mainTasks.pop_front();
+      return task;
+    }
+  }
+
+  if (hasInjected.load(std::memory_order_relaxed)) {
+    const std::scoped_lock lock(injectedMutex);
+    if (!injected.empty()) {
+      Task* task = injected.front();
+      injected.pop_front();
+      hasInjected.store(!injected.empty(), std::memory_order_relaxed);
+      return task;
+    }
+  }
+
+  const auto count = static_cast<uint32_t>(threads.size());
+  const auto start = static_cast<uint32_t>(nextRandom(self.randomState));
+  for (uint32_t i = 0; i < count; i++) {
+    const uint32_t victim = (start + i) % count;
+    if (victim == index) {
+      continue;
+    }
+    if (Task* task = threads[victim]->deque.steal()) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void TaskScheduler::execute(Task* task, uint32_t index)
+{
+  ThreadState& self = *threads[index];
+  self.executed.fetch_add(1, std::memory_order_relaxed);
+  if (task->spawner != index && task->spawner != externalThread) {
+    self.stolen.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  TaskCounter* counter = task->counter;
+  if (counter == nullptr) {
+    task->fn();
+  } else {
+    try {
+      task->fn();
+    } catch (...) {
+      const std::scoped_lock lock(counter->mutex);
+      if (!counter->error) {
+        counter->error = std::current_exception();
+      }
+    }
+  }
+  delete task;
+
+  if (counter != nullptr) {
+    release(*counter);
+  }
+}
+
+void TaskScheduler::release(TaskCounter& counter)
+{
+  // Only the decrement to zero takes the lock. wait() takes it too before
+  // returning, so the counter cannot be destroyed while this still uses it.
+  uint32_t pending = counter.pending.load(std::memory_order_relaxed);
+  while (pending > 1) {
+    if (counter.pending.compare_exchange_weak(pending,
+                                              pending - 1,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_relaxed))
+    {
+      return;
+    }
+  }
+
+  std::vector<Task*> ready;
+  std::exception_ptr error;
+  {
+    const std::scoped_lock lock(counter.mutex);
+    if (counter.pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+    ready.swap(counter.continuations);
+    error = counter.error;
+  }
+
+  for (Task* task : ready) {
+    if (error) {
+      cancel(task, error);
+    } else {
+      enqueue(task);
+    }
+  }
+}
+
+void TaskScheduler::cancel(Task* task, const std::exception_ptr& error)
+{
+  TaskCounter* counter = task->counter;
+  delete task;
+  if (counter == nullptr) {
+    return;
+  }
+
+  {
+    const std::scoped_lock lock(counter->mutex);
+    if (!counter->error) {
+      counter->error = error;
+    }
+  }
+  release(*counter);
+}
+
+void TaskScheduler::wait(TaskCounter& counter)
+{
+  const bool onScheduler = currentScheduler == this;
+  while (!counter.done()) {
+    Task* task = onScheduler ? findTask(threadIndex) : nullptr;
+    if (task != nullptr) {
+      execute(task, threadIndex);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  const std::scoped_lock lock(counter.mutex);
+  if (counter.error) {
+    std::rethrow_exception(std::exchange(counter.error, nullptr));
+  }
+}
+
+void TaskScheduler::runMainThreadTasks()
+{
+  std::deque<Task*> tasks;
+  {
+    const std::scoped_lock lock(mainMutex);
+    tasks.swap(mainTasks);
+  }
+  for (Task* task : tasks) {
+    execute(task, 0);
+  }
+}
+
+void TaskScheduler::parallelFor(std::size_t count,
+                                std::size_t grain,
+                                const RangeFunction& fn)
+{
+  grain = std::max<std::size_t>(grain, 1);
+  if (count <= grain || threads.size() == 1) {
+    if (count > 0) {
+      fn(0, count);
+    }
+    return;
+  }
+
+  TaskCounter counter;
+  for (std::size_t first = 0; first < count; first += grain) {
+    const std::size_t last = std::min(first + grain, count);
+    spawn([&fn, first, last] { fn(first, last); }, &counter);
+  }
+  wait(counter);
+}
+
+void TaskScheduler::work(uint32_t index, const std::stop_token& stopToken)
+{
+  currentScheduler = this;
+  threadIndex = index;
+  ThreadState& self = *threads[index];
+
+  while (!stopToken.stop_requested()) {
+    Task* task = findTask(index);
+    for (int spin = 0; task == nullptr && spin < idleSpins; spin++) {
+      std::this_thread::yield();
+      task = findTask(index);
+    }
+
+    if (task == nullptr) {
+      sleepers.fetch_add(1);
+      const uint64_t seenEpoch = epoch.load();
+      task = findTask(index);
+      if (task == nullptr) {
+        self.sleeps.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock lock(sleepMutex);
+        wake.wait(lock,
+                  stopToken,
+                  [&] { return epoch.load() != seenEpoch; });
+      }
+      sleepers.fetch_sub(1);
+    }
+
+    if (task != nullptr) {
+      execute(task, index);
+    }
+  }
+}
+
+auto TaskScheduler::getStats() const -> Stats
+{
+  Stats stats;
+  for (const auto& thread : threads) {
+    stats.spawned += thread->spawned.load(std::memory_order_relaxed);
+    stats.executed += thread->executed.load(std::memory_order_relaxed);
+    stats.stolen += thread->stolen.load(std::memory_order_relaxed);
+    stats.sleeps += thread->sleeps.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void TaskScheduler::resetStats()
+{
+  for (const auto& thread : threads) {
+    thread->spawned.store(0, std::memory_order_relaxed);
+    thread->executed.store(0, std::memory_order_relaxed);
+    thread->stolen.store(0, std::memory_order_relaxed);
+    thread->sleeps.store(0, std::memory_order_relaxed);
+  }
+}
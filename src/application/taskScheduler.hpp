@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "workStealingDeque.hpp"
+
+class TaskScheduler;
+
+// Counts unfinished tasks. Tasks spawned with a counter increment it when
+// they are spawned and decrement it when they finish, so one counter can
+// track any number of tasks; wait on it, or make further tasks depend on
+// it. Must outlive the tasks that refer to it.
+//
+// If a task throws, the counter keeps the first exception and wait()
+// rethrows it. Tasks that depend on a failed counter are cancelled and
+// pass the exception on to their own counters.
+class TaskCounter
+{
+public:
+  TaskCounter() = default;
+  ~TaskCounter() = default;
+
+  TaskCounter(const TaskCounter&) = delete;
+  TaskCounter& operator=(const TaskCounter&) = delete;
+  TaskCounter(TaskCounter&&) = delete;
+  TaskCounter& operator=(TaskCounter&&) = delete;
+
+  [[nodiscard]] auto done() const -> bool
+  {
+    return pending.load(std::memory_order_acquire) == 0;
+  }
+
+private:
+  friend class TaskScheduler;
+  struct Task;
+
+  std::atomic<uint32_t> pending = 0;
+
+  // Tasks spawned with this counter as their dependency, released when it
+  // reaches zero
+  std::mutex mutex;
+  std::vector<Task*> continuations;
+  std::exception_ptr error;
+};
+
+// Where a task may run
+enum class TaskAffinity : uint8_t
+{
+  eAny,
+  eMainThread,  // Only in runMainThreadTasks() or wait() on the main thread
+};
+
+// Work-stealing task scheduler.
+//
+// Every thread, including the main thread that created the scheduler, owns
+// a WorkStealingDeque. Tasks spawned on a scheduler thread go to that
+// thread's deque and are run newest first by the owner; idle threads steal
+// the oldest tasks from random victims, and sleep once there is nothing
+// left to steal. Tasks spawned from other threads go through a shared
+// queue. Waiting on a counter runs other tasks instead of blocking, so
+// tasks may spawn and wait on subtasks.
+class TaskScheduler
+{
+public:
+  using TaskFunction = std::function<void()>;
+  // Chunk callback, called with [first, last)
+  using RangeFunction = std::function<void(std::size_t, std::size_t)>;
+
+  struct Stats
+  {
+    uint64_t spawned = 0;
+    uint64_t executed = 0;
+    uint64_t stolen = 0;  // Executed on a thread other than the spawner's
+    uint64_t sleeps = 0;
+  };
+
+  // workerCount threads are started in addition to the calling thread,
+  // which becomes the main thread
+  explicit TaskScheduler(uint32_t workerCount = defaultWorkerCount());
+  ~TaskScheduler();
+
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+  TaskScheduler(TaskScheduler&&) = delete;
+  TaskScheduler& operator=(TaskScheduler&&) = delete;
+
+  // Tasks spawned without a counter must not throw
+  void spawn(TaskFunction fn,
+             TaskCounter* counter = nullptr,
+             TaskAffinity affinity = TaskAffinity::eAny);
+
+  // Like spawn(), but fn only becomes runnable once dependency is done
+  void spawnAfter(TaskCounter& dependency,
+                  TaskFunction fn,
+                  TaskCounter* counter = nullptr,
+                  TaskAffinity affinity = TaskAffinity::eAny);
+
+  // Runs tasks until counter is done, then rethrows the first exception
+  // thrown by one of its tasks, if any
+  void wait(TaskCounter& counter);
+
+  // Runs the main-thread tasks queued so far. Main thread only.
+  void runMainThreadTasks();
+
+  // Calls fn on consecutive chunks of at most grain elements covering
+  // [0, count) and waits for them. Ranges that fit in one chunk run inline.
+  void parallelFor(std::size_t count,
+                   std::size_t grain,
+                   const RangeFunction& fn);
+
+  // Threads that run tasks, including the main thread
+  [[nodiscard]] auto threadCount() const -> uint32_t
+  {
+    return static_cast<uint32_t>(threads.size());
+  }
+
+  // One worker per hardware thread besides the main thread
+  static auto defaultWorkerCount() -> uint32_t;
+
+  // Index of the calling thread: 0 for the main thread, 1 to workerCount
+  // for workers. Lets callers keep per-thread state, such as command
+  // pools, in a plain array of threadCount() entries. Threads that do not
+  // belong to a scheduler also report 0, so only call this from tasks.
+  static auto currentThread() -> uint32_t;
+
+  [[nodiscard]] auto getStats() const -> Stats;
+  void resetStats();
+
+private:
+  using Task = TaskCounter::Task;
+
+  // Per-thread state on its own cache lines
+  struct alignas(64) ThreadState
+  {
+    WorkStealingDeque<Task> deque;
+    uint64_t randomState = 0;
+    std::atomic<uint64_t> spawned = 0;
+    std::atomic<uint64_t> executed = 0;
+    std::atomic<uint64_t> stolen = 0;
+    std::atomic<uint64_t> sleeps = 0;
+  };
+
+  std::vector<std::unique_ptr<ThreadState>> threads;
+
+  // Tasks from threads outside the scheduler
+  std::mutex injectedMutex;
+  std::deque<Task*> injected;
+  std::atomic<bool> hasInjected = false;
+
+  std::mutex mainMutex;
+  std::deque<Task*> mainTasks;
+
+  // Bumped whenever a task becomes runnable. A thread about to sleep
+  // re-checks for work after registering in sleepers, then only sleeps
+  // while the epoch is unchanged, so a wakeup cannot be lost.
+  std::atomic<uint64_t> epoch = 0;
+  std::atomic<uint32_t> sleepers = 0;
+  std::mutex sleepMutex;
+  std::condition_variable_any wake;
+
+  // Last, so the threads are stopped before anything they use is destroyed
+  std::vector<std::jthread> workers;
+
+  void work(uint32_t index, const std::stop_token& stopToken);
+  [[nodiscard]] auto spawnerIndex() const -> uint32_t;
+  void enqueue(Task* task);
+  auto findTask(uint32_t index) -> Task*;
+  void execute(Task* task, uint32_t index);
+  void release(TaskCounter& counter);
+  void cancel(Task* task, const std::exception_ptr& error);
+};
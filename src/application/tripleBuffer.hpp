@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Hands values from one producer thread to one consumer thread without
+// locks, and without either side ever waiting for the other.
+//
+// The producer fills the write slot and publishes it, which swaps it with
+// the shared middle slot; the consumer swaps the middle slot with its read
+// slot whenever a newer value has been published. Each side owns one slot
+// at all times, so the producer can run ahead and overwrite values the
+// consumer never saw, and the consumer can keep reading its value while
+// the producer publishes.
+template <typename T>
+class TripleBuffer
+{
+public:
+  TripleBuffer() = default;
+
+  explicit TripleBuffer(const T& initial)
+      : slots {initial, initial, initial}
+  {
+  }
+
+  // Producer only. Holds whatever was last written to this slot, which is
+  // not necessarily the last published value.
+  auto writeSlot() -> T& { return slots[writeIndex]; }
+
+  // Producer only
+  void publish()
+  {
+    const uint8_t previous =
+        middle.exchange(writeIndex | freshBit, std::memory_order_acq_rel);
+    writeIndex = previous & indexMask;
+  }
+
+  // Consumer only. Swaps in the newest published value, if there is one
+  // the consumer has not seen yet, and returns whether it did.
+  auto consume() -> bool
+  {
+    if ((middle.load(std::memory_order_relaxed) & freshBit) == 0) {
+      return false;
+    }
+    const uint8_t previous =
+        middle.exchange(readIndex, std::memory_order_acq_rel);
+    readIndex = previous & indexMask;
+    return true;
+  }
+
+  // Consumer only
+  [[nodiscard]] auto readSlot() const -> const T& { return slots[readIndex]; }
+
+private:
+  static constexpr uint8_t indexMask = 0x3;
+  static constexpr uint8_t freshBit = 0x4;
+
+  std::array<T, 3> slots;
+
+  // Slot index of the middle slot, plus freshBit once the producer has
+  // published it and until the consumer takes it
+  alignas(64) std::atomic<uint8_t> middle = 1;
+  alignas(64) uint8_t writeIndex = 0;
+  alignas(64) uint8_t readIndex = 2;
+};
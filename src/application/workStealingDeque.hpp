@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Chase-Lev work-stealing deque of pointers (Chase and Lev 2005, with the
+// memory orderings of Le et al. 2013).
+//
+// The owning thread pushes and pops at the bottom like a stack, so it works
+// on its most recent, cache-hot tasks; any other thread may steal from the
+// top, taking the oldest tasks, which tend to be the largest. Only steals
+// and the pop of the last element contend, on a single compare-exchange.
+//
+// The ring grows when full. Replaced rings are kept until the deque is
+// destroyed, since a thief may still be reading from one.
+template <typename T>
+class WorkStealingDeque
+{
+public:
+  explicit WorkStealingDeque(int64_t capacity = 1024)
+  {
+    rings.push_back(std::make_unique<Ring>(capacity));
+    ring.store(rings.back().get(), std::memory_order_relaxed);
+  }
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+  WorkStealingDeque(WorkStealingDeque&&) = delete;
+  WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+  // Owner only
+  void push(T* item)
+  {
+    const int64_t b = bottom.load(std::memory_order_relaxed);
+    const int64_t t = top.load(std::memory_order_acquire);
+    Ring* r = ring.load(std::memory_order_relaxed);
+    if (b - t > r->capacity - 1) {
+      r = grow(r, t, b);
+    }
+    r->put(b, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // Owner only. Returns nullptr if empty.
+  auto pop() -> T*
+  {
+    const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Ring* r = ring.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    T* item = nullptr;
+    if (t <= b) {
+      item = r->get(b);
+      if (t == b) {
+        // Last element: race thieves for it
+        if (!top.compare_exchange_strong(t,
+                                         t + 1,
+                                         std::memory_order_seq_cst,
+                                         std::memory_order_relaxed))
+        {
+          item = nullptr;
+        }
+        bottom.store(b + 1, std::memory_order_relaxed);
+      }
+    } else {
+      bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Any thread. Returns nullptr if empty or if another thread won the race.
+  auto steal() -> T*
+  {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+      return nullptr;
+    }
+
+    T* item = ring.load(std::memory_order_acquire)->get(t);
+    if (!top.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+      return nullptr;
+    }
+    return item;
+  }
+
+  // Approximate when called concurrently with push, pop or steal
+  [[nodiscard]] auto empty() const -> bool
+  {
+    return bottom.load(std::memory_order_relaxed)
+        <= top.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Ring
+  {
+    int64_t capacity;  // Power of two
+    std::unique_ptr<std::atomic<T*>[]> slots;
+
+    explicit Ring(int64_t capacity)
+        : capacity(capacity)
+        , slots(std::make_unique<std::atomic<T*>[]>(
+              static_cast<std::size_t>(capacity)))
+    {
+    }
+
+    [[nodiscard]] auto slot(int64_t index) const -> std::atomic<T*>&
+    {
+      return slots[static_cast<std::size_t>(index & (capacity - 1))];
+    }
+
+    void put(int64_t index, T* item)
+    {
+      slot(index).store(item, std::memory_order_relaxed);
+    }
+
+    auto get(int64_t index) const -> T*
+    {
+      return slot(index).load(std::memory_order_relaxed);
+    }
+  };
+
+  // Separate cache lines, so thieves polling top do not slow down the
+  // owner's pushes and pops
+  alignas(64) std::atomic<int64_t> top = 0;
+  alignas(64) std::atomic<int64_t> bottom = 0;
+  alignas(64) std::atomic<Ring*> ring;
+  std::vector<std::unique_ptr<Ring>> rings;  // Owner only
+
+  auto grow(Ring* old, int64_t t, int64_t b) -> Ring*
+  {
+    rings.push_back(std::make_unique<Ring>(old->capacity * 2));
+    Ring* grown = rings.back().get();
+    for (int64_t i = t; i < b; i++) {
+      grown->put(i, old->get(i));
+    }
+    ring.store(grown, std::memory_order_release);
+    return grown;
+  }
+};
@@ -0,0 +1,106 @@
+#include "world.hpp"
+
+void World::destroy(Entity entity)
+{
+  const Record& found = record(entity);
+  removeRow(*found.archetype, found.row);
+
+  Record& freed = records[entity.index];
+  freed.archetype = nullptr;
+  freed.generation++;
+  freeList.push_back(entity.index);
+  entityCount--;
+}
+
+auto World::alive(Entity entity) const -> bool
+{
+  return entity.index < records.size()
+      && records[entity.index].archetype != nullptr
+      && records[entity.index].generation == entity.generation;
+}
+
+auto World::getStats() const -> Stats
+{
+  Stats stats {.entities = entityCount, .archetypes = archetypes.size()};
+  for (const auto& archetype : archetypes) {
+    stats.chunks += archetype->chunkCount();
+  }
+  return stats;
+}
+
+auto World::archetypeFor(ComponentMask mask) -> Archetype&
+{
+  const auto found = archetypeByMask.find(mask);
+  if (found != archetypeByMask.end()) {
+    return *found->second;
+  }
+
+  auto& archetype = archetypes.emplace_back(std::make_unique<Archetype>(mask));
+  archetypeByMask.emplace(mask, archetype.get());
+  return *archetype;
+}
+
+auto World::allocate(Archetype& archetype) -> Entity
+{
+  uint32_t index = 0;
+  if (!freeList.empty()) {
+    index = freeList.back();
+    freeList.pop_back();
+  } else {
+    index = static_cast<uint32_t>(records.size());
+    records.emplace_back();
+  }
+
+  Record& allocated = records[index];
+  const Entity entity {.index = index, .generation = allocated.generation};
+  allocated.archetype = &archetype;
+  allocated.row = archetype.append(entity);
+  entityCount++;
+  return entity;
+}
+
+auto World::record(Entity entity) const -> const Record&
+{
+  if (!alive(entity)) {
+    throw std::out_of_range("Stale or invalid entity.");
+  }
+  return records[entity.index];
+}
+
+void World::move(Entity entity, ComponentMask mask)
+{
+  Archetype& target = archetypeFor(mask);
+  Record& moved = records[entity.index];
+  Archetype& source = *moved.archetype;
+  const std::size_t sourceRow = moved.row;
+
+  const std::size_t row = target.append(entity);
+  target.copyRow(row, source, sourceRow);
+  removeRow(source, sourceRow);
+
+  moved.archetype = &target;
+  moved.row = row;
+}
+
+void World::removeRow(Archetype& archetype, std::size_t row)
+{
+  const Entity moved = archetype.remove(row);
+  if (moved.isValid()) {
+    records[moved.index].row = row;
+  }
+}
+
+auto World::matchingChunks(ComponentMask mask)
+    -> const std::vector<ChunkRef>&
+{
+  chunkRefs.clear();
+  for (const auto& archetype : archetypes) {
+    if ((archetype->mask() & mask) != mask) {
+      continue;
+    }
+    for (std::size_t chunk = 0; chunk < archetype->chunkCount(); chunk++) {
+      chunkRefs.push_back({.archetype = archetype.get(), .chunk = chunk});
+    }
+  }
+  return chunkRefs;
+}
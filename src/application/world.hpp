@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "archetype.hpp"
+#include "component.hpp"
+#include "taskScheduler.hpp"
+
+// Entities and their components, grouped into archetypes.
+//
+// Queries visit every chunk of every archetype that has all the requested
+// components and pass the callback one span per component, so systems run
+// over contiguous arrays and never look up entities one by one. Adding or
+// removing a component moves the entity to another archetype, which copies
+// its row; destroying one moves the archetype's last row into its place.
+//
+// Structural changes (create, destroy, add, remove) invalidate the spans
+// and must not happen while a query runs. Values are zero-initialised when
+// not given.
+class World
+{
+public:
+  struct Stats
+  {
+    std::size_t entities = 0;
+    std::size_t archetypes = 0;
+    std::size_t chunks = 0;
+  };
+
+  World() = default;
+  ~World() = default;
+
+  World(const World&) = delete;
+  World& operator=(const World&) = delete;
+  World(World&&) = delete;
+  World& operator=(World&&) = delete;
+
+  template <Component... Ts>
+  auto create(const typename Ts::Value&... values) -> Entity
+  {
+    Archetype& archetype = archetypeFor(componentMask<Ts...>());
+    const Entity entity = allocate(archetype);
+    const std::size_t row = records[entity.index].row;
+    ((archetype.component<Ts>(row) = values), ...);
+    return entity;
+  }
+
+  // Throws std::out_of_range for stale or invalid handles, as do the
+  // accessors below
+  void destroy(Entity entity);
+
+  [[nodiscard]] auto alive(Entity entity) const -> bool;
+
+  template <Component T>
+  [[nodiscard]] auto has(Entity entity) const -> bool
+  {
+    return record(entity).archetype->has(componentId<T>());
+  }
+
+  // Throws std::out_of_range if the entity does not have T. The reference
+  // is invalidated by structural changes.
+  template <Component T>
+  auto get(Entity entity) -> typename T::Value&
+  {
+    const Record& found = record(entity);
+    if (!found.archetype->has(componentId<T>())) {
+      throw std::out_of_range("Entity has no component " + std::string(T::name)
+                              + ".");
+    }
+    return found.archetype->component<T>(found.row);
+  }
+
+  // Sets the value if the entity already has T
+  template <Component T>
+  void add(Entity entity, const typename T::Value& value = {})
+  {
+    const Record& found = record(entity);
+    const ComponentMask mask = found.archetype->mask();
+    if ((mask & componentMask<T>()) == 0) {
+      move(entity, mask | componentMask<T>());
+    }
+    get<T>(entity) = value;
+  }
+
+  template <Component T>
+  void remove(Entity entity)
+  {
+    const Record& found = record(entity);
+    const ComponentMask mask = found.archetype->mask();
+    if ((mask & componentMask<T>()) != 0) {
+      move(entity, mask & ~componentMask<T>());
+    }
+  }
+
+  [[nodiscard]] auto size() const -> std::size_t { return entityCount; }
+
+  // Calls fn(std::span<Ts::Value>...) for each chunk with all of Ts, in a
+  // stable order as long as there are no structural changes
+  template <Component... Ts, typename Fn>
+  void each(Fn&& fn)
+  {
+    const ComponentMask mask = componentMask<Ts...>();
+    for (const auto& archetype : archetypes) {
+      if ((archetype->mask() & mask) != mask) {
+        continue;
+      }
+      for (std::size_t chunk = 0; chunk < archetype->chunkCount(); chunk++) {
+        const std::size_t count = archetype->chunkSize(chunk);
+        fn(std::span<typename Ts::Value>(archetype->column<Ts>(chunk),
+                                         count)...);
+      }
+    }
+  }
+
+  // Like each(), but chunks run as tasks on scheduler, grain at a time.
+  // Returns once all have run.
+  template <Component... Ts, typename Fn>
+  void parallelEach(TaskScheduler& scheduler, std::size_t grain, Fn&& fn)
+  {
+    const std::vector<ChunkRef>& chunks =
+        matchingChunks(componentMask<Ts...>());
+    scheduler.parallelFor(
+        chunks.size(),
+        grain,
+        [&](std::size_t first, std::size_t last)
+        {
+          for (std::size_t i = first; i < last; i++) {
+            const ChunkRef& ref = chunks[i];
+            const std::size_t count = ref.archetype->chunkSize(ref.chunk);
+            fn(std::span<typename Ts::Value>(
+                ref.archetype->column<Ts>(ref.chunk), count)...);
+          }
+        });
+  }
+
+  // Entities with all of Ts
+  template <Component... Ts>
+  [[nodiscard]] auto count() const -> std::size_t
+  {
+    const ComponentMask mask = componentMask<Ts...>();
+    std::size_t total = 0;
+    for (const auto& archetype : archetypes) {
+      if ((archetype->mask() & mask) == mask) {
+        total += archetype->size();
+      }
+    }
+    return total;
+  }
+
+  [[nodiscard]] auto getStats() const -> Stats;
+
+private:
+  struct Record
+  {
+    Archetype* archetype = nullptr;
+    std::size_t row = 0;
+    uint32_t generation = 0;
+  };
+
+  struct ChunkRef
+  {
+    Archetype* archetype;
+    std::size_t chunk;
+  };
+
+  // In creation order, so queries visit them in a stable order
+  std::vector<std::unique_ptr<Archetype>> archetypes;
+  std::unordered_map<ComponentMask, Archetype*> archetypeByMask;
+
+  std::vector<Record> records;  // By entity index
+  std::vector<uint32_t> freeList;
+  std::size_t entityCount = 0;
+
+  // Scratch list for parallelEach()
+  std::vector<ChunkRef> chunkRefs;
+
+  auto archetypeFor(ComponentMask mask) -> Archetype&;
+  auto allocate(Archetype& archetype) -> Entity;
+  [[nodiscard]] auto record(Entity entity) const -> const Record&;
+  void move(Entity entity, ComponentMask mask);
+  void removeRow(Archetype& archetype, std::size_t row);
+  auto matchingChunks(ComponentMask mask) -> const std::vector<ChunkRef>&;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <vector>
+
+struct Measurement
+{
+  uint64_t iterations = 0;
+  double seconds = 0.0;
+
+  [[nodiscard]] auto secondsPerIteration() const -> double
+  {
+    return seconds / static_cast<double>(iterations);
+  }
+
+  // Rate of some unit of work done once per iteration
+  [[nodiscard]] auto perSecond(double unitsPerIteration) const -> double
+  {
+    return unitsPerIteration / secondsPerIteration();
+  }
+};
+
+// Runs fn once to warm up, then repeatedly until both minIterations and
+// minSeconds have been reached. fn must not return before its GPU work has
+// completed.
+template <typename F>
+auto measure(F&& fn, double minSeconds = 1.0, uint64_t minIterations = 3)
+    -> Measurement
+{
+  using Clock = std::chrono::steady_clock;
+
+  fn();
+
+  Measurement measurement;
+  const auto start = Clock::now();
+  while (measurement.iterations < minIterations
+         || measurement.seconds < minSeconds)
+  {
+    fn();
+    measurement.iterations++;
+    measurement.seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+  }
+  return measurement;
+}
+
+// Problem sizes from the command line, or the defaults if none are given
+inline auto parseSizes(int argc,
+                       char** argv,
+                       std::span<const uint32_t> defaults)
+    -> std::vector<uint32_t>
+{
+  std::vector<uint32_t> sizes;
+  for (int i = 1; i < argc; i++) {
+    sizes.push_back(
+        static_cast<uint32_t>(std::strtoul(argv[i], nullptr, 10)));
+  }
+  if (sizes.empty()) {
+    sizes.assign(defaults.begin(), defaults.end());
+  }
+  return sizes;
+}
@@ -0,0 +1,132 @@
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <fmt/base.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "benchmark.hpp"
+#include "cullingGrid.hpp"
+#include "cullingKernels.hpp"
+#include "entities.hpp"
+#include "scene/frustum.hpp"
+#include "taskScheduler.hpp"
+
+// Usage: culling-benchmark [object counts...]
+//
+// Culls bounding spheres scattered through a cube against a camera inside
+// it, for every SIMD level this CPU supports, on all hardware threads:
+//
+//   brute  every sphere is tested
+//   grid   CullingGrid is rebuilt and culled, as the renderer does each
+//          frame; only spheres in cells crossing a plane are tested
+//
+// The ms column is per frame and includes the grid's build.
+int main(int argc, char** argv)
+{
+  constexpr std::array<uint32_t, 4> defaultCounts = {
+      1 << 12, 1 << 15, 1 << 18, 1 << 21};
+  constexpr std::size_t chunkSize = 16 * 1024;
+  constexpr float side = 10.0F;
+  constexpr float cellSize = 1.0F;
+
+  const auto viewProjection =
+      glm::perspectiveRH_ZO(glm::radians(60.0F), 16.0F / 9.0F, 0.1F, side)
+      * glm::lookAt(glm::vec3(0.0F, -side, 0.0F),
+                    glm::vec3(0.0F),
+                    glm::vec3(0.0F, 0.0F, 1.0F));
+  const FrustumPlanes planes = Frustum::fromMatrix(viewProjection).planes;
+
+  TaskScheduler scheduler;
+  fmt::println("Threads: {}", scheduler.threadCount());
+  fmt::println("{:>10} {:>8} {:>8} {:>10} {:>10} {:>10}",
+               "objects",
+               "method",
+               "simd",
+               "visible",
+               "ms",
+               "speedup");
+
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> coordinate(-side, side);
+  std::uniform_real_distribution<float> size(0.05F, 0.2F);
+  for (const auto count : parseSizes(argc, argv, defaultCounts)) {
+    AlignedFloats centerX(count);
+    AlignedFloats centerY(count);
+    AlignedFloats centerZ(count);
+    AlignedFloats radius(count);
+    for (uint32_t i = 0; i < count; i++) {
+      centerX[i] = coordinate(random);
+      centerY[i] = coordinate(random);
+      centerZ[i] = coordinate(random);
+      radius[i] = size(random);
+    }
+    const SphereSpan spheres {.centerX = centerX.data(),
+                              .centerY = centerY.data(),
+                              .centerZ = centerZ.data(),
+                              .radius = radius.data(),
+                              .count = count};
+    std::vector<uint32_t> visible(count);
+
+    double baseline = 0.0;
+    const auto report = [&](const char* method,
+                            SimdLevel level,
+                            std::size_t visibleCount,
+                            const Measurement& measurement)
+    {
+      const double milliseconds = measurement.secondsPerIteration() * 1e3;
+      if (baseline == 0.0) {
+        baseline = milliseconds;  // Scalar brute force
+      }
+      fmt::println("{:>10} {:>8} {:>8} {:>10} {:>10.3f} {:>9.2f}x",
+                   count,
+                   method,
+                   simdLevelName(level),
+                   visibleCount,
+                   milliseconds,
+                   baseline / milliseconds);
+    };
+
+    for (const auto level : availableSimdLevels()) {
+      const CullKernel kernel = cullKernel(level);
+      std::atomic<std::size_t> visibleCount = 0;
+      const auto brute = measure(
+          [&]
+          {
+            visibleCount = 0;
+            scheduler.parallelFor(
+                count,
+                chunkSize,
+                [&](std::size_t first, std::size_t last)
+                {
+                  visibleCount += kernel(spheres.subspan(first, last),
+                                         planes,
+                                         static_cast<uint32_t>(first),
+                                         visible.data() + first);
+                });
+          },
+          0.5,
+          10);
+      report("brute", level, visibleCount, brute);
+    }
+
+    for (const auto level : availableSimdLevels()) {
+      CullingGrid grid(cellSize, 4, level);
+      const auto measurement = measure(
+          [&]
+          {
+            grid.build(spheres);
+            grid.cull(planes, scheduler);
+          },
+          0.5,
+          10);
+      report("grid", level, grid.getStats().visible, measurement);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,124 @@
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <fmt/base.h>
+
+#include "benchmark.hpp"
+#include "buffers/deviceBuffer.hpp"
+#include "buffers/hostBuffer.hpp"
+#include "computeBatch.hpp"
+#include "defragmenter.hpp"
+#include "headlessContext.hpp"
+
+// Usage: defragmentation-benchmark [buffer counts...]
+//
+// Fills count buffers of 16 to 256 KB with their index, frees every other
+// one and runs the Defragmenter until it is done, reporting the passes it
+// took, what it moved and how much memory it gave back. The survivors are
+// then read back by a batch recorded before the defragmentation, which only
+// sees the right contents if moved buffers were patched in place.
+int main(int argc, char** argv)
+{
+  constexpr std::array<uint32_t, 3> defaultCounts = {256, 1024, 4096};
+  constexpr uint32_t minWords = 4 * 1024;
+  constexpr uint32_t maxWords = 64 * 1024;
+
+  HeadlessContext context("defragmentation-benchmark");
+  fmt::println("Device: {}", context.deviceName());
+  fmt::println("{:>8} {:>8} {:>8} {:>10} {:>10} {:>10} {:>8}",
+               "buffers",
+               "passes",
+               "moved",
+               "MB moved",
+               "MB freed",
+               "ms",
+               "valid");
+
+  std::mt19937 random(1);
+  std::uniform_int_distribution<uint32_t> words(minWords, maxWords);
+  for (const auto count : parseSizes(argc, argv, defaultCounts)) {
+    std::vector<std::unique_ptr<DeviceBuffer>> buffers;
+    ComputeBatch fill;
+    for (uint32_t i = 0; i < count; i++) {
+      buffers.push_back(
+          std::make_unique<DeviceBuffer>(context.device->handle,
+                                         context.allocator,
+                                         words(random) * sizeof(uint32_t)));
+      fill.fill(*buffers.back(), i);
+    }
+    context.compute->submit(fill);
+
+    // Leave holes all over the blocks
+    vk::DeviceSize survivingBytes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+      if (i % 2 == 0) {
+        buffers[i].reset();
+      } else {
+        survivingBytes += buffers[i]->size;
+      }
+    }
+
+    HostBuffer readback(context.device->handle,
+                        context.allocator,
+                        survivingBytes,
+                        nullptr,
+                        vk::BufferUsageFlagBits::eTransferDst,
+                        VMA_MEMORY_USAGE_AUTO,
+                        VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT
+                            | VMA_ALLOCATION_CREATE_MAPPED_BIT);
+    ComputeBatch readbackBatch;
+    vk::DeviceSize offset = 0;
+    for (uint32_t i = 1; i < count; i += 2) {
+      readbackBatch.copy(*buffers[i], readback, buffers[i]->size, 0, offset);
+      offset += buffers[i]->size;
+    }
+
+    Defragmenter defragmenter(
+        context.device->handle,
+        context.allocator,
+        context.device->queueFamilyIndices.computeFamily.value());
+    defragmenter.request();
+    uint32_t passes = 0;
+    const auto start = std::chrono::steady_clock::now();
+    do {
+      passes++;
+    } while (defragmenter.step());
+    const auto seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+    context.compute->submit(readbackBatch);
+    std::vector<uint32_t> values(survivingBytes / sizeof(uint32_t));
+    vmaCopyAllocationToMemory(context.allocator,
+                              readback.allocation,
+                              0,
+                              values.data(),
+                              survivingBytes);
+
+    bool valid = true;
+    std::size_t value = 0;
+    for (uint32_t i = 1; i < count; i += 2) {
+      const auto bufferWords = buffers[i]->size / sizeof(uint32_t);
+      for (std::size_t word = 0; word < bufferWords; word++) {
+        valid = valid && values[value++] == i;
+      }
+    }
+
+    const auto& stats = defragmenter.totalStats;
+    fmt::println("{:>8} {:>8} {:>8} {:>10.1f} {:>10.1f} {:>10.3f} {:>8}",
+                 count,
+                 passes,
+                 stats.allocationsMoved,
+                 static_cast<double>(stats.bytesMoved) / 1.0e6,
+                 static_cast<double>(stats.bytesFreed) / 1.0e6,
+                 seconds * 1.0e3,
+                 valid ? "yes" : "NO");
+  }
+
+  return 0;
+}
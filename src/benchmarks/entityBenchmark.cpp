@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <fmt/base.h>
+#include <glm/glm.hpp>
+
+#include "benchmark.hpp"
+#include "entities.hpp"
+#include "entityKernels.hpp"
+#include "gameComponents.hpp"
+#include "taskScheduler.hpp"
+#include "world.hpp"
+
+namespace
+{
+// Entity state as a structure of arrays: every component lives in its own
+// cache-line aligned array, so a kernel streams through exactly the
+// components it needs and processes a full SIMD register of entities per
+// load.
+struct EntityArrays
+{
+  AlignedFloats positionX;
+  AlignedFloats positionY;
+  AlignedFloats velocityX;
+  AlignedFloats velocityY;
+
+  [[nodiscard]] auto size() const -> std::size_t { return positionX.size(); }
+
+  void reserve(std::size_t count)
+  {
+    positionX.reserve(count);
+    positionY.reserve(count);
+    velocityX.reserve(count);
+    velocityY.reserve(count);
+  }
+
+  void push_back(glm::vec2 position, glm::vec2 velocity)
+  {
+    positionX.push_back(position.x);
+    positionY.push_back(position.y);
+    velocityX.push_back(velocity.x);
+    velocityY.push_back(velocity.y);
+  }
+
+  auto span() -> EntitySpan
+  {
+    return {.positionX = positionX.data(),
+            .positionY = positionY.data(),
+            .velocityX = velocityX.data(),
+            .velocityY = velocityY.data(),
+            .count = size()};
+  }
+};
+}  // namespace
+
+// Usage: entity-benchmark [entity counts...]
+//
+// Runs the entity update for every SIMD level this CPU supports and for
+// thread counts doubling up to the hardware thread count. Small counts fit
+// in cache and show the kernel's compute throughput; large ones are bound
+// by memory bandwidth, where extra threads stop helping.
+//
+// The best level is then run again over the same entities stored in a
+// World, as the game stores them, to show what chunked storage costs
+// compared to flat arrays.
+int main(int argc, char** argv)
+{
+  constexpr std::array<uint32_t, 4> defaultCounts = {
+      1 << 14, 1 << 17, 1 << 20, 1 << 23};
+  constexpr std::size_t chunkSize = 16 * 1024;
+  constexpr std::size_t chunksPerTask = 4;  // Game::chunksPerTask
+  const EntityStep step {};
+
+  // Only one scheduler may live on the main thread at a time, so each
+  // thread count is measured with its own in turn
+  std::vector<uint32_t> workerCounts;
+  for (uint32_t threads = 1;; threads *= 2) {
+    workerCounts.push_back(
+        std::min(threads - 1, TaskScheduler::defaultWorkerCount()));
+    if (workerCounts.back() == TaskScheduler::defaultWorkerCount()) {
+      break;
+    }
+  }
+
+  fmt::println("{:>10} {:>8} {:>8} {:>8} {:>14} {:>10}",
+               "entities",
+               "layout",
+               "simd",
+               "threads",
+               "entities/ms",
+               "speedup");
+
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> position(-1.0F, 1.0F);
+  std::uniform_real_distribution<float> velocity(-0.5F, 0.5F);
+  for (const auto count : parseSizes(argc, argv, defaultCounts)) {
+    EntityArrays entities;
+    entities.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+      entities.push_back({position(random), position(random)},
+                         {velocity(random), velocity(random)});
+    }
+    const EntitySpan all = entities.span();
+
+    double baseline = 0.0;
+    for (const auto level : availableSimdLevels()) {
+      const EntityKernel kernel = entityKernel(level);
+      for (const auto workerCount : workerCounts) {
+        TaskScheduler scheduler(workerCount);
+        const auto measurement = measure(
+            [&]
+            {
+              scheduler.parallelFor(
+                  count,
+                  chunkSize,
+                  [&](std::size_t first, std::size_t last)
+                  { kernel(all.subspan(first, last), step); });
+            },
+            0.5,
+            10);
+
+        const double rate = measurement.perSecond(count) / 1000.0;
+        if (baseline == 0.0) {
+          baseline = rate;  // Scalar on one thread
+        }
+        fmt::println("{:>10} {:>8} {:>8} {:>8} {:>14.0f} {:>9.2f}x",
+                     count,
+                     "arrays",
+                     simdLevelName(level),
+                     scheduler.threadCount(),
+                     rate,
+                     rate / baseline);
+      }
+    }
+
+    World world;
+    for (uint32_t i = 0; i < count; i++) {
+      world.create<PositionX, PositionY, VelocityX, VelocityY>(
+          entities.positionX[i],
+          entities.positionY[i],
+          entities.velocityX[i],
+          entities.velocityY[i]);
+    }
+    const EntityKernel kernel = entityKernel(bestSimdLevel());
+    for (const auto workerCount : workerCounts) {
+      TaskScheduler scheduler(workerCount);
+      const auto measurement = measure(
+          [&]
+          {
+            world.parallelEach<PositionX, PositionY, VelocityX, VelocityY>(
+                scheduler,
+                chunksPerTask,
+                [&](std::span<float> positionX,
+                    std::span<float> positionY,
+                    std::span<float> velocityX,
+                    std::span<float> velocityY)
+                {
+                  kernel({.positionX = positionX.data(),
+                          .positionY = positionY.data(),
+                          .velocityX = velocityX.data(),
+                          .velocityY = velocityY.data(),
+                          .count = positionX.size()},
+                         step);
+                });
+          },
+          0.5,
+          10);
+
+      const double rate = measurement.perSecond(count) / 1000.0;
+      fmt::println("{:>10} {:>8} {:>8} {:>8} {:>14.0f} {:>9.2f}x",
+                   count,
+                   "chunks",
+                   simdLevelName(bestSimdLevel()),
+                   scheduler.threadCount(),
+                   rate,
+                   rate / baseline);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,93 @@
+#include <vector>
+
+#include "headlessContext.hpp"
+
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+HeadlessContext::HeadlessContext(const std::string& name)
+{
+#if (VULKAN_HPP_DISPATCH_LOADER_DYNAMIC == 1)
+  static vk::detail::DynamicLoader dl;
+  VULKAN_HPP_DEFAULT_DISPATCHER.init(dl);
+#endif
+
+  std::vector<const char*> enabledExtensions;
+  std::vector<const char*> enabledLayers;
+#if !defined(NDEBUG)
+  enabledLayers.push_back("VK_LAYER_KHRONOS_validation");
+#endif
+
+#ifdef __APPLE__
+  auto flags = vk::InstanceCreateFlags {
+      vk::InstanceCreateFlagBits::eEnumeratePortabilityKHR};
+
+  enabledExtensions.push_back(
+      VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+  enabledExtensions.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
+#else
+  auto flags = vk::InstanceCreateFlags {};
+#endif
+
+  const vk::ApplicationInfo applicationInfo {
+      .pApplicationName = name.c_str(),
+      .applicationVersion = VK_MAKE_VERSION(0, 0, 1),
+      .pEngineName = "NewEngine",
+      .engineVersion = VK_MAKE_VERSION(0, 0, 1),
+      .apiVersion = VK_API_VERSION_1_3};
+
+  instance = vk::createInstance(
+      {.flags = flags,
+       .pApplicationInfo = &applicationInfo,
+       .enabledLayerCount = static_cast<uint32_t>(enabledLayers.size()),
+       .ppEnabledLayerNames = enabledLayers.data(),
+       .enabledExtensionCount =
+           static_cast<uint32_t>(enabledExtensions.size()),
+       .ppEnabledExtensionNames = enabledExtensions.data()});
+
+#if (VULKAN_HPP_DISPATCH_LOADER_DYNAMIC == 1)
+  VULKAN_HPP_DEFAULT_DISPATCHER.init(instance);
+#endif
+
+  device = std::make_unique<Device>(instance);
+
+#if (VULKAN_HPP_DISPATCH_LOADER_DYNAMIC == 1)
+  VULKAN_HPP_DEFAULT_DISPATCHER.init(device->handle);
+#endif
+
+  VmaAllocatorCreateInfo allocatorInfo = {};
+  allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_3;
+  allocatorInfo.physicalDevice = device->physicalDevice;
+  allocatorInfo.device = device->handle;
+  allocatorInfo.instance = instance;
+
+  vmaCreateAllocator(&allocatorInfo, &allocator);
+
+  // Kernels bring their own layouts; the executor's set is unused
+  std::vector<vk::DescriptorPoolSize> poolSizes = {
+      {.type = vk::DescriptorType::eStorageBuffer, .descriptorCount = 1}};
+  descriptorPool = device->createDescriptorPool(poolSizes, 1);
+
+  std::vector<vk::DescriptorSetLayoutBinding> bindings;
+  compute = std::make_unique<Compute>(
+      device->handle,
+      device->queueFamilyIndices.computeFamily.value(),
+      descriptorPool,
+      bindings);
+}
+
+HeadlessContext::~HeadlessContext()
+{
+  device->handle.waitIdle();
+
+  compute.reset();
+  device->handle.destroyDescriptorPool(descriptorPool);
+  vmaDestroyAllocator(allocator);
+  device->destroy();
+  instance.destroy();
+}
+
+auto HeadlessContext::deviceName() const -> std::string
+{
+  return device->physicalDevice.getProperties().deviceName;
+}
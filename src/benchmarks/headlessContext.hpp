@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <vulkan/vulkan.hpp>
+
+#include "compute.hpp"
+#include "device.hpp"
+#include "vk_mem_alloc.h"
+
+// Instance, device, allocator and compute executor without a window, for
+// benchmarks and tools. Picks the first device with a compute queue; set
+// VK_ICD_FILENAMES (or VK_DRIVER_FILES) to force a specific driver such as
+// lavapipe.
+class HeadlessContext
+{
+public:
+  explicit HeadlessContext(const std::string& name);
+  ~HeadlessContext();
+
+  HeadlessContext(const HeadlessContext&) = delete;
+  HeadlessContext& operator=(const HeadlessContext&) = delete;
+  HeadlessContext(HeadlessContext&&) = delete;
+  HeadlessContext& operator=(HeadlessContext&&) = delete;
+
+  [[nodiscard]] auto deviceName() const -> std::string;
+
+  vk::Instance instance;
+  std::unique_ptr<Device> device = nullptr;
+  VmaAllocator allocator = nullptr;
+  std::unique_ptr<Compute> compute = nullptr;
+
+private:
+  vk::DescriptorPool descriptorPool;
+};
@@ -0,0 +1,54 @@
+#include <array>
+#include <cstdint>
+
+#include <fmt/base.h>
+
+#include "benchmark.hpp"
+#include "computeBatch.hpp"
+#include "headlessContext.hpp"
+#include "simulation/nbody.hpp"
+
+// Usage: nbody-benchmark [particle counts...]
+//
+// The defaults are sized so a CPU implementation such as lavapipe finishes
+// in seconds; pass e.g. 100000 1000000 on a discrete GPU.
+int main(int argc, char** argv)
+{
+  constexpr std::array<uint32_t, 3> defaultCounts = {4096, 16384, 65536};
+  constexpr uint32_t stepsPerBatch = 8;
+
+  HeadlessContext context("nbody-benchmark");
+  fmt::println("Device: {}", context.deviceName());
+  fmt::println("{:>10} {:>12} {:>16} {:>20}",
+               "particles",
+               "ms/step",
+               "particles/s",
+               "interactions/s");
+
+  for (const auto count : parseSizes(argc, argv, defaultCounts)) {
+    NBody nbody(*context.device,
+                context.allocator,
+                *context.compute,
+                {.particleCount = count});
+
+    // Record several steps per submission, as the renderer does
+    ComputeBatch batch;
+    for (uint32_t i = 0; i < stepsPerBatch; i++) {
+      nbody.step(batch);
+    }
+
+    const auto measurement =
+        measure([&] { context.compute->submit(batch); }, 2.0);
+    const auto stepSeconds =
+        measurement.secondsPerIteration() / stepsPerBatch;
+
+    fmt::println("{:>10} {:>12.3f} {:>16.3e} {:>20.3e}",
+                 count,
+                 stepSeconds * 1.0e3,
+                 count / stepSeconds,
+                 static_cast<double>(nbody.interactionsPerStep())
+                     / stepSeconds);
+  }
+
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <fmt/base.h>
+
+#include "benchmark.hpp"
+#include "buffers/deviceBuffer.hpp"
+#include "buffers/hostBuffer.hpp"
+#include "computeBatch.hpp"
+#include "headlessContext.hpp"
+#include "primitives/prefixScan.hpp"
+#include "primitives/radixSort.hpp"
+#include "primitives/streamCompaction.hpp"
+
+namespace
+{
+auto download(HeadlessContext& context, Buffer& buffer, uint32_t count)
+    -> std::vector<uint32_t>
+{
+  const vk::DeviceSize size = count * sizeof(uint32_t);
+  HostBuffer readback(context.device->handle,
+                      context.allocator,
+                      size,
+                      nullptr,
+                      vk::BufferUsageFlagBits::eTransferDst,
+                      VMA_MEMORY_USAGE_AUTO,
+                      VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT
+                          | VMA_ALLOCATION_CREATE_MAPPED_BIT);
+
+  ComputeBatch batch;
+  batch.copy(buffer, readback, size);
+  context.compute->submit(batch);
+
+  std::vector<uint32_t> values(count);
+  vmaCopyAllocationToMemory(
+      context.allocator, readback.allocation, 0, values.data(), size);
+  return values;
+}
+}  // namespace
+
+// Usage: primitives-benchmark [element counts...]
+//
+// Times the exclusive scan, stream compaction of every other element and
+// the 32-bit key-value radix sort, and checks each result against the CPU.
+// Every iteration first restores the unsorted input with a copy, whose
+// time is measured separately and subtracted.
+int main(int argc, char** argv)
+{
+  constexpr std::array<uint32_t, 6> defaultCounts = {
+      1 << 10, 1 << 14, 1 << 18, 1 << 20, 1 << 22, 1 << 24};
+
+  HeadlessContext context("primitives-benchmark");
+  fmt::println("Device: {}", context.deviceName());
+  fmt::println("{:>10} {:>14} {:>14} {:>14} {:>8}",
+               "elements",
+               "scan elem/s",
+               "compact el/s",
+               "sort keys/s",
+               "valid");
+
+  PrefixScan scan(*context.device, context.allocator, *context.compute);
+  StreamCompaction compaction(
+      *context.device, context.allocator, *context.compute);
+  RadixSort radixSort(*context.device, context.allocator, *context.compute);
+
+  std::mt19937 random(1);
+  for (const auto count : parseSizes(argc, argv, defaultCounts)) {
+    const vk::DeviceSize size = count * sizeof(uint32_t);
+
+    std::vector<uint32_t> keys(count);
+    std::ranges::generate(keys, [&] { return random(); });
+    std::vector<uint32_t> indices(count);
+    std::iota(indices.begin(), indices.end(), 0U);
+    std::vector<uint32_t> flags(count);
+    for (uint32_t i = 0; i < count; i++) {
+      flags[i] = i % 2;
+    }
+
+    const auto storage = vk::BufferUsageFlagBits::eStorageBuffer;
+    auto upload = [&](const std::vector<uint32_t>& data) {
+      return std::make_unique<HostBuffer>(
+          context.device->handle,
+          context.allocator,
+          size,
+          data.data(),
+          vk::BufferUsageFlagBits::eTransferSrc);
+    };
+    const auto keySource = upload(keys);
+    const auto indexSource = upload(indices);
+    const auto flagSource = upload(flags);
+
+    auto makeBuffer = [&] {
+      return std::make_unique<DeviceBuffer>(
+          context.device->handle, context.allocator, size, storage);
+    };
+    const auto sortKeys = makeBuffer();
+    const auto sortValues = makeBuffer();
+    const auto flagBuffer = makeBuffer();
+    const auto scanned = makeBuffer();
+    const auto compacted = makeBuffer();
+    const auto keptCount = std::make_unique<DeviceBuffer>(
+        context.device->handle, context.allocator, sizeof(uint32_t), storage);
+
+    ComputeBatch restore;
+    restore.copy(*keySource, *sortKeys, size)
+        .copy(*indexSource, *sortValues, size)
+        .copy(*flagSource, *flagBuffer, size);
+    context.compute->submit(restore);
+
+    ComputeBatch scanBatch;
+    scan.exclusive(scanBatch, *flagBuffer, *scanned, count);
+
+    ComputeBatch compactBatch;
+    compaction.compact(
+        compactBatch, *sortKeys, *flagBuffer, *compacted, *keptCount, count);
+
+    ComputeBatch sortBatch;
+    sortBatch.copy(*keySource, *sortKeys, size)
+        .copy(*indexSource, *sortValues, size);
+    radixSort.sort(sortBatch, *sortKeys, *sortValues, count);
+
+    ComputeBatch copyBatch;
+    copyBatch.copy(*keySource, *sortKeys, size)
+        .copy(*indexSource, *sortValues, size);
+
+    const auto submit = [&](const ComputeBatch& batch) {
+      return [&] { context.compute->submit(batch); };
+    };
+    const auto scanTime = measure(submit(scanBatch)).secondsPerIteration();
+    const auto compactTime =
+        measure(submit(compactBatch)).secondsPerIteration();
+    const auto copyTime = measure(submit(copyBatch)).secondsPerIteration();
+    const auto sortTime =
+        measure(submit(sortBatch)).secondsPerIteration() - copyTime;
+
+    // The last sort iteration left sorted pairs behind
+    const auto sortedKeys = download(context, *sortKeys, count);
+    const auto sortedValues = download(context, *sortValues, count);
+    bool valid = true;
+    for (uint32_t i = 0; i < count && valid; i++) {
+      valid = sortedKeys[i] == keys[sortedValues[i]]
+          && (i == 0 || sortedKeys[i - 1] < sortedKeys[i]
+              || (sortedKeys[i - 1] == sortedKeys[i]
+                  && sortedValues[i - 1] < sortedValues[i]));
+    }
+
+    std::vector<uint32_t> expected(count);
+    std::exclusive_scan(flags.begin(), flags.end(), expected.begin(), 0U);
+    valid = valid && download(context, *scanned, count) == expected;
+    valid = valid && download(context, *keptCount, 1)[0] == count / 2;
+
+    fmt::println("{:>10} {:>14.3e} {:>14.3e} {:>14.3e} {:>8}",
+                 count,
+                 count / scanTime,
+                 count / compactTime,
+                 count / sortTime,
+                 valid ? "yes" : "NO");
+  }
+
+  return 0;
+}
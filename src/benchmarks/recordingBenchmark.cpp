@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <fmt/base.h>
+
+#include "benchmark.hpp"
+#include "buffers/hostBuffer.hpp"
+#include "headlessContext.hpp"
+#include "parallelRecorder.hpp"
+#include "taskScheduler.hpp"
+
+// Usage: recording-benchmark [command counts...]
+//
+// Records small buffer fills through ParallelRecorder for thread counts
+// doubling up to the hardware thread count and reports how many commands
+// per millisecond the CPU records. Each fill overwrites a slot written by
+// earlier commands, so reading the buffer back after one submission checks
+// that the secondary command buffers ran in order.
+int main(int argc, char** argv)
+{
+  constexpr std::array<uint32_t, 3> defaultCounts = {
+      1 << 12, 1 << 15, 1 << 18};
+  constexpr std::size_t grain = 1024;  // Commands per secondary
+  constexpr uint32_t slotCount = 4096;
+
+  HeadlessContext context("recording-benchmark");
+  fmt::println("Device: {}", context.deviceName());
+  fmt::println("{:>10} {:>8} {:>12} {:>14} {:>10}",
+               "commands",
+               "threads",
+               "record ms",
+               "commands/ms",
+               "speedup");
+
+  const vk::DeviceSize size = slotCount * sizeof(uint32_t);
+  HostBuffer slots(context.device->handle,
+                   context.allocator,
+                   size,
+                   nullptr,
+                   vk::BufferUsageFlagBits::eTransferDst,
+                   VMA_MEMORY_USAGE_AUTO,
+                   VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT
+                       | VMA_ALLOCATION_CREATE_MAPPED_BIT);
+
+  const auto fill = [&](vk::CommandBuffer commandBuffer,
+                        std::size_t first,
+                        std::size_t last)
+  {
+    for (std::size_t i = first; i < last; i++) {
+      commandBuffer.fillBuffer(slots.getHandle(),
+                               (i % slotCount) * sizeof(uint32_t),
+                               sizeof(uint32_t),
+                               static_cast<uint32_t>(i));
+    }
+  };
+
+  for (const auto count : parseSizes(argc, argv, defaultCounts)) {
+    double baseline = 0.0;
+    for (uint32_t threads = 1;; threads *= 2) {
+      const uint32_t workerCount =
+          std::min(threads - 1, TaskScheduler::defaultWorkerCount());
+      TaskScheduler scheduler(workerCount);
+      ParallelRecorder recorder(context.device->handle,
+                                context.compute->queueFamilyIndex,
+                                scheduler);
+
+      // Recording only; nothing is submitted while timing
+      const auto commandBuffer = context.compute->commandBuffer;
+      const auto measurement = measure(
+          [&]
+          {
+            recorder.beginFrame();
+            commandBuffer.begin(vk::CommandBufferBeginInfo {
+                .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+            recorder.record(commandBuffer, count, grain, fill);
+            commandBuffer.end();
+          },
+          0.5,
+          10);
+
+      recorder.beginFrame();
+      context.compute->execute(
+          [&](vk::CommandBuffer primary)
+          { recorder.record(primary, count, grain, fill); });
+
+      std::vector<uint32_t> values(slotCount);
+      vmaCopyAllocationToMemory(
+          context.allocator, slots.allocation, 0, values.data(), size);
+      for (uint32_t slot = 0; slot < std::min(count, slotCount); slot++) {
+        const uint32_t expected =
+            slot + (count - 1 - slot) / slotCount * slotCount;
+        if (values[slot] != expected) {
+          fmt::println("Mismatch at slot {}: {} != {}",
+                       slot,
+                       values[slot],
+                       expected);
+          return 1;
+        }
+      }
+
+      const double rate = measurement.perSecond(count) / 1000.0;
+      if (baseline == 0.0) {
+        baseline = rate;
+      }
+      fmt::println("{:>10} {:>8} {:>12.3f} {:>14.0f} {:>9.2f}x",
+                   count,
+                   scheduler.threadCount(),
+                   measurement.secondsPerIteration() * 1.0e3,
+                   rate,
+                   rate / baseline);
+
+      if (workerCount == TaskScheduler::defaultWorkerCount()) {
+        break;
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <fmt/base.h>
+
+#include "benchmark.hpp"
+#include "buffers/deviceBuffer.hpp"
+#include "buffers/hostBuffer.hpp"
+#include "computeBatch.hpp"
+#include "headlessContext.hpp"
+#include "primitives/reduction.hpp"
+
+namespace
+{
+auto download(HeadlessContext& context, Buffer& buffer, uint32_t count)
+    -> std::vector<uint32_t>
+{
+  const vk::DeviceSize size = count * sizeof(uint32_t);
+  HostBuffer readback(context.device->handle,
+                      context.allocator,
+                      size,
+                      nullptr,
+                      vk::BufferUsageFlagBits::eTransferDst,
+                      VMA_MEMORY_USAGE_AUTO,
+                      VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT
+                          | VMA_ALLOCATION_CREATE_MAPPED_BIT);
+
+  ComputeBatch batch;
+  batch.copy(buffer, readback, size);
+  context.compute->submit(batch);
+
+  std::vector<uint32_t> values(count);
+  vmaCopyAllocationToMemory(
+      context.allocator, readback.allocation, 0, values.data(), size);
+  return values;
+}
+
+auto gigabytesPerSecond(double bytes, double seconds) -> double
+{
+  return bytes / seconds / 1.0e9;
+}
+}  // namespace
+
+// Usage: reduction-benchmark [element counts...]
+//
+// Reads count uints once per reduction and reports the bandwidth achieved
+// by the subgroup and shared memory variants of every kernel next to a
+// buffer copy of the same data, the practical upper bound (a copy reads
+// and writes every byte, so its bandwidth counts both).
+int main(int argc, char** argv)
+{
+  constexpr std::array<uint32_t, 3> defaultCounts = {
+      1 << 20, 1 << 24, 1 << 26};
+  constexpr uint32_t binCount = 64;
+
+  HeadlessContext context("reduction-benchmark");
+  const auto& subgroup = context.device->subgroup;
+  fmt::println("Device: {}", context.deviceName());
+  fmt::println("Subgroup size {} ({}-{}), operations {:#x}, size control {}",
+               subgroup.size,
+               subgroup.minSize,
+               subgroup.maxSize,
+               static_cast<uint32_t>(subgroup.operations),
+               context.device->features.subgroupSizeControl);
+
+  const std::array<std::unique_ptr<Reduction>, 2> variants = {
+      std::make_unique<Reduction>(*context.device, *context.compute, true),
+      std::make_unique<Reduction>(*context.device, *context.compute, false)};
+  if (!variants[0]->usesSubgroups()) {
+    fmt::println("Subgroup arithmetic unsupported; both rows use shared "
+                 "memory");
+  }
+
+  fmt::println("{:>10} {:>10} {:>8} {:>8} {:>8} {:>8} {:>8}",
+               "elements",
+               "variant",
+               "copy",
+               "sum",
+               "min",
+               "max",
+               "hist");
+
+  std::mt19937 random(1);
+  for (const auto count : parseSizes(argc, argv, defaultCounts)) {
+    const vk::DeviceSize size = count * sizeof(uint32_t);
+    const auto bytes = static_cast<double>(size);
+
+    std::vector<uint32_t> values(count);
+    std::ranges::generate(values, [&] { return random() % 1024; });
+
+    const auto storage = vk::BufferUsageFlagBits::eStorageBuffer;
+    HostBuffer staging(context.device->handle,
+                       context.allocator,
+                       size,
+                       values.data(),
+                       vk::BufferUsageFlagBits::eTransferSrc);
+    DeviceBuffer input(
+        context.device->handle, context.allocator, size, storage);
+    DeviceBuffer copy(
+        context.device->handle, context.allocator, size, storage);
+    DeviceBuffer result(context.device->handle,
+                        context.allocator,
+                        Reduction::maxBins * sizeof(uint32_t),
+                        storage);
+
+    ComputeBatch upload;
+    upload.copy(staging, input, size);
+    context.compute->submit(upload);
+
+    ComputeBatch copyBatch;
+    copyBatch.copy(input, copy, size);
+    const auto copySeconds =
+        measure([&] { context.compute->submit(copyBatch); })
+            .secondsPerIteration();
+
+    std::vector<uint32_t> expectedBins(binCount);
+    for (const auto value : values) {
+      expectedBins[value & (binCount - 1)]++;
+    }
+    // The GPU sums in 32 bits, which wraps from about 8M elements of these
+    // values on. Wrapping addition is still exact modulo 2^32 in any order,
+    // so compare against the low half of the full sum.
+    const auto sum =
+        std::accumulate(values.begin(), values.end(), uint64_t {0});
+    const std::array<uint32_t, 3> expected = {
+        static_cast<uint32_t>(sum),
+        *std::ranges::min_element(values),
+        *std::ranges::max_element(values)};
+
+    for (const auto& reduction : variants) {
+      bool valid = true;
+      std::array<double, 4> seconds {};
+
+      for (uint32_t op = 0; op < 3; op++) {
+        ComputeBatch batch;
+        reduction->reduce(
+            batch, input, count, static_cast<ReduceOp>(op), result);
+        seconds[op] = measure([&] { context.compute->submit(batch); })
+                          .secondsPerIteration();
+        valid = valid && download(context, result, 1)[0] == expected[op];
+      }
+
+      ComputeBatch batch;
+      reduction->histogram(batch, input, count, binCount, result);
+      seconds[3] = measure([&] { context.compute->submit(batch); })
+                       .secondsPerIteration();
+      valid = valid && download(context, result, binCount) == expectedBins;
+
+      fmt::println("{:>10} {:>10} {:>8.1f} {:>8.1f} {:>8.1f} {:>8.1f} "
+                   "{:>8.1f}{}",
+                   count,
+                   reduction->usesSubgroups() ? "subgroup" : "shared",
+                   gigabytesPerSecond(2.0 * bytes, copySeconds),
+                   gigabytesPerSecond(bytes, seconds[0]),
+                   gigabytesPerSecond(bytes, seconds[1]),
+                   gigabytesPerSecond(bytes, seconds[2]),
+                   gigabytesPerSecond(bytes, seconds[3]),
+                   valid ? "" : "  INVALID");
+    }
+  }
+
+  fmt::println("Bandwidth in GB/s");
+  return 0;
+}
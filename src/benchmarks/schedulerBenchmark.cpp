@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <fmt/base.h>
+
+#include "benchmark.hpp"
+#include "taskScheduler.hpp"
+
+namespace
+{
+// Splits in two until depth reaches zero, so every thread both spawns and
+// steals. Returns the number of tasks spawned.
+auto forkJoin(TaskScheduler& scheduler, uint32_t depth) -> uint64_t
+{
+  if (depth == 0) {
+    return 0;
+  }
+  uint64_t left = 0;
+  TaskCounter counter;
+  scheduler.spawn([&] { left = forkJoin(scheduler, depth - 1); }, &counter);
+  const uint64_t right = forkJoin(scheduler, depth - 1);
+  scheduler.wait(counter);
+  return left + right + 1;
+}
+}  // namespace
+
+// Usage: scheduler-benchmark [task counts...]
+//
+// Measures the per-task overhead of TaskScheduler with empty tasks, for
+// thread counts doubling up to the hardware thread count:
+//
+//   flat       the main thread spawns every task and waits; workers steal
+//   fork-join  a binary tree of tasks, each spawning its children
+//   chain      each task depends on the previous one through spawnAfter
+//
+// With one thread, flat is the cost of a deque push and pop plus the task
+// allocation; with more, it includes steals, which the stolen column
+// counts.
+int main(int argc, char** argv)
+{
+  constexpr std::array<uint32_t, 2> defaultCounts = {1 << 14, 1 << 18};
+
+  std::vector<uint32_t> workerCounts;
+  for (uint32_t threads = 1;; threads *= 2) {
+    workerCounts.push_back(
+        std::min(threads - 1, TaskScheduler::defaultWorkerCount()));
+    if (workerCounts.back() == TaskScheduler::defaultWorkerCount()) {
+      break;
+    }
+  }
+
+  fmt::println("{:>10} {:>8} {:>10} {:>10} {:>10}",
+               "tasks",
+               "threads",
+               "test",
+               "ns/task",
+               "stolen");
+
+  for (const auto count : parseSizes(argc, argv, defaultCounts)) {
+    for (const auto workerCount : workerCounts) {
+      TaskScheduler scheduler(workerCount);
+
+      const auto report = [&](const char* test,
+                              uint64_t tasks,
+                              const std::function<void()>& run)
+      {
+        scheduler.resetStats();
+        const auto measurement = measure(run, 0.5, 10);
+        const auto stats = scheduler.getStats();
+        fmt::println("{:>10} {:>8} {:>10} {:>10.1f} {:>9.1f}%",
+                     tasks,
+                     scheduler.threadCount(),
+                     test,
+                     measurement.secondsPerIteration() * 1.0e9
+                         / static_cast<double>(tasks),
+                     100.0 * static_cast<double>(stats.stolen)
+                         / static_cast<double>(std::max<uint64_t>(
+                             stats.executed, 1)));
+      };
+
+      report("flat",
+             count,
+             [&]
+             {
+               TaskCounter counter;
+               for (uint32_t i = 0; i < count; i++) {
+                 scheduler.spawn([] {}, &counter);
+               }
+               scheduler.wait(counter);
+             });
+
+      uint32_t depth = 0;
+      while ((2ULL << depth) - 1 < count) {
+        depth++;
+      }
+      report("fork-join",
+             (1ULL << depth) - 1,
+             [&] { forkJoin(scheduler, depth); });
+
+      // Dependent tasks run one at a time, so keep the chain short
+      const uint32_t chainLength = std::min<uint32_t>(count, 1 << 12);
+      report("chain",
+             chainLength,
+             [&]
+             {
+               std::vector<TaskCounter> links(chainLength);
+               scheduler.spawn([] {}, links.data());
+               for (uint32_t i = 1; i < chainLength; i++) {
+                 scheduler.spawnAfter(links[i - 1], [] {}, &links[i]);
+               }
+               scheduler.wait(links.back());
+             });
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <fmt/base.h>
+#include <glm/glm.hpp>
+
+#include "benchmark.hpp"
+#include "buffers/deviceBuffer.hpp"
+#include "buffers/hostBuffer.hpp"
+#include "computeBatch.hpp"
+#include "headlessContext.hpp"
+#include "simulation/spatialGrid.hpp"
+
+namespace
+{
+auto download(HeadlessContext& context, Buffer& buffer, uint32_t count)
+    -> std::vector<glm::vec4>
+{
+  const vk::DeviceSize size = count * sizeof(glm::vec4);
+  HostBuffer readback(context.device->handle,
+                      context.allocator,
+                      size,
+                      nullptr,
+                      vk::BufferUsageFlagBits::eTransferDst,
+                      VMA_MEMORY_USAGE_AUTO,
+                      VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT
+                          | VMA_ALLOCATION_CREATE_MAPPED_BIT);
+
+  ComputeBatch batch;
+  batch.copy(buffer, readback, size);
+  context.compute->submit(batch);
+
+  std::vector<glm::vec4> values(count);
+  vmaCopyAllocationToMemory(
+      context.allocator, readback.allocation, 0, values.data(), size);
+  return values;
+}
+
+// SpatialGrid::collide for particle i, against every other particle
+auto collideReference(const std::vector<glm::vec4>& positions,
+                      const std::vector<glm::vec4>& velocities,
+                      uint32_t i,
+                      const CollisionSettings& collision) -> glm::vec3
+{
+  const glm::vec3 position(positions[i]);
+  const glm::vec3 velocity(velocities[i]);
+  const float contact = 2.0F * collision.particleRadius;
+
+  glm::vec3 force(0.0F);
+  for (std::size_t j = 0; j < positions.size(); j++) {
+    const glm::vec3 d = position - glm::vec3(positions[j]);
+    const float distanceSq = glm::dot(d, d);
+    if (j == i || distanceSq >= contact * contact || distanceSq == 0.0F) {
+      continue;
+    }
+
+    const float distance = std::sqrt(distanceSq);
+    const glm::vec3 normal = d / distance;
+    const float approach =
+        glm::dot(glm::vec3(velocities[j]) - velocity, normal);
+    force += normal
+        * ((collision.stiffness * (contact - distance))
+           + (collision.damping * approach));
+  }
+  return velocity + (force * collision.timeStep);
+}
+}  // namespace
+
+// Usage: spatial-grid-benchmark [particle counts...]
+//
+// Particles are scattered at a fixed density of about one per cell, so with
+// a linear-time neighbor search the time per particle stays flat as the
+// count grows. The collisions of a sample of particles are checked against
+// a brute-force search over all pairs.
+int main(int argc, char** argv)
+{
+  constexpr std::array<uint32_t, 4> defaultCounts = {
+      1 << 14, 1 << 16, 1 << 18, 1 << 20};
+  const SpatialGridSettings gridSettings {.cellSize = 0.02F, .tableBits = 20};
+  const CollisionSettings collision {.particleRadius = 0.01F};
+
+  HeadlessContext context("spatial-grid-benchmark");
+  fmt::println("Device: {}", context.deviceName());
+  fmt::println("{:>10} {:>12} {:>12} {:>14} {:>8}",
+               "particles",
+               "build ms",
+               "collide ms",
+               "ns/particle",
+               "valid");
+
+  SpatialGrid grid(
+      *context.device, context.allocator, *context.compute, gridSettings);
+
+  std::mt19937 random(1);
+  for (const auto count : parseSizes(argc, argv, defaultCounts)) {
+    const auto side =
+        gridSettings.cellSize * std::cbrt(static_cast<float>(count));
+    std::uniform_real_distribution<float> coordinate(0.0F, side);
+    std::uniform_real_distribution<float> speed(-0.1F, 0.1F);
+
+    std::vector<glm::vec4> positions(count);
+    std::vector<glm::vec4> velocities(count);
+    for (uint32_t i = 0; i < count; i++) {
+      positions[i] = {
+          coordinate(random), coordinate(random), coordinate(random), 0.0F};
+      velocities[i] = {speed(random), speed(random), speed(random), 0.0F};
+    }
+
+    const vk::DeviceSize size = count * sizeof(glm::vec4);
+    const auto storage = vk::BufferUsageFlagBits::eStorageBuffer;
+    HostBuffer positionStaging(context.device->handle,
+                               context.allocator,
+                               size,
+                               positions.data(),
+                               vk::BufferUsageFlagBits::eTransferSrc);
+    HostBuffer velocityStaging(context.device->handle,
+                               context.allocator,
+                               size,
+                               velocities.data(),
+                               vk::BufferUsageFlagBits::eTransferSrc);
+    DeviceBuffer positionBuffer(
+        context.device->handle, context.allocator, size, storage);
+    DeviceBuffer velocityBuffer(
+        context.device->handle, context.allocator, size, storage);
+    DeviceBuffer velocityOut(
+        context.device->handle, context.allocator, size, storage);
+
+    ComputeBatch upload;
+    upload.copy(positionStaging, positionBuffer, size)
+        .copy(velocityStaging, velocityBuffer, size);
+    context.compute->submit(upload);
+
+    ComputeBatch buildBatch;
+    grid.build(buildBatch, positionBuffer, velocityBuffer, count);
+    const auto buildSeconds =
+        measure([&] { context.compute->submit(buildBatch); })
+            .secondsPerIteration();
+
+    // The grid from the last build stays valid for the collision pass
+    ComputeBatch collideBatch;
+    grid.collide(collideBatch, velocityOut, collision);
+    const auto collideSeconds =
+        measure([&] { context.compute->submit(collideBatch); })
+            .secondsPerIteration();
+
+    // Forces are summed in a different order than on the GPU
+    constexpr uint32_t samples = 256;
+    const auto collided = download(context, velocityOut, count);
+    std::uniform_int_distribution<uint32_t> particle(0, count - 1);
+    bool valid = true;
+    for (uint32_t sample = 0; sample < std::min(samples, count); sample++) {
+      const auto i = particle(random);
+      const auto expected =
+          collideReference(positions, velocities, i, collision);
+      const auto error = glm::length(glm::vec3(collided[i]) - expected);
+      valid = valid && error <= 1.0e-4F * (1.0F + glm::length(expected));
+    }
+
+    fmt::println("{:>10} {:>12.3f} {:>12.3f} {:>14.2f} {:>8}",
+                 count,
+                 buildSeconds * 1.0e3,
+                 collideSeconds * 1.0e3,
+                 (buildSeconds + collideSeconds) * 1.0e9 / count,
+                 valid ? "yes" : "NO");
+  }
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include <fmt/base.h>
+
+#include "benchmark.hpp"
+#include "buffers/deviceBuffer.hpp"
+#include "buffers/hostBuffer.hpp"
+#include "computeBatch.hpp"
+#include "headlessContext.hpp"
+#include "mappedFile.hpp"
+#include "streamingUploader.hpp"
+
+namespace
+{
+auto download(HeadlessContext& context, Buffer& buffer, vk::DeviceSize size)
+    -> std::vector<std::byte>
+{
+  HostBuffer readback(context.device->handle,
+                      context.allocator,
+                      size,
+                      nullptr,
+                      vk::BufferUsageFlagBits::eTransferDst,
+                      VMA_MEMORY_USAGE_AUTO,
+                      VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT
+                          | VMA_ALLOCATION_CREATE_MAPPED_BIT);
+
+  ComputeBatch batch;
+  batch.copy(buffer, readback, size);
+  context.compute->submit(batch);
+
+  std::vector<std::byte> bytes(size);
+  vmaCopyAllocationToMemory(
+      context.allocator, readback.allocation, 0, bytes.data(), size);
+  return bytes;
+}
+}  // namespace
+
+// Usage: upload-benchmark [file sizes in MB...]
+//
+// Writes a file of random bytes per size next to the working directory,
+// streams it into a device buffer through StreamingUploader and checks the
+// buffer against the file. The file was just written, so it is read from
+// the page cache; drop the cache (or pass sizes beyond RAM) to include the
+// disk.
+int main(int argc, char** argv)
+{
+  constexpr std::array<uint32_t, 3> defaultSizes = {16, 64, 256};
+  const std::filesystem::path path = "upload-benchmark.bin";
+
+  HeadlessContext context("upload-benchmark");
+  StreamingUploader uploader(context.device->handle,
+                             context.allocator,
+                             context.device->queueFamilyIndices.computeFamily
+                                 .value());
+  fmt::println("Device: {}", context.deviceName());
+  fmt::println("{:>8} {:>10} {:>10} {:>10} {:>10} {:>8}",
+               "MB",
+               "MB/s",
+               "read s",
+               "copy s",
+               "wait s",
+               "valid");
+
+  std::mt19937 random(1);
+  for (const auto megabytes : parseSizes(argc, argv, defaultSizes)) {
+    const auto size = std::size_t {megabytes} * 1024 * 1024;
+    {
+      std::vector<uint32_t> words(size / sizeof(uint32_t));
+      std::ranges::generate(words, random);
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char*>(words.data()),  // NOLINT
+                 static_cast<std::streamsize>(size));
+    }
+
+    const MappedFile file(path.string());
+    DeviceBuffer buffer(context.device->handle,
+                        context.allocator,
+                        size,
+                        vk::BufferUsageFlagBits::eStorageBuffer);
+    const auto stats = uploader.upload(file, buffer);
+
+    const auto uploaded = download(context, buffer, size);
+    const bool valid = std::ranges::equal(uploaded, file.bytes());
+
+    fmt::println("{:>8} {:>10.1f} {:>10.3f} {:>10.3f} {:>10.3f} {:>8}",
+                 megabytes,
+                 stats.megabytesPerSecond(),
+                 stats.readSeconds,
+                 stats.copySeconds,
+                 stats.waitSeconds,
+                 valid ? "yes" : "NO");
+  }
+
+  std::filesystem::remove(path);
+  return 0;
+}
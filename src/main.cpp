@@ -1,12 +1,16 @@
+#include "eventPump.hpp"
 #include "renderer.hpp"
+#include "taskScheduler.hpp"
 #include "window.hpp"
 
 int main()
 {
+  TaskScheduler scheduler;
   Window window("My Window", 1280, 720);
-  Game game;
-  Renderer renderer("My World", &window, game);
-  renderer.run();
+  Game game(scheduler);
+  EventPump events(game.input());
+  Renderer renderer("My World", &window, game, scheduler);
+  renderer.run(events);
 
   return 0;
 }
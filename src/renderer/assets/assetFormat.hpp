@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// On-disk layout of an asset pack, shared by the baker and AssetPack.
+//
+// A pack is an AssetHeader, the blobs, each aligned to assetAlignment, and a
+// table of contents of AssetEntry at the end. Everything is stored in the
+// host's byte order and layout, so a mapped pack is used in place; a pack
+// from a different version is rejected rather than converted.
+constexpr std::array<char, 4> assetMagic = {'N', 'R', 'A', 'P'};
+constexpr uint32_t assetVersion = 5;
+constexpr std::size_t assetAlignment = 64;
+
+enum class AssetType : uint32_t
+{
+  // SceneMeshInfo, then LodChain::Level[counts[2]], then
+  // PackedVertex[counts[0]], then uint16_t indices[counts[1]], as in
+  // SceneMeshData
+  eSceneMesh,
+  // GpuMeshlet[counts[0]], then PackedVertex[counts[1]], then uint32_t
+  // meshlet vertices[counts[2]], then uint32_t triangles[counts[3]], as in
+  // ClusterMeshData
+  eClusterMesh,
+  // Mip levels of a counts[0] x counts[1] texture of vk::Format counts[2],
+  // largest first and tightly packed; counts[3] levels
+  eTexture,
+  // glm::vec4 positions[counts[0]] followed by velocities[counts[0]], as in
+  // GalaxyState
+  eGalaxy,
+  // SPIR-V words of one entry point, named <module>.<entry point>
+  eShader,
+};
+
+struct AssetHeader
+{
+  std::array<char, 4> magic;
+  uint32_t version;
+  uint64_t fileSize;
+  uint64_t tocOffset;
+  uint32_t entryCount;
+  uint32_t padding;
+};
+
+static_assert(sizeof(AssetHeader) == 32);
+
+struct AssetEntry
+{
+  static constexpr std::size_t maxNameLength = 27;
+
+  uint64_t offset;  // From the start of the file
+  uint64_t size;
+  AssetType type;
+  std::array<uint32_t, 4> counts;  // See AssetType
+  std::array<char, maxNameLength + 1> name;  // NUL-padded
+};
+
+static_assert(sizeof(AssetEntry) == 64);
+static_assert(std::is_trivially_copyable_v<AssetEntry>);
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+#include "assetPack.hpp"
+
+#include "../images/deviceImage.hpp"
+
+namespace
+{
+
+// Blobs are aligned by the baker and their sizes checked against their
+// counts when the pack is opened
+template <typename T>
+auto viewAs(std::span<const std::byte> bytes,
+            std::size_t offset,
+            std::size_t count) -> std::span<const T>
+{
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return {reinterpret_cast<const T*>(bytes.data() + offset), count};
+}
+
+// Bytes of a mip level of a texture entry
+auto levelSize(const AssetEntry& entry, uint32_t level) -> std::size_t
+{
+  const auto& counts = entry.counts;
+  return std::size_t {std::max(counts[0] >> level, 1U)}
+      * std::max(counts[1] >> level, 1U)
+      * DeviceImage::texelSize(static_cast<vk::Format>(counts[2]));
+}
+
+// Bytes a blob of the entry's type and counts occupies
+auto expectedSize(const AssetEntry& entry) -> uint64_t
+{
+  const auto& counts = entry.counts;
+  switch (entry.type) {
+    case AssetType::eSceneMesh:
+      return sizeof(SceneMeshInfo)
+          + (uint64_t {counts[2]} * sizeof(LodChain::Level))
+          + (uint64_t {counts[0]} * sizeof(PackedVertex))
+          + (uint64_t {counts[1]} * sizeof(uint16_t));
+    case AssetType::eClusterMesh:
+      return (uint64_t {counts[0]} * sizeof(GpuMeshlet))
+          + (uint64_t {counts[1]} * sizeof(PackedVertex))
+          + ((uint64_t {counts[2]} + counts[3]) * sizeof(uint32_t));
+    case AssetType::eTexture: {
+      uint64_t size = 0;
+      for (uint32_t level = 0; level < counts[3]; level++) {
+        size += levelSize(entry, level);
+      }
+      return size;
+    }
+    case AssetType::eGalaxy:
+      return uint64_t {counts[0]} * 2 * sizeof(glm::vec4);
+    case AssetType::eShader:
+      return entry.size - (entry.size % sizeof(uint32_t));
+  }
+  throw std::runtime_error("Unknown asset type.");
+}
+
+// Counts the accessors rely on beyond the blob size
+auto validCounts(const AssetEntry& entry) -> bool
+{
+  const auto& counts = entry.counts;
+  switch (entry.type) {
+    case AssetType::eSceneMesh:
+      return counts[2] > 0;
+    case AssetType::eTexture:
+      // Level 0, and no levels past 1x1
+      return counts[0] > 0 && counts[1] > 0 && counts[3] > 0
+          && counts[3] <= static_cast<uint32_t>(
+                 std::bit_width(std::max(counts[0], counts[1])));
+    case AssetType::eClusterMesh:
+    case AssetType::eGalaxy:
+    case AssetType::eShader:
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+AssetPack::AssetPack(const std::string& path)
+    : file(path)
+{
+  const auto fail = [&](const char* reason)
+  { throw std::runtime_error("Invalid asset pack " + path + ": " + reason); };
+
+  if (file.size() < sizeof(AssetHeader)) {
+    fail("too small");
+  }
+  AssetHeader header {};
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (header.magic != assetMagic) {
+    fail("not an asset pack");
+  }
+  if (header.version != assetVersion) {
+    fail("baked by a different version, rebake it");
+  }
+  if (header.fileSize != file.size() || header.tocOffset % assetAlignment != 0
+      || header.tocOffset > file.size()
+      || header.entryCount
+          > (file.size() - header.tocOffset) / sizeof(AssetEntry))
+  {
+    fail("truncated");
+  }
+
+  toc = viewAs<AssetEntry>(file.bytes(), header.tocOffset, header.entryCount);
+  for (const auto& entry : toc) {
+    if (entry.name.back() != '\0' || entry.offset % assetAlignment != 0
+        || entry.offset > file.size() || entry.size > file.size() - entry.offset
+        || !validCounts(entry) || expectedSize(entry) != entry.size)
+    {
+      fail("corrupt table of contents");
+    }
+  }
+}
+
+auto AssetPack::find(std::string_view name, AssetType type) const
+    -> const AssetEntry*
+{
+  const auto it = std::ranges::find_if(
+      toc,
+      [&](const AssetEntry& entry)
+      { return entry.type == type && name == entry.name.data(); });
+  return it != toc.end() ? &*it : nullptr;
+}
+
+auto AssetPack::get(std::string_view name, AssetType type) const
+    -> const AssetEntry&
+{
+  const AssetEntry* entry = find(name, type);
+  if (entry == nullptr) {
+    throw std::runtime_error("Asset not in pack: " + std::string(name));
+  }
+  return *entry;
+}
+
+auto AssetPack::blob(const AssetEntry& entry) const
+    -> std::span<const std::byte>
+{
+  return file.bytes().subspan(entry.offset, entry.size);
+}
+
+auto AssetPack::sceneMesh(std::string_view name) const -> SceneMeshView
+{
+  const auto& entry = get(name, AssetType::eSceneMesh);
+  const auto bytes = blob(entry);
+  SceneMeshView view {.info = {},
+                      .levels = {},
+                      .vertices = {},
+                      .indices = {}};
+  std::memcpy(&view.info, bytes.data(), sizeof(view.info));
+
+  std::size_t offset = sizeof(SceneMeshInfo);
+  view.levels = viewAs<LodChain::Level>(bytes, offset, entry.counts[2]);
+  offset += view.levels.size_bytes();
+  view.vertices = viewAs<PackedVertex>(bytes, offset, entry.counts[0]);
+  offset += view.vertices.size_bytes();
+  view.indices = viewAs<uint16_t>(bytes, offset, entry.counts[1]);
+  return view;
+}
+
+auto AssetPack::clusterMesh(std::string_view name) const -> ClusterMeshView
+{
+  const auto& entry = get(name, AssetType::eClusterMesh);
+  const auto bytes = blob(entry);
+  ClusterMeshView view {.meshlets = {},
+                        .vertices = {},
+                        .meshletVertices = {},
+                        .triangles = {}};
+
+  std::size_t offset = 0;
+  view.meshlets = viewAs<GpuMeshlet>(bytes, offset, entry.counts[0]);
+  offset += view.meshlets.size_bytes();
+  view.vertices = viewAs<PackedVertex>(bytes, offset, entry.counts[1]);
+  offset += view.vertices.size_bytes();
+  view.meshletVertices = viewAs<uint32_t>(bytes, offset, entry.counts[2]);
+  offset += view.meshletVertices.size_bytes();
+  view.triangles = viewAs<uint32_t>(bytes, offset, entry.counts[3]);
+  return view;
+}
+
+auto AssetPack::texture(std::string_view name) const -> TextureView
+{
+  const auto& entry = get(name, AssetType::eTexture);
+  TextureView view {
+      .extent = {.width = entry.counts[0], .height = entry.counts[1]},
+      .format = static_cast<vk::Format>(entry.counts[2]),
+      .levels = {}};
+
+  const auto bytes = blob(entry);
+  std::size_t offset = 0;
+  for (uint32_t level = 0; level < entry.counts[3]; level++) {
+    view.levels.push_back(bytes.subspan(offset, levelSize(entry, level)));
+    offset += view.levels.back().size();
+  }
+  return view;
+}
+
+auto AssetPack::galaxy(std::string_view name) const -> GalaxyView
+{
+  const auto& entry = get(name, AssetType::eGalaxy);
+  const auto bytes = blob(entry);
+  const auto count = entry.counts[0];
+  return {.positions = viewAs<glm::vec4>(bytes, 0, count),
+          .velocities =
+              viewAs<glm::vec4>(bytes, count * sizeof(glm::vec4), count)};
+}
+
+auto AssetPack::shader(std::string_view name) const
+    -> std::span<const uint32_t>
+{
+  const auto& entry = get(name, AssetType::eShader);
+  return viewAs<uint32_t>(blob(entry), 0, entry.size / sizeof(uint32_t));
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "../mappedFile.hpp"
+#include "../scene/clusterScene.hpp"
+#include "../scene/gpuScene.hpp"
+#include "../simulation/nbody.hpp"
+#include "assetFormat.hpp"
+
+// A texture's mip levels in a mapped pack, as MemoryTextureSource takes them
+struct TextureView
+{
+  vk::Extent2D extent;
+  vk::Format format;
+  std::vector<std::span<const std::byte>> levels;  // Largest first
+};
+
+// An asset pack written by asset-baker, mapped read-only.
+//
+// Opening a pack only checks the header and the bounds of every entry in
+// the table of contents; blobs are never parsed or copied. The accessors
+// return views straight into the mapping, which stay valid as long as the
+// pack and can be handed to the upload paths as they are, so loading costs
+// what the page faults cost.
+class AssetPack
+{
+public:
+  explicit AssetPack(const std::string& path);
+
+  [[nodiscard]] auto entries() const -> std::span<const AssetEntry>
+  {
+    return toc;
+  }
+
+  // The entry named name of the given type, or nullptr
+  [[nodiscard]] auto find(std::string_view name, AssetType type) const
+      -> const AssetEntry*;
+
+  // These throw if the pack has no such asset
+  [[nodiscard]] auto sceneMesh(std::string_view name) const -> SceneMeshView;
+  [[nodiscard]] auto clusterMesh(std::string_view name) const
+      -> ClusterMeshView;
+  [[nodiscard]] auto texture(std::string_view name) const -> TextureView;
+  [[nodiscard]] auto galaxy(std::string_view name) const -> GalaxyView;
+  [[nodiscard]] auto shader(std::string_view name) const
+      -> std::span<const uint32_t>;
+
+  [[nodiscard]] auto size() const -> size_t { return file.size(); }
+
+private:
+  MappedFile file;
+  std::span<const AssetEntry> toc;
+
+  [[nodiscard]] auto get(std::string_view name, AssetType type) const
+      -> const AssetEntry&;
+  [[nodiscard]] auto blob(const AssetEntry& entry) const
+      -> std::span<const std::byte>;
+};
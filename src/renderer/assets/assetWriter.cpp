@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#include "assetWriter.hpp"
+
+namespace
+{
+
+auto alignUp(uint64_t offset) -> uint64_t
+{
+  return (offset + assetAlignment - 1) / assetAlignment * assetAlignment;
+}
+
+}  // namespace
+
+void AssetWriter::addSceneMesh(std::string_view name,
+                               const SceneMeshData& mesh)
+{
+  add(name,
+      AssetType::eSceneMesh,
+      {static_cast<uint32_t>(mesh.vertices.size()),
+       static_cast<uint32_t>(mesh.indices.size()),
+       static_cast<uint32_t>(mesh.levels.size()),
+       0},
+      {std::as_bytes(std::span(&mesh.info, 1)),
+       std::as_bytes(std::span(mesh.levels)),
+       std::as_bytes(std::span(mesh.vertices)),
+       std::as_bytes(std::span(mesh.indices))});
+}
+
+void AssetWriter::addClusterMesh(std::string_view name,
+                                 const ClusterMeshData& mesh)
+{
+  add(name,
+      AssetType::eClusterMesh,
+      {static_cast<uint32_t>(mesh.meshlets.size()),
+       static_cast<uint32_t>(mesh.vertices.size()),
+       static_cast<uint32_t>(mesh.meshletVertices.size()),
+       static_cast<uint32_t>(mesh.triangles.size())},
+      {std::as_bytes(std::span(mesh.meshlets)),
+       std::as_bytes(std::span(mesh.vertices)),
+       std::as_bytes(std::span(mesh.meshletVertices)),
+       std::as_bytes(std::span(mesh.triangles))});
+}
+
+void AssetWriter::addTexture(
+    std::string_view name,
+    vk::Extent2D extent,
+    vk::Format format,
+    const std::vector<std::span<const std::byte>>& levels)
+{
+  add(name,
+      AssetType::eTexture,
+      {extent.width,
+       extent.height,
+       static_cast<uint32_t>(format),
+       static_cast<uint32_t>(levels.size())},
+      levels);
+}
+
+void AssetWriter::addGalaxy(std::string_view name, const GalaxyState& galaxy)
+{
+  if (galaxy.velocities.size() != galaxy.positions.size()) {
+    throw std::runtime_error("Galaxy velocities do not match its positions: "
+                             + std::string(name));
+  }
+  add(name,
+      AssetType::eGalaxy,
+      {static_cast<uint32_t>(galaxy.positions.size()), 0, 0, 0},
+      {std::as_bytes(std::span(galaxy.positions)),
+       std::as_bytes(std::span(galaxy.velocities))});
+}
+
+void AssetWriter::addShader(std::string_view name,
+                            std::span<const std::byte> spirv)
+{
+  if (spirv.empty() || spirv.size() % sizeof(uint32_t) != 0) {
+    throw std::runtime_error("SPIR-V is not a whole number of words: "
+                             + std::string(name));
+  }
+  add(name, AssetType::eShader, {}, {spirv});
+}
+
+void AssetWriter::add(std::string_view name,
+                      AssetType type,
+                      std::array<uint32_t, 4> counts,
+                      const std::vector<std::span<const std::byte>>& parts)
+{
+  if (name.empty() || name.size() > AssetEntry::maxNameLength) {
+    throw std::runtime_error("Invalid asset name: " + std::string(name));
+  }
+  for (const auto& asset : assets) {
+    if (asset.entry.type == type && name == asset.entry.name.data()) {
+      throw std::runtime_error("Duplicate asset: " + std::string(name));
+    }
+  }
+
+  Asset asset {.entry = {.offset = 0,
+                         .size = 0,
+                         .type = type,
+                         .counts = counts,
+                         .name = {}},
+               .data = {}};
+  std::ranges::copy(name, asset.entry.name.begin());
+  for (const auto& part : parts) {
+    asset.data.insert(asset.data.end(), part.begin(), part.end());
+  }
+  asset.entry.size = asset.data.size();
+  assets.push_back(std::move(asset));
+}
+
+auto AssetWriter::write(const std::string& path) const -> uint64_t
+{
+  std::vector<AssetEntry> toc;
+  uint64_t offset = alignUp(sizeof(AssetHeader));
+  for (const auto& asset : assets) {
+    toc.push_back(asset.entry);
+    toc.back().offset = offset;
+    offset = alignUp(offset + asset.data.size());
+  }
+
+  const AssetHeader header {
+      .magic = assetMagic,
+      .version = assetVersion,
+      .fileSize = offset + (toc.size() * sizeof(AssetEntry)),
+      .tocOffset = offset,
+      .entryCount = static_cast<uint32_t>(toc.size()),
+      .padding = 0};
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    throw std::runtime_error("failed to open file: " + path);
+  }
+  const auto writeAt = [&](uint64_t at, std::span<const std::byte> bytes)
+  {
+    static constexpr std::array<char, assetAlignment> zeros {};
+    const auto padding = at - static_cast<uint64_t>(file.tellp());
+    file.write(zeros.data(), static_cast<std::streamsize>(padding));
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    file.write(reinterpret_cast<const char*>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+  };
+  writeAt(0, std::as_bytes(std::span(&header, 1)));
+  for (std::size_t i = 0; i < assets.size(); i++) {
+    writeAt(toc[i].offset, assets[i].data);
+  }
+  writeAt(header.tocOffset, std::as_bytes(std::span(toc)));
+
+  if (!file) {
+    throw std::runtime_error("failed to write file: " + path);
+  }
+  return header.fileSize;
+}
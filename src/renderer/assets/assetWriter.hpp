@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "../scene/clusterScene.hpp"
+#include "../scene/gpuScene.hpp"
+#include "../simulation/nbody.hpp"
+#include "assetFormat.hpp"
+
+// Collects assets in memory and writes them out as a pack for AssetPack.
+// Names are unique per type and at most AssetEntry::maxNameLength long.
+class AssetWriter
+{
+public:
+  void addSceneMesh(std::string_view name, const SceneMeshData& mesh);
+  void addClusterMesh(std::string_view name, const ClusterMeshData& mesh);
+  // levels are largest first, each tightly packed
+  void addTexture(std::string_view name,
+                  vk::Extent2D extent,
+                  vk::Format format,
+                  const std::vector<std::span<const std::byte>>& levels);
+  void addGalaxy(std::string_view name, const GalaxyState& galaxy);
+  void addShader(std::string_view name, std::span<const std::byte> spirv);
+
+  [[nodiscard]] auto size() const -> std::size_t { return assets.size(); }
+
+  // Returns the size of the pack in bytes
+  auto write(const std::string& path) const -> uint64_t;
+
+private:
+  struct Asset
+  {
+    AssetEntry entry;
+    std::vector<std::byte> data;
+  };
+
+  std::vector<Asset> assets;
+
+  void add(std::string_view name,
+           AssetType type,
+           std::array<uint32_t, 4> counts,
+           const std::vector<std::span<const std::byte>>& parts);
+};
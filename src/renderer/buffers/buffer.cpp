@@ -18,3 +18,69 @@ auto Buffer::getHandle() -> vk::Buffer
 {
   return {handle};
 };
+
+void Buffer::bindDescriptor(vk::DescriptorSet set,
+                            uint32_t binding,
+                            vk::DescriptorType type,
+                            uint32_t arrayElement)
+{
+  const DescriptorReference reference {.set = set,
+                                       .binding = binding,
+                                       .arrayElement = arrayElement,
+                                       .type = type};
+  writeDescriptor(reference);
+
+  std::erase_if(descriptorReferences, [&](const DescriptorReference& x) {
+    return x.set == set && x.binding == binding
+        && x.arrayElement == arrayElement;
+  });
+  descriptorReferences.push_back(reference);
+}
+
+void Buffer::takeDescriptors(Buffer& previous)
+{
+  for (const auto& reference : previous.descriptorReferences) {
+    bindDescriptor(reference.set,
+                   reference.binding,
+                   reference.type,
+                   reference.arrayElement);
+  }
+  previous.descriptorReferences.clear();
+}
+
+void Buffer::relocate(vk::Buffer newHandle)
+{
+  device.destroyBuffer(handle);
+  handle = newHandle;
+
+  for (const auto& reference : descriptorReferences) {
+    writeDescriptor(reference);
+  }
+}
+
+void Buffer::finishRelocation()
+{
+  // The allocation handle is stable across a move but the memory behind it
+  // (and therefore any persistent mapping) is not.
+  vmaGetAllocationInfo(allocator, allocation, &allocInfo);
+}
+
+void Buffer::track()
+{
+  vmaSetAllocationUserData(allocator, allocation, this);
+}
+
+void Buffer::writeDescriptor(const DescriptorReference& reference) const
+{
+  vk::DescriptorBufferInfo bufferInfo(handle, 0, VK_WHOLE_SIZE);
+
+  vk::WriteDescriptorSet writeDescriptorSet {
+      .dstSet = reference.set,
+      .dstBinding = reference.binding,
+      .dstArrayElement = reference.arrayElement,
+      .descriptorCount = 1,
+      .descriptorType = reference.type,
+      .pBufferInfo = &bufferInfo};
+
+  device.updateDescriptorSets(writeDescriptorSet, nullptr);
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include <vulkan/vulkan.hpp>
 
 #include "vk_mem_alloc.h"
@@ -19,9 +22,54 @@ public:
   VmaAllocation allocation = VK_NULL_HANDLE;
   VmaAllocationInfo allocInfo = {};
 
+  vk::DeviceSize size = 0;
+  vk::BufferUsageFlags usage;
+
   auto getHandle() -> vk::Buffer;
 
+  // Writes this buffer into a descriptor set and remembers the binding, so
+  // the descriptor can be patched if the buffer is relocated.
+  void bindDescriptor(vk::DescriptorSet set,
+                      uint32_t binding,
+                      vk::DescriptorType type,
+                      uint32_t arrayElement = 0);
+
+  // Moves the descriptor bindings of a buffer this one replaces, rewriting
+  // them to point here.
+  void takeDescriptors(Buffer& previous);
+
+  // Destroys the VkBuffer and swaps in one bound to the memory this
+  // buffer's allocation is moving to, rewriting every descriptor that
+  // referenced the old one. Called before the defragmentation pass ends, as
+  // VMA frees the old memory when it does.
+  void relocate(vk::Buffer newHandle);
+
+  // Refreshes allocInfo once the pass has ended and the allocation refers to
+  // its new memory.
+  void finishRelocation();
+
 protected:
   vk::Device& device;
   VmaAllocator& allocator;
+
+  // Buffers are always created with transfer usage so the defragmenter can
+  // move them with GPU copies.
+  static constexpr vk::BufferUsageFlags relocatableUsage =
+      vk::BufferUsageFlagBits::eTransferSrc
+      | vk::BufferUsageFlagBits::eTransferDst;
+
+  void track();
+
+private:
+  struct DescriptorReference
+  {
+    vk::DescriptorSet set;
+    uint32_t binding;
+    uint32_t arrayElement;
+    vk::DescriptorType type;
+  };
+
+  std::vector<DescriptorReference> descriptorReferences;
+
+  void writeDescriptor(const DescriptorReference& reference) const;
 };
@@ -17,7 +17,7 @@ DeviceBuffer::DeviceBuffer(vk::Device& device,
   try {
     vk::BufferCreateInfo bufferCreateInfo {
         .size = size,
-        .usage = usageFlags,
+        .usage = usageFlags | relocatableUsage,
         .sharingMode = vk::SharingMode::eExclusive,
     };
 
@@ -34,6 +34,10 @@ DeviceBuffer::DeviceBuffer(vk::Device& device,
                     &allocation,
                     &allocInfo);
 
+    this->size = size;
+    usage = bufferCreateInfo.usage;
+    track();
+
     // device.bindBufferMemory(handle, allocInfo.deviceMemory, 0);
   } catch (vk::SystemError& err) {
     std::cout << "vk::SystemError: " << err.what() << std::endl;
@@ -10,14 +10,15 @@
 class DeviceBuffer : public virtual Buffer
 {
 public:
+  // Sub-allocated from shared blocks by default, so the Defragmenter can
+  // move it; VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT pins it in place
   DeviceBuffer(
       vk::Device& device,
       VmaAllocator& allocator,
       size_t size,
       vk::BufferUsageFlags usageFlags = vk::BufferUsageFlagBits::eStorageBuffer,
       VmaMemoryUsage memoryUsage = VMA_MEMORY_USAGE_AUTO,
-      VmaAllocationCreateFlags flags =
-          VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT);
+      VmaAllocationCreateFlags flags = 0);
 
   DeviceBuffer(const DeviceBuffer&) = delete;
   DeviceBuffer& operator=(const DeviceBuffer&) = delete;
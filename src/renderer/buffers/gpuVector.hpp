@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "../shaderLayout.hpp"
+#include "buffer.hpp"
+#include "deviceBuffer.hpp"
+#include "hostBuffer.hpp"
+#include "vk_mem_alloc.h"
+
+// A typed, growable device buffer with a host-side shadow copy.
+//
+// Element writes go to the shadow and mark the written range dirty. sync()
+// records the commands that bring the device buffer up to date: when the
+// size outgrew the device capacity the buffer is reallocated geometrically
+// and the old contents are copied on the GPU, then only the dirty element
+// ranges are uploaded through the staging buffer.
+//
+// Buffers replaced by growth are kept alive until the next sync(), which
+// must therefore only be called once the previously recorded commands have
+// completed.
+template <typename T>
+  requires ShaderCompatible<T>
+class GpuVector
+{
+public:
+  GpuVector(vk::Device& device,
+            VmaAllocator& allocator,
+            vk::BufferUsageFlags usageFlags,
+            size_t capacity = 0)
+      : device(device)
+      , allocator(allocator)
+      , usageFlags(usageFlags)
+  {
+    elements.reserve(capacity);
+  }
+
+  GpuVector(const GpuVector&) = delete;
+  GpuVector& operator=(const GpuVector&) = delete;
+  GpuVector(GpuVector&&) = delete;
+  GpuVector& operator=(GpuVector&&) = delete;
+
+  static constexpr vk::DeviceSize stride = ShaderLayout<T>::stride;
+
+  [[nodiscard]] auto size() const -> size_t { return elements.size(); }
+
+  [[nodiscard]] auto empty() const -> bool { return elements.empty(); }
+
+  [[nodiscard]] auto byteSize() const -> vk::DeviceSize
+  {
+    return elements.size() * stride;
+  }
+
+  [[nodiscard]] auto data() const -> const T* { return elements.data(); }
+
+  [[nodiscard]] auto operator[](size_t index) const -> const T&
+  {
+    return elements[index];
+  }
+
+  [[nodiscard]] auto begin() const { return elements.begin(); }
+
+  [[nodiscard]] auto end() const { return elements.end(); }
+
+  void push_back(const T& value)
+  {
+    elements.push_back(value);
+    markDirty(elements.size() - 1, elements.size());
+  }
+
+  // Appends all of values as one dirty range
+  void append(std::span<const T> values)
+  {
+    const auto previous = elements.size();
+    elements.insert(elements.end(), values.begin(), values.end());
+    markDirty(previous, elements.size());
+  }
+
+  void resize(size_t count, const T& value = T {})
+  {
+    const auto previous = elements.size();
+    elements.resize(count, value);
+    if (count > previous) {
+      markDirty(previous, count);
+    }
+  }
+
+  void assign(std::span<const T> values)
+  {
+    elements.assign(values.begin(), values.end());
+    dirtyRanges.clear();
+    markDirty(0, elements.size());
+  }
+
+  void set(size_t index, const T& value)
+  {
+    elements.at(index) = value;
+    markDirty(index, index + 1);
+  }
+
+  // Mutable access to a range of elements, which is uploaded on next sync.
+  auto modify(size_t first, size_t count) -> std::span<T>
+  {
+    markDirty(first, first + count);
+    return std::span<T>(elements).subspan(first, count);
+  }
+
+  void clear()
+  {
+    elements.clear();
+    dirtyRanges.clear();
+  }
+
+  // The device buffer. Only valid after the first sync().
+  auto buffer() -> DeviceBuffer& { return *deviceBuffer; }
+
+  [[nodiscard]] auto isDirty() const -> bool
+  {
+    return !dirtyRanges.empty() || elements.size() > deviceCapacity;
+  }
+
+  // Records growth and dirty range uploads into the command buffer, followed
+  // by a barrier making the writes visible to subsequent commands.
+  void sync(vk::CommandBuffer commandBuffer)
+  {
+    retired.clear();
+
+    if (!isDirty()) {
+      return;
+    }
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eAllCommands,
+        vk::PipelineStageFlagBits::eTransfer,
+        {},
+        vk::MemoryBarrier {.srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+                           .dstAccessMask =
+                               vk::AccessFlagBits::eTransferWrite},
+        nullptr,
+        nullptr);
+
+    if (elements.size() > deviceCapacity) {
+      grow(commandBuffer);
+    }
+
+    upload(commandBuffer);
+
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer,
+        vk::PipelineStageFlagBits::eAllCommands,
+        {},
+        vk::MemoryBarrier {.srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                           .dstAccessMask = vk::AccessFlagBits::eMemoryRead
+                               | vk::AccessFlagBits::eMemoryWrite},
+        nullptr,
+        nullptr);
+  }
+
+private:
+  static constexpr size_t minimumCapacity = 64;
+
+  vk::Device& device;
+  VmaAllocator& allocator;
+  vk::BufferUsageFlags usageFlags;
+
+  std::vector<T> elements;
+  std::unique_ptr<DeviceBuffer> deviceBuffer;
+  std::unique_ptr<HostBuffer> stagingBuffer;
+  size_t deviceCapacity = 0;
+  size_t deviceSize = 0;
+
+  // Half-open [first, last) element ranges, merged on sync
+  std::vector<std::pair<size_t, size_t>> dirtyRanges;
+  std::vector<std::unique_ptr<Buffer>> retired;
+
+  void markDirty(size_t first, size_t last)
+  {
+    if (first >= last) {
+      return;
+    }
+
+    // Sequential writes are by far the common case, so extend the last range
+    // in place instead of appending a new one.
+    if (!dirtyRanges.empty()) {
+      auto& [lastFirst, lastLast] = dirtyRanges.back();
+      if (first <= lastLast && last >= lastFirst) {
+        lastFirst = std::min(lastFirst, first);
+        lastLast = std::max(lastLast, last);
+        return;
+      }
+    }
+    dirtyRanges.emplace_back(first, last);
+  }
+
+  void mergeDirtyRanges()
+  {
+    std::ranges::sort(dirtyRanges);
+
+    std::vector<std::pair<size_t, size_t>> merged;
+    for (const auto& [first, last] : dirtyRanges) {
+      const auto clampedLast = std::min(last, elements.size());
+      if (first >= clampedLast) {
+        continue;
+      }
+      if (!merged.empty() && first <= merged.back().second) {
+        merged.back().second = std::max(merged.back().second, clampedLast);
+      } else {
+        merged.emplace_back(first, clampedLast);
+      }
+    }
+    dirtyRanges = std::move(merged);
+  }
+
+  void grow(vk::CommandBuffer commandBuffer)
+  {
+    const auto capacity = std::max(
+        {elements.size(), deviceCapacity * 2, minimumCapacity});
+
+    auto grown = std::make_unique<DeviceBuffer>(
+        device,
+        allocator,
+        capacity * stride,
+        usageFlags,
+        VMA_MEMORY_USAGE_AUTO,
+        VmaAllocationCreateFlags {0});
+
+    if (deviceBuffer) {
+      if (deviceSize > 0) {
+        commandBuffer.copyBuffer(deviceBuffer->getHandle(),
+                                 grown->getHandle(),
+                                 {{0, 0, deviceSize * stride}});
+
+        commandBuffer.pipelineBarrier(
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::PipelineStageFlagBits::eTransfer,
+            {},
+            vk::MemoryBarrier {
+                .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                .dstAccessMask = vk::AccessFlagBits::eTransferWrite},
+            nullptr,
+            nullptr);
+      }
+
+      grown->takeDescriptors(*deviceBuffer);
+      retired.push_back(std::move(deviceBuffer));
+    }
+
+    if (stagingBuffer) {
+      retired.push_back(std::move(stagingBuffer));
+    }
+    stagingBuffer = std::make_unique<HostBuffer>(device,
+                                                 allocator,
+                                                 capacity * stride,
+                                                 nullptr,
+                                                 vk::BufferUsageFlagBits {});
+
+    deviceBuffer = std::move(grown);
+    deviceCapacity = capacity;
+  }
+
+  void upload(vk::CommandBuffer commandBuffer)
+  {
+    mergeDirtyRanges();
+
+    std::vector<vk::BufferCopy> regions;
+    regions.reserve(dirtyRanges.size());
+
+    for (const auto& [first, last] : dirtyRanges) {
+      const auto offset = first * stride;
+      const auto bytes = (last - first) * stride;
+
+      vmaCopyMemoryToAllocation(allocator,
+                                elements.data() + first,
+                                stagingBuffer->allocation,
+                                offset,
+                                bytes);
+      regions.push_back(
+          {.srcOffset = offset, .dstOffset = offset, .size = bytes});
+    }
+
+    if (!regions.empty()) {
+      commandBuffer.copyBuffer(
+          stagingBuffer->getHandle(), deviceBuffer->getHandle(), regions);
+    }
+
+    dirtyRanges.clear();
+    deviceSize = elements.size();
+  }
+};
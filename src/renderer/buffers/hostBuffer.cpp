@@ -22,7 +22,7 @@ HostBuffer::HostBuffer(vk::Device& device,
   try {
     vk::BufferCreateInfo bufferCreateInfo {
         .size = size,
-        .usage = usageFlags,
+        .usage = usageFlags | relocatableUsage,
         .sharingMode = vk::SharingMode::eExclusive,
     };
 
@@ -43,7 +43,13 @@ HostBuffer::HostBuffer(vk::Device& device,
       throw std::runtime_error("Failed to create host buffer.");
     }
 
-    vmaCopyMemoryToAllocation(allocator, data, allocation, 0, size);
+    this->size = size;
+    usage = bufferCreateInfo.usage;
+    track();
+
+    if (data != nullptr) {
+      vmaCopyMemoryToAllocation(allocator, data, allocation, 0, size);
+    }
 
   } catch (vk::SystemError& err) {
     std::cout << "vk::SystemError: " << err.what() << std::endl;
@@ -1,8 +1,90 @@
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+
 #include "compute.hpp"
 
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
 #include "device.hpp"
 #include "executor.hpp"
 
+namespace
+{
+struct BufferUse
+{
+  VkBuffer buffer;
+  bool write;
+};
+
+// What a step touches, and at which stages
+struct StepAccess
+{
+  std::vector<BufferUse> buffers;
+  vk::PipelineStageFlags stages;
+  vk::AccessFlags writeAccess;
+};
+
+// Accesses recorded since the last barrier
+struct Hazards
+{
+  std::unordered_set<VkBuffer> reads;
+  std::unordered_set<VkBuffer> writes;
+  vk::PipelineStageFlags stages;
+  vk::AccessFlags writeAccess;
+
+  // Read after write, write after write and write after read all need a
+  // dependency; read after read doesn't
+  [[nodiscard]] auto conflictsWith(const StepAccess& step) const -> bool
+  {
+    return std::ranges::any_of(step.buffers, [this](const BufferUse& use) {
+      return writes.contains(use.buffer)
+          || (use.write && reads.contains(use.buffer));
+    });
+  }
+
+  void add(const StepAccess& step)
+  {
+    for (const auto& use : step.buffers) {
+      (use.write ? writes : reads).insert(use.buffer);
+    }
+    stages |= step.stages;
+    writeAccess |= step.writeAccess;
+  }
+
+  void clear()
+  {
+    reads.clear();
+    writes.clear();
+    stages = {};
+    writeAccess = {};
+  }
+};
+
+// Every stage and access a batch step can make. A barrier clears all
+// pending hazards, including ones whose eventual consumer is a different
+// kind of step than the one that triggered it, so it has to make the
+// writes visible to all of them.
+constexpr vk::PipelineStageFlags stepStages =
+    vk::PipelineStageFlagBits::eComputeShader
+    | vk::PipelineStageFlagBits::eDrawIndirect
+    | vk::PipelineStageFlagBits::eTransfer;
+constexpr vk::AccessFlags stepAccess = vk::AccessFlagBits::eShaderRead
+    | vk::AccessFlagBits::eShaderWrite
+    | vk::AccessFlagBits::eIndirectCommandRead
+    | vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite;
+
+auto isWrite(BufferAccess access) -> bool
+{
+  return access != BufferAccess::eRead;
+}
+}  // namespace
+
 Compute::Compute(
     vk::Device& device,
     uint32_t queueFamilyIndex,
@@ -11,6 +93,292 @@ Compute::Compute(
     : Executor(
           device, queueFamilyIndex, descriptorPool, descriptorSetLayoutBindings)
 {
+  fence = device.createFence({});
+  reserveDescriptors(transientSetCapacity, transientDescriptorCapacity);
+}
+
+Compute::~Compute()
+{
+  kernels.forEach([this](const Kernel& kernel) {
+    device.destroyPipeline(kernel.pipeline);
+    device.destroyPipelineLayout(kernel.pipelineLayout);
+    device.destroyDescriptorSetLayout(kernel.descriptorSetLayout);
+  });
+  kernels.clear();
+
+  device.destroyDescriptorPool(transientDescriptorPool);
+  device.destroyFence(fence);
+}
+
+auto Compute::createKernel(const vk::PipelineShaderStageCreateInfo& stage,
+                           std::vector<vk::DescriptorSetLayoutBinding> bindings,
+                           uint32_t pushConstantSize,
+                           const std::string& label) -> KernelHandle
+{
+  Kernel kernel {.bindings = std::move(bindings),
+                 .pushConstantSize = pushConstantSize};
+
+  kernel.descriptorSetLayout = device.createDescriptorSetLayout(
+      {.bindingCount = static_cast<uint32_t>(kernel.bindings.size()),
+       .pBindings = kernel.bindings.data()});
+
+  const vk::PushConstantRange pushConstantRange {
+      .stageFlags = vk::ShaderStageFlagBits::eCompute,
+      .offset = 0,
+      .size = pushConstantSize};
+
+  kernel.pipelineLayout = device.createPipelineLayout(
+      {.setLayoutCount = 1,
+       .pSetLayouts = &kernel.descriptorSetLayout,
+       .pushConstantRangeCount = pushConstantSize > 0 ? 1U : 0U,
+       .pPushConstantRanges = &pushConstantRange});
+
+  const vk::ComputePipelineCreateInfo pipelineCreateInfo {
+      .stage = stage, .layout = kernel.pipelineLayout};
+  const auto pipeline =
+      device.createComputePipeline(nullptr, pipelineCreateInfo);
+  if (pipeline.result != vk::Result::eSuccess) {
+    throw std::runtime_error("Failed to create compute pipeline.");
+  }
+  kernel.pipeline = pipeline.value;
+
+  const auto handle = kernels.emplace(std::move(kernel));
+  kernels.setLabel(handle, label);
+  return handle;
+}
+
+void Compute::destroyKernel(KernelHandle kernel)
+{
+  const auto& k = kernels.get(kernel);
+  device.destroyPipeline(k.pipeline);
+  device.destroyPipelineLayout(k.pipelineLayout);
+  device.destroyDescriptorSetLayout(k.descriptorSetLayout);
+  kernels.erase(kernel);
+}
+
+auto Compute::submit(const ComputeBatch& batch) -> SubmitStats
+{
+  SubmitStats stats;
+
+  uint32_t sets = 0;
+  uint32_t descriptors = 0;
+  for (const auto& step : batch.steps) {
+    if (const auto* dispatch = std::get_if<ComputeBatch::Dispatch>(&step)) {
+      sets++;
+      descriptors += static_cast<uint32_t>(dispatch->bindings.size());
+    }
+  }
+  reserveDescriptors(sets, descriptors);
+  device.resetDescriptorPool(transientDescriptorPool);
+
+  execute([&](vk::CommandBuffer) { record(batch, stats); });
+  releaseRetired();
+
+  return stats;
 }
 
-Compute::~Compute() = default;
+void Compute::execute(
+    const std::function<void(vk::CommandBuffer)>& recordCommands)
+{
+  commandBuffer.reset();
+  commandBuffer.begin(
+      {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+  recordCommands(commandBuffer);
+  commandBuffer.end();
+
+  device.resetFences(fence);
+  queue.submit(vk::SubmitInfo {.commandBufferCount = 1,
+                               .pCommandBuffers = &commandBuffer},
+               fence);
+
+  if (device.waitForFences(fence, vk::True, UINT64_MAX)
+      != vk::Result::eSuccess)
+  {
+    throw std::runtime_error("Failed to wait for fence.");
+  }
+}
+
+void Compute::retire(std::unique_ptr<DeviceBuffer> buffer)
+{
+  retired.push_back(std::move(buffer));
+}
+
+void Compute::releaseRetired()
+{
+  retired.clear();
+}
+
+void Compute::record(const ComputeBatch& batch, SubmitStats& stats)
+{
+  Hazards hazards;
+  bool wroteAnything = false;
+
+  auto barrier = [&](vk::PipelineStageFlags dstStages,
+                     vk::AccessFlags dstAccess) {
+    // A global memory barrier is as cheap as a buffer barrier on current
+    // hardware and covers every buffer at once
+    const vk::MemoryBarrier memoryBarrier {
+        .srcAccessMask = hazards.writeAccess, .dstAccessMask = dstAccess};
+    commandBuffer.pipelineBarrier(
+        hazards.stages, dstStages, {}, memoryBarrier, nullptr, nullptr);
+    hazards.clear();
+    stats.barriers++;
+  };
+
+  for (const auto& step : batch.steps) {
+    StepAccess access;
+
+    if (const auto* dispatch = std::get_if<ComputeBatch::Dispatch>(&step)) {
+      access.stages = vk::PipelineStageFlagBits::eComputeShader;
+      for (const auto& binding : dispatch->bindings) {
+        access.buffers.push_back({.buffer = binding.buffer->handle,
+                                  .write = isWrite(binding.access)});
+        if (isWrite(binding.access)) {
+          access.writeAccess |= vk::AccessFlagBits::eShaderWrite;
+        }
+      }
+      if (dispatch->arguments != nullptr) {
+        access.buffers.push_back(
+            {.buffer = dispatch->arguments->handle, .write = false});
+        access.stages |= vk::PipelineStageFlagBits::eDrawIndirect;
+      }
+    } else if (const auto* copy = std::get_if<ComputeBatch::Copy>(&step)) {
+      access.stages = vk::PipelineStageFlagBits::eTransfer;
+      access.buffers = {{.buffer = copy->src->handle, .write = false},
+                        {.buffer = copy->dst->handle, .write = true}};
+      access.writeAccess = vk::AccessFlagBits::eTransferWrite;
+    } else if (const auto* fill = std::get_if<ComputeBatch::Fill>(&step)) {
+      access.stages = vk::PipelineStageFlagBits::eTransfer;
+      access.buffers = {{.buffer = fill->dst->handle, .write = true}};
+      access.writeAccess = vk::AccessFlagBits::eTransferWrite;
+    }
+
+    if (hazards.conflictsWith(access)) {
+      barrier(stepStages, stepAccess);
+    }
+    hazards.add(access);
+    wroteAnything |= static_cast<bool>(access.writeAccess);
+
+    if (const auto* dispatch = std::get_if<ComputeBatch::Dispatch>(&step)) {
+      const auto& kernel = kernels.get(dispatch->kernel);
+
+      if (dispatch->pushConstants.size() != kernel.pushConstantSize) {
+        throw std::runtime_error("Push constant size does not match kernel.");
+      }
+
+      commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute,
+                                 kernel.pipeline);
+      commandBuffer.bindDescriptorSets(
+          vk::PipelineBindPoint::eCompute,
+          kernel.pipelineLayout,
+          0,
+          writeDescriptorSet(kernel, dispatch->bindings),
+          {});
+      if (kernel.pushConstantSize > 0) {
+        commandBuffer.pushConstants(kernel.pipelineLayout,
+                                    vk::ShaderStageFlagBits::eCompute,
+                                    0,
+                                    kernel.pushConstantSize,
+                                    dispatch->pushConstants.data());
+      }
+
+      if (dispatch->arguments != nullptr) {
+        commandBuffer.dispatchIndirect(dispatch->arguments->handle,
+                                       dispatch->argumentsOffset);
+      } else {
+        commandBuffer.dispatch(
+            dispatch->groups.x, dispatch->groups.y, dispatch->groups.z);
+      }
+      stats.dispatches++;
+    } else if (const auto* copy = std::get_if<ComputeBatch::Copy>(&step)) {
+      commandBuffer.copyBuffer(
+          copy->src->handle, copy->dst->handle, copy->region);
+      stats.transfers++;
+    } else if (const auto* fill = std::get_if<ComputeBatch::Fill>(&step)) {
+      commandBuffer.fillBuffer(
+          fill->dst->handle, fill->offset, fill->size, fill->value);
+      stats.transfers++;
+    }
+  }
+
+  // Make results readable from mapped host buffers once the fence signals
+  if (wroteAnything) {
+    hazards.writeAccess = vk::AccessFlagBits::eShaderWrite
+        | vk::AccessFlagBits::eTransferWrite;
+    hazards.stages = vk::PipelineStageFlagBits::eComputeShader
+        | vk::PipelineStageFlagBits::eTransfer;
+    barrier(vk::PipelineStageFlagBits::eHost, vk::AccessFlagBits::eHostRead);
+  }
+}
+
+void Compute::reserveDescriptors(uint32_t sets, uint32_t descriptors)
+{
+  if (transientDescriptorPool && sets <= transientSetCapacity
+      && descriptors <= transientDescriptorCapacity)
+  {
+    return;
+  }
+
+  while (sets > transientSetCapacity) {
+    transientSetCapacity *= 2;
+  }
+  while (descriptors > transientDescriptorCapacity) {
+    transientDescriptorCapacity *= 2;
+  }
+
+  // Only called between submissions, after the fence has been waited on
+  if (transientDescriptorPool) {
+    device.destroyDescriptorPool(transientDescriptorPool);
+  }
+
+  const std::array<vk::DescriptorPoolSize, 2> poolSizes = {
+      {{.type = vk::DescriptorType::eStorageBuffer,
+        .descriptorCount = transientDescriptorCapacity},
+       {.type = vk::DescriptorType::eUniformBuffer,
+        .descriptorCount = transientDescriptorCapacity}}};
+
+  transientDescriptorPool = device.createDescriptorPool(
+      {.maxSets = transientSetCapacity,
+       .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+       .pPoolSizes = poolSizes.data()});
+}
+
+auto Compute::writeDescriptorSet(const Kernel& kernel,
+                                 const std::vector<KernelBinding>& bindings)
+    -> vk::DescriptorSet
+{
+  const auto set = device
+                       .allocateDescriptorSets(
+                           {.descriptorPool = transientDescriptorPool,
+                            .descriptorSetCount = 1,
+                            .pSetLayouts = &kernel.descriptorSetLayout})
+                       .front();
+
+  std::vector<vk::DescriptorBufferInfo> bufferInfos;
+  std::vector<vk::WriteDescriptorSet> writes;
+  bufferInfos.reserve(bindings.size());
+  writes.reserve(bindings.size());
+
+  for (const auto& binding : bindings) {
+    const auto layoutBinding = std::ranges::find(
+        kernel.bindings,
+        binding.binding,
+        &vk::DescriptorSetLayoutBinding::binding);
+    if (layoutBinding == kernel.bindings.end()) {
+      throw std::runtime_error("Kernel has no such binding.");
+    }
+
+    bufferInfos.push_back({.buffer = binding.buffer->handle,
+                           .offset = binding.offset,
+                           .range = binding.range});
+    writes.push_back({.dstSet = set,
+                      .dstBinding = binding.binding,
+                      .dstArrayElement = 0,
+                      .descriptorCount = 1,
+                      .descriptorType = layoutBinding->descriptorType,
+                      .pBufferInfo = &bufferInfos.back()});
+  }
+
+  device.updateDescriptorSets(writes, nullptr);
+  return set;
+}
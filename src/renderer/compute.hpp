@@ -1,15 +1,29 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_handles.hpp>
 
+#include "buffers/deviceBuffer.hpp"
+#include "computeBatch.hpp"
 #include "executor.hpp"
+#include "slotMap.hpp"
 
 class Compute : public Executor
 {
 public:
+  struct SubmitStats
+  {
+    uint32_t dispatches = 0;
+    uint32_t transfers = 0;
+    uint32_t barriers = 0;
+  };
+
   Compute(
       vk::Device& device,
       uint32_t queueFamilyIndex,
@@ -21,5 +35,46 @@ public:
   Compute& operator=(const Compute&) = delete;  // Disable copy assignment
   Compute(Compute&&) = delete;  // Disable move constructor
   Compute& operator=(Compute&&) = delete;  // Disable move assignment
+
+  // Creates a compute pipeline whose descriptor set 0 holds the given
+  // bindings. Push constants, if any, start at offset 0.
+  auto createKernel(const vk::PipelineShaderStageCreateInfo& stage,
+                    std::vector<vk::DescriptorSetLayoutBinding> bindings,
+                    uint32_t pushConstantSize = 0,
+                    const std::string& label = {}) -> KernelHandle;
+  void destroyKernel(KernelHandle kernel);
+
+  // Records the whole batch into commandBuffer, submits it once and waits
+  // for it to complete. Barriers are only inserted between steps that touch
+  // the same buffer where at least one of them writes it, and results are
+  // made visible to the host.
+  auto submit(const ComputeBatch& batch) -> SubmitStats;
+
+  // Records arbitrary commands, e.g. GpuVector::sync(), submits them and
+  // waits for them to complete
+  void execute(const std::function<void(vk::CommandBuffer)>& recordCommands);
+
+  // Keeps a buffer replaced while building a batch alive until the next
+  // submit() has completed, as steps already in that batch may use it
+  void retire(std::unique_ptr<DeviceBuffer> buffer);
+
+  // Frees the retired buffers now. Only valid while the queue is idle, e.g.
+  // before the allocator they came from is destroyed.
+  void releaseRetired();
+
+  SlotMap<Kernel> kernels;
+
 private:
+  // Sized for this many descriptors of each type, grown on demand
+  uint32_t transientSetCapacity = 64;
+  uint32_t transientDescriptorCapacity = 256;
+  vk::DescriptorPool transientDescriptorPool;
+  vk::Fence fence;
+  std::vector<std::unique_ptr<DeviceBuffer>> retired;
+
+  void reserveDescriptors(uint32_t sets, uint32_t descriptors);
+  void record(const ComputeBatch& batch, SubmitStats& stats);
+  auto writeDescriptorSet(const Kernel& kernel,
+                          const std::vector<KernelBinding>& bindings)
+      -> vk::DescriptorSet;
 };
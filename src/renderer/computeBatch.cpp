@@ -0,0 +1,57 @@
+#include <utility>
+
+#include "computeBatch.hpp"
+
+auto ComputeBatch::dispatch(KernelHandle kernel,
+                            std::vector<KernelBinding> bindings,
+                            GroupCount groups,
+                            std::span<const std::byte> pushConstants)
+    -> ComputeBatch&
+{
+  steps.emplace_back(Dispatch {
+      .kernel = kernel,
+      .bindings = std::move(bindings),
+      .groups = groups,
+      .pushConstants = {pushConstants.begin(), pushConstants.end()}});
+  return *this;
+}
+
+auto ComputeBatch::dispatchIndirect(KernelHandle kernel,
+                                    std::vector<KernelBinding> bindings,
+                                    Buffer& arguments,
+                                    vk::DeviceSize argumentsOffset,
+                                    std::span<const std::byte> pushConstants)
+    -> ComputeBatch&
+{
+  steps.emplace_back(Dispatch {
+      .kernel = kernel,
+      .bindings = std::move(bindings),
+      .pushConstants = {pushConstants.begin(), pushConstants.end()},
+      .arguments = &arguments,
+      .argumentsOffset = argumentsOffset});
+  return *this;
+}
+
+auto ComputeBatch::copy(Buffer& src,
+                        Buffer& dst,
+                        vk::DeviceSize size,
+                        vk::DeviceSize srcOffset,
+                        vk::DeviceSize dstOffset) -> ComputeBatch&
+{
+  steps.emplace_back(Copy {.src = &src,
+                           .dst = &dst,
+                           .region = {.srcOffset = srcOffset,
+                                      .dstOffset = dstOffset,
+                                      .size = size}});
+  return *this;
+}
+
+auto ComputeBatch::fill(Buffer& dst,
+                        uint32_t value,
+                        vk::DeviceSize offset,
+                        vk::DeviceSize size) -> ComputeBatch&
+{
+  steps.emplace_back(
+      Fill {.dst = &dst, .value = value, .offset = offset, .size = size});
+  return *this;
+}
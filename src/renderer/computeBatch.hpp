@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "buffers/buffer.hpp"
+#include "slotMap.hpp"
+
+// A compute pipeline with its own descriptor set and push constant layout
+struct Kernel
+{
+  vk::DescriptorSetLayout descriptorSetLayout;
+  vk::PipelineLayout pipelineLayout;
+  vk::Pipeline pipeline;
+  std::vector<vk::DescriptorSetLayoutBinding> bindings;
+  uint32_t pushConstantSize = 0;
+};
+
+using KernelHandle = Handle<Kernel>;
+
+// How a step uses a buffer. Only used to decide where barriers are needed.
+enum class BufferAccess : uint8_t
+{
+  eRead,
+  eWrite,
+  eReadWrite,
+};
+
+struct KernelBinding
+{
+  uint32_t binding;
+  Buffer* buffer;
+  BufferAccess access = BufferAccess::eReadWrite;
+  vk::DeviceSize offset = 0;
+  vk::DeviceSize range = vk::WholeSize;
+};
+
+struct GroupCount
+{
+  uint32_t x = 1;
+  uint32_t y = 1;
+  uint32_t z = 1;
+
+  // Enough groups of groupSize threads to cover elements
+  static constexpr auto cover(uint32_t elements, uint32_t groupSize)
+      -> GroupCount
+  {
+    return {.x = (elements + groupSize - 1) / groupSize};
+  }
+};
+
+// An ordered list of kernel dispatches and buffer transfers that Compute
+// records into a single command buffer and submits at once.
+//
+// Steps only reference buffers; handles are resolved and descriptors written
+// when the batch is submitted, so buffers must stay alive until then but may
+// be relocated in between. A batch can be submitted any number of times.
+class ComputeBatch
+{
+public:
+  auto dispatch(KernelHandle kernel,
+                std::vector<KernelBinding> bindings,
+                GroupCount groups,
+                std::span<const std::byte> pushConstants = {})
+      -> ComputeBatch&;
+
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  auto dispatch(KernelHandle kernel,
+                std::vector<KernelBinding> bindings,
+                GroupCount groups,
+                const T& pushConstants) -> ComputeBatch&
+  {
+    return dispatch(kernel,
+                    std::move(bindings),
+                    groups,
+                    std::as_bytes(std::span(&pushConstants, 1)));
+  }
+
+  // Group counts are read on the GPU from a vk::DispatchIndirectCommand
+  auto dispatchIndirect(KernelHandle kernel,
+                        std::vector<KernelBinding> bindings,
+                        Buffer& arguments,
+                        vk::DeviceSize argumentsOffset = 0,
+                        std::span<const std::byte> pushConstants = {})
+      -> ComputeBatch&;
+
+  auto copy(Buffer& src,
+            Buffer& dst,
+            vk::DeviceSize size,
+            vk::DeviceSize srcOffset = 0,
+            vk::DeviceSize dstOffset = 0) -> ComputeBatch&;
+
+  auto fill(Buffer& dst,
+            uint32_t value,
+            vk::DeviceSize offset = 0,
+            vk::DeviceSize size = vk::WholeSize) -> ComputeBatch&;
+
+  void clear() { steps.clear(); }
+
+  [[nodiscard]] auto empty() const -> bool { return steps.empty(); }
+  [[nodiscard]] auto size() const -> size_t { return steps.size(); }
+
+private:
+  friend class Compute;
+
+  struct Dispatch
+  {
+    KernelHandle kernel;
+    std::vector<KernelBinding> bindings;
+    GroupCount groups;
+    std::vector<std::byte> pushConstants;
+    Buffer* arguments = nullptr;
+    vk::DeviceSize argumentsOffset = 0;
+  };
+
+  struct Copy
+  {
+    Buffer* src;
+    Buffer* dst;
+    vk::BufferCopy region;
+  };
+
+  struct Fill
+  {
+    Buffer* dst;
+    uint32_t value;
+    vk::DeviceSize offset;
+    vk::DeviceSize size;
+  };
+
+  std::vector<std::variant<Dispatch, Copy, Fill>> steps;
+};
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "defragmenter.hpp"
+
+#include <fmt/base.h>
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "buffers/buffer.hpp"
+
+Defragmenter::Defragmenter(vk::Device& device,
+                           VmaAllocator& allocator,
+                           uint32_t queueFamilyIndex,
+                           vk::DeviceSize maxBytesPerStep,
+                           uint32_t maxAllocationsPerStep)
+    : device(device)
+    , allocator(allocator)
+{
+  defragmentationInfo.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+  defragmentationInfo.maxBytesPerPass = maxBytesPerStep;
+  defragmentationInfo.maxAllocationsPerPass = maxAllocationsPerStep;
+
+  device.getQueue(queueFamilyIndex, 0, &queue);
+
+  commandPool = device.createCommandPool(
+      {.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer
+           | vk::CommandPoolCreateFlagBits::eTransient,
+       .queueFamilyIndex = queueFamilyIndex});
+
+  commandBuffer = device
+                      .allocateCommandBuffers(
+                          {.commandPool = commandPool,
+                           .level = vk::CommandBufferLevel::ePrimary,
+                           .commandBufferCount = 1})
+                      .front();
+
+  fence = device.createFence({});
+}
+
+Defragmenter::~Defragmenter()
+{
+  end();
+
+  device.destroyFence(fence);
+  device.freeCommandBuffers(commandPool, commandBuffer);
+  device.destroyCommandPool(commandPool);
+}
+
+void Defragmenter::request()
+{
+  requested = true;
+}
+
+bool Defragmenter::step()
+{
+  if (!isRunning()) {
+    const auto unused = unusedBytes();
+    settledUnusedBytes = std::min(settledUnusedBytes, unused);
+    if (unused >= settledUnusedBytes + defragmentationInfo.maxBytesPerPass) {
+      request();
+    }
+    if (!requested) {
+      return false;
+    }
+    begin();
+    if (!isRunning()) {
+      return false;
+    }
+  }
+
+  VmaDefragmentationPassMoveInfo pass {};
+  if (vmaBeginDefragmentationPass(allocator, context, &pass) == VK_SUCCESS) {
+    end();
+    return false;
+  }
+
+  // Create a buffer at the destination of each move and copy the contents
+  // across. Buffers that are not ours (no user data) are left in place.
+  std::vector<std::pair<Buffer*, vk::Buffer>> relocations;
+  relocations.reserve(pass.moveCount);
+
+  commandBuffer.begin(
+      {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+
+  for (uint32_t i = 0; i < pass.moveCount; i++) {
+    auto& move = pass.pMoves[i];
+
+    VmaAllocationInfo srcInfo;
+    vmaGetAllocationInfo(allocator, move.srcAllocation, &srcInfo);
+    auto* buffer = static_cast<Buffer*>(srcInfo.pUserData);
+
+    if (buffer == nullptr) {
+      move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+      continue;
+    }
+
+    const vk::Buffer newHandle = device.createBuffer(
+        {.size = buffer->size,
+         .usage = buffer->usage,
+         .sharingMode = vk::SharingMode::eExclusive});
+
+    if (vmaBindBufferMemory(allocator, move.dstTmpAllocation, newHandle)
+        != VK_SUCCESS)
+    {
+      device.destroyBuffer(newHandle);
+      move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+      continue;
+    }
+
+    commandBuffer.copyBuffer(
+        buffer->getHandle(), newHandle, {{0, 0, buffer->size}});
+    relocations.emplace_back(buffer, newHandle);
+  }
+
+  // Make the copies visible to whatever touches the buffers next
+  vk::MemoryBarrier memoryBarrier {
+      .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+      .dstAccessMask =
+          vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite};
+
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                vk::PipelineStageFlagBits::eAllCommands,
+                                {},
+                                memoryBarrier,
+                                nullptr,
+                                nullptr);
+
+  commandBuffer.end();
+
+  // The pass is budgeted, so waiting here keeps the relocation atomic from
+  // the callers' point of view without stalling for long.
+  device.resetFences(fence);
+  queue.submit(
+      vk::SubmitInfo {.commandBufferCount = 1,
+                      .pCommandBuffers = &commandBuffer},
+      fence);
+
+  if (device.waitForFences(fence, vk::True, UINT64_MAX)
+      != vk::Result::eSuccess)
+  {
+    throw std::runtime_error("Failed to wait for fence.");
+  }
+
+  // The old buffers must be gone before VMA frees the memory they are
+  // bound to
+  for (const auto& [buffer, newHandle] : relocations) {
+    buffer->relocate(newHandle);
+  }
+
+  const auto passResult =
+      vmaEndDefragmentationPass(allocator, context, &pass);
+
+  // Allocations now point at their new memory
+  for (const auto& relocation : relocations) {
+    relocation.first->finishRelocation();
+  }
+
+  if (passResult == VK_SUCCESS) {
+    end();
+    return false;
+  }
+
+  return true;
+}
+
+void Defragmenter::begin()
+{
+  requested = false;
+
+  if (vmaBeginDefragmentation(allocator, &defragmentationInfo, &context)
+      != VK_SUCCESS)
+  {
+    context = VK_NULL_HANDLE;
+  }
+}
+
+void Defragmenter::end()
+{
+  if (!isRunning()) {
+    return;
+  }
+
+  VmaDefragmentationStats stats {};
+  vmaEndDefragmentation(allocator, context, &stats);
+  context = VK_NULL_HANDLE;
+  settledUnusedBytes = unusedBytes();
+
+  totalStats.bytesMoved += stats.bytesMoved;
+  totalStats.bytesFreed += stats.bytesFreed;
+  totalStats.allocationsMoved += stats.allocationsMoved;
+  totalStats.deviceMemoryBlocksFreed += stats.deviceMemoryBlocksFreed;
+
+  if (stats.allocationsMoved > 0) {
+    fmt::println("Defragmentation moved {} allocations ({} bytes), freed {} "
+                 "blocks ({} bytes)",
+                 stats.allocationsMoved,
+                 stats.bytesMoved,
+                 stats.deviceMemoryBlocksFreed,
+                 stats.bytesFreed);
+  }
+}
+
+auto Defragmenter::unusedBytes() const -> vk::DeviceSize
+{
+  const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+  vmaGetMemoryProperties(allocator, &memoryProperties);
+
+  std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets {};
+  vmaGetHeapBudgets(allocator, budgets.data());
+
+  vk::DeviceSize unused = 0;
+  for (uint32_t heap = 0; heap < memoryProperties->memoryHeapCount; heap++) {
+    const auto& statistics = budgets[heap].statistics;
+    unused += statistics.blockBytes - statistics.allocationBytes;
+  }
+  return unused;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include "vk_mem_alloc.h"
+
+// Incrementally compacts VMA memory blocks. Each call to step() runs at most
+// one budgeted defragmentation pass: moved allocations are copied on the GPU
+// into their new place and the owning Buffer is patched in-place, so callers
+// holding a Buffer& (or a descriptor written through Buffer::bindDescriptor)
+// never observe the relocation.
+//
+// Buffers are mostly freed by the subsystems that own them, e.g. when a
+// GpuVector grows or Compute releases retired buffers, so step() also starts
+// a defragmentation by itself once frees have left maxBytesPerStep more
+// unused space in the allocator's blocks than there was after the last one.
+//
+// Allocations created with VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT own
+// their memory block and are never moved.
+class Defragmenter
+{
+public:
+  Defragmenter(vk::Device& device,
+               VmaAllocator& allocator,
+               uint32_t queueFamilyIndex,
+               vk::DeviceSize maxBytesPerStep = 16ULL * 1024 * 1024,
+               uint32_t maxAllocationsPerStep = 16);
+  ~Defragmenter();
+
+  Defragmenter(const Defragmenter&) = delete;
+  Defragmenter& operator=(const Defragmenter&) = delete;
+  Defragmenter(Defragmenter&&) = delete;
+  Defragmenter& operator=(Defragmenter&&) = delete;
+
+  // Marks the heap as worth compacting, e.g. after buffers were destroyed.
+  void request();
+
+  // Runs one defragmentation pass if a defragmentation is pending or frees
+  // call for one. Must be called while the GPU is not using any buffer owned
+  // by the allocator. Returns true while more passes remain.
+  bool step();
+
+  [[nodiscard]] auto isRunning() const -> bool
+  {
+    return context != VK_NULL_HANDLE;
+  }
+
+  VmaDefragmentationStats totalStats {};
+
+private:
+  vk::Device& device;
+  VmaAllocator& allocator;
+  vk::Queue queue;
+  vk::CommandPool commandPool;
+  vk::CommandBuffer commandBuffer;
+  vk::Fence fence;
+
+  VmaDefragmentationInfo defragmentationInfo {};
+  VmaDefragmentationContext context = VK_NULL_HANDLE;
+  bool requested = false;
+  // Unused bytes in the allocator's blocks after the last defragmentation,
+  // or since then if allocations have filled some of it again
+  vk::DeviceSize settledUnusedBytes = 0;
+
+  void begin();
+  void end();
+  [[nodiscard]] auto unusedBytes() const -> vk::DeviceSize;
+};
@@ -27,9 +27,11 @@ Device::Device(vk::Instance& instance, vk::SurfaceKHR* surface)
                                VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME};
   }
 
-  pickPhysicalDevice(enabledDeviceExtensions);
+  // Without a surface (headless benchmarks) only a compute queue is needed
+  const auto graphicsRequired = surface != nullptr;
+  pickPhysicalDevice(enabledDeviceExtensions, graphicsRequired);
 
-  queueFamilyIndices = findQueueFamilies(physicalDevice);
+  queueFamilyIndices = findQueueFamilies(physicalDevice, graphicsRequired);
 
   memoryProperties = physicalDevice.getMemoryProperties();
 
@@ -59,13 +61,68 @@ Device::Device(vk::Instance& instance, vk::SurfaceKHR* surface)
   // // Chain dynamic rendering after Vulkan 1.1 features
   // features11.pNext = &dynamicRenderingFeature;
 
-  vk::DeviceCreateInfo deviceCreateInfo {
+  // Point sprites larger than one pixel, and indirect draws that pick their
+  // object through firstInstance
+  const auto supported = physicalDevice.getFeatures2<
+      vk::PhysicalDeviceFeatures2,
+      vk::PhysicalDeviceVulkan12Features,
+      vk::PhysicalDeviceSubgroupSizeControlFeatures>();
+  const auto& supportedFeatures =
+      supported.get<vk::PhysicalDeviceFeatures2>().features;
+  vk::PhysicalDeviceFeatures enabledFeatures {
+      .multiDrawIndirect = supportedFeatures.multiDrawIndirect,
+      .drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance,
+      .largePoints = supportedFeatures.largePoints};
+
+  // GPU-driven draws read their draw count from a buffer
+  const auto& supportedFeatures12 =
+      supported.get<vk::PhysicalDeviceVulkan12Features>();
+  vk::PhysicalDeviceVulkan12Features features12 {
       .pNext = &dynamicRenderingFeature,
+      .drawIndirectCount = supportedFeatures12.drawIndirectCount};
+
+  // Kernels tuned for a subgroup size can request it, and full subgroups
+  const auto& supportedSizeControl =
+      supported.get<vk::PhysicalDeviceSubgroupSizeControlFeatures>();
+  vk::PhysicalDeviceSubgroupSizeControlFeatures sizeControlFeatures {
+      .pNext = &features12,
+      .subgroupSizeControl = supportedSizeControl.subgroupSizeControl,
+      .computeFullSubgroups = supportedSizeControl.computeFullSubgroups};
+
+  features.largePoints = enabledFeatures.largePoints == vk::True;
+  features.drawIndirectCount = features12.drawIndirectCount == vk::True;
+  features.subgroupSizeControl =
+      sizeControlFeatures.subgroupSizeControl == vk::True;
+  features.computeFullSubgroups =
+      sizeControlFeatures.computeFullSubgroups == vk::True;
+
+  const auto properties = physicalDevice.getProperties2<
+      vk::PhysicalDeviceProperties2,
+      vk::PhysicalDeviceSubgroupProperties,
+      vk::PhysicalDeviceSubgroupSizeControlProperties>();
+  const auto& subgroupProperties =
+      properties.get<vk::PhysicalDeviceSubgroupProperties>();
+  const auto& sizeControlProperties =
+      properties.get<vk::PhysicalDeviceSubgroupSizeControlProperties>();
+  subgroup = {
+      .size = subgroupProperties.subgroupSize,
+      .minSize = features.subgroupSizeControl
+          ? sizeControlProperties.minSubgroupSize
+          : subgroupProperties.subgroupSize,
+      .maxSize = features.subgroupSizeControl
+          ? sizeControlProperties.maxSubgroupSize
+          : subgroupProperties.subgroupSize,
+      .stages = subgroupProperties.supportedStages,
+      .operations = subgroupProperties.supportedOperations};
+
+  vk::DeviceCreateInfo deviceCreateInfo {
+      .pNext = &sizeControlFeatures,
       .queueCreateInfoCount = 1,
       .pQueueCreateInfos = &deviceQueueCreateInfo,
       .enabledExtensionCount =
           static_cast<uint32_t>(enabledDeviceExtensions.size()),
       .ppEnabledExtensionNames = enabledDeviceExtensions.data(),
+      .pEnabledFeatures = &enabledFeatures,
   };
 
   handle = physicalDevice.createDevice(deviceCreateInfo);
@@ -119,6 +176,7 @@ auto Device::createGraphicsPipeline(
     vk::PipelineShaderStageCreateInfo& fragmentStage,
     vk::PipelineVertexInputStateCreateInfo vertexInputInfo,
     vk::PipelineLayout& pipelineLayout,
+    vk::PrimitiveTopology topology,
     vk::PipelineCache pipelineCache) const -> vk::Pipeline
 {
   std::array<vk::PipelineShaderStageCreateInfo, 2>
@@ -161,7 +219,7 @@ auto Device::createGraphicsPipeline(
   //  render_pass);
 
   vk::PipelineInputAssemblyStateCreateInfo inputAssemblyState {
-      .topology = vk::PrimitiveTopology::eTriangleList};
+      .topology = topology};
 
   vk::PipelineTessellationStateCreateInfo tessellationState {
       .patchControlPoints = 0};
@@ -9,6 +9,7 @@
 
 #include "../application/window.hpp"
 
+class AssetPack;
 class Compute;
 
 class Device
@@ -35,6 +36,33 @@ private:
   };
 
 public:
+  // Optional features that were available and enabled
+  struct Features
+  {
+    bool largePoints = false;
+    bool drawIndirectCount = false;
+    bool subgroupSizeControl = false;
+    bool computeFullSubgroups = false;
+  };
+
+  // Subgroup (wave) size and the operations shaders may use on it. Without
+  // subgroupSizeControl the size range collapses to the default size.
+  struct Subgroup
+  {
+    uint32_t size = 1;
+    uint32_t minSize = 1;
+    uint32_t maxSize = 1;
+    vk::ShaderStageFlags stages;
+    vk::SubgroupFeatureFlags operations;
+
+    [[nodiscard]] auto supports(vk::ShaderStageFlagBits stage,
+                                vk::SubgroupFeatureFlags required) const
+        -> bool
+    {
+      return (stages & stage) && (operations & required) == required;
+    }
+  };
+
   explicit Device(vk::Instance& instance);
   Device(vk::Instance& instance, vk::SurfaceKHR* surface);
   ~Device();
@@ -55,6 +83,7 @@ public:
       vk::PipelineShaderStageCreateInfo& fragmentStage,
       vk::PipelineVertexInputStateCreateInfo vertexInputInfo,
       vk::PipelineLayout& pipelineLayout,
+      vk::PrimitiveTopology topology = vk::PrimitiveTopology::eTriangleList,
       vk::PipelineCache pipelineCache = nullptr) const -> vk::Pipeline;
 
   auto createSwapchain(const Window& window)
@@ -71,6 +100,10 @@ public:
   vk::Queue presentQueue {VK_NULL_HANDLE};
   vk::Queue computeQueue {VK_NULL_HANDLE};
   QueueFamilyIndices queueFamilyIndices;
+  Features features;
+  Subgroup subgroup;
+  // Baked SPIR-V that Shader prefers over src/shaders/bin, while open
+  const AssetPack* shaderPack = nullptr;
 
 private:
   vk::Instance& instance;
@@ -1,5 +1,3 @@
-#include <ranges>
-
 #include "executor.hpp"
 
 Executor::Executor(
@@ -71,9 +69,8 @@ void Executor::destroy()
   // storageBuffer.reset();
   // uniformBuffer.reset();
 
-  for (auto& val : pipelines | std::views::values) {
-    device.destroyPipeline(val);
-  }
+  pipelines.forEach(
+      [this](const vk::Pipeline& pipeline) { device.destroyPipeline(pipeline); });
 
   device.destroyPipelineLayout(pipelineLayout);
   // no need to free the descriptor_set, as it's implicitly free'd with the
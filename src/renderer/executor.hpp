@@ -1,10 +1,12 @@
 #pragma once
 
-#include <unordered_map>
-
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_handles.hpp>
 
+#include "slotMap.hpp"
+
+using PipelineHandle = Handle<vk::Pipeline>;
+
 class Executor
 {
 public:
@@ -26,13 +28,15 @@ public:
                                 // may differ from the one used for graphics)
   vk::DescriptorSet descriptorSet;  // shader bindings
   vk::DescriptorSetLayout descriptorSetLayout;  // shader binding layout
-  std::unordered_map<std::string, vk::Pipeline> pipelines;
+  SlotMap<vk::Pipeline> pipelines;
   vk::PipelineLayout pipelineLayout;  // Layout of the pipeline
   vk::Queue queue;  // Separate queue for commands (queue family may
                     // differ from the one used for graphics)
   uint32_t queueFamilyIndex = 0;
 
 protected:
+  vk::Device& device;
+
   void destroy();
 
 private:
@@ -47,5 +51,4 @@ private:
   vk::CommandBuffer allocateCommandBuffer(
       vk::CommandPool& commandPool,
       vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary) const;
-  vk::Device& device;
 };
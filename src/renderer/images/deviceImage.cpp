@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+#include "deviceImage.hpp"
+
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+namespace
+{
+auto accessAndStage(vk::ImageLayout layout)
+    -> std::pair<vk::AccessFlags, vk::PipelineStageFlags>
+{
+  switch (layout) {
+    case vk::ImageLayout::eUndefined:
+      return {vk::AccessFlagBits::eNone,
+              vk::PipelineStageFlagBits::eTopOfPipe};
+    case vk::ImageLayout::eTransferDstOptimal:
+      return {vk::AccessFlagBits::eTransferWrite,
+              vk::PipelineStageFlagBits::eTransfer};
+    case vk::ImageLayout::eTransferSrcOptimal:
+      return {vk::AccessFlagBits::eTransferRead,
+              vk::PipelineStageFlagBits::eTransfer};
+    case vk::ImageLayout::eShaderReadOnlyOptimal:
+      return {vk::AccessFlagBits::eShaderRead,
+              vk::PipelineStageFlagBits::eVertexShader
+                  | vk::PipelineStageFlagBits::eFragmentShader
+                  | vk::PipelineStageFlagBits::eComputeShader};
+    default:
+      return {vk::AccessFlagBits::eMemoryRead
+                  | vk::AccessFlagBits::eMemoryWrite,
+              vk::PipelineStageFlagBits::eAllCommands};
+  }
+}
+}  // namespace
+
+DeviceImage::DeviceImage(vk::Device& device,
+                         VmaAllocator& allocator,
+                         vk::Extent2D extent,
+                         vk::Format format,
+                         uint32_t mipLevels,
+                         vk::ImageUsageFlags usageFlags)
+    : extent(extent)
+    , format(format)
+    , mipLevels(mipLevels)
+    , device(device)
+    , allocator(allocator)
+{
+  vk::ImageCreateInfo imageCreateInfo {
+      .imageType = vk::ImageType::e2D,
+      .format = format,
+      .extent = {.width = extent.width, .height = extent.height, .depth = 1},
+      .mipLevels = mipLevels,
+      .arrayLayers = 1,
+      .samples = vk::SampleCountFlagBits::e1,
+      .tiling = vk::ImageTiling::eOptimal,
+      .usage = usageFlags,
+      .sharingMode = vk::SharingMode::eExclusive,
+      .initialLayout = vk::ImageLayout::eUndefined};
+
+  VmaAllocationCreateInfo allocCreateInfo {.usage = VMA_MEMORY_USAGE_AUTO,
+                                           .priority = 1.0F};
+
+  auto rawImageCreateInfo = static_cast<VkImageCreateInfo>(imageCreateInfo);
+
+  if (vmaCreateImage(allocator,
+                     &rawImageCreateInfo,
+                     &allocCreateInfo,
+                     &handle,
+                     &allocation,
+                     &allocInfo)
+      != VK_SUCCESS)
+  {
+    throw std::runtime_error("Failed to create image.");
+  }
+
+  view = device.createImageView(
+      {.image = handle,
+       .viewType = vk::ImageViewType::e2D,
+       .format = format,
+       .components = vk::ComponentMapping(),
+       .subresourceRange = vk::ImageSubresourceRange(
+           vk::ImageAspectFlagBits::eColor, 0, mipLevels, 0, 1)});
+}
+
+DeviceImage::~DeviceImage()
+{
+  device.destroyImageView(view);
+  vmaDestroyImage(allocator, handle, allocation);
+  handle = VK_NULL_HANDLE;
+  allocation = VK_NULL_HANDLE;
+}
+
+auto DeviceImage::getHandle() -> vk::Image
+{
+  return {handle};
+}
+
+auto DeviceImage::levelExtent(uint32_t level) const -> vk::Extent2D
+{
+  return {.width = std::max(extent.width >> level, 1U),
+          .height = std::max(extent.height >> level, 1U)};
+}
+
+void DeviceImage::transition(vk::CommandBuffer commandBuffer,
+                             vk::ImageLayout oldLayout,
+                             vk::ImageLayout newLayout,
+                             uint32_t baseMipLevel,
+                             uint32_t levelCount) const
+{
+  const auto [srcAccessMask, srcStageMask] = accessAndStage(oldLayout);
+  const auto [dstAccessMask, dstStageMask] = accessAndStage(newLayout);
+
+  vk::ImageMemoryBarrier imageMemoryBarrier {
+      .srcAccessMask = srcAccessMask,
+      .dstAccessMask = dstAccessMask,
+      .oldLayout = oldLayout,
+      .newLayout = newLayout,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .image = handle,
+      .subresourceRange = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                           .baseMipLevel = baseMipLevel,
+                           .levelCount = levelCount,
+                           .baseArrayLayer = 0,
+                           .layerCount = 1}};
+
+  commandBuffer.pipelineBarrier(
+      srcStageMask, dstStageMask, {}, nullptr, nullptr, imageMemoryBarrier);
+}
+
+void DeviceImage::generateMipmaps(vk::CommandBuffer commandBuffer) const
+{
+  for (uint32_t level = 1; level < mipLevels; level++) {
+    transition(commandBuffer,
+               vk::ImageLayout::eTransferDstOptimal,
+               vk::ImageLayout::eTransferSrcOptimal,
+               level - 1,
+               1);
+
+    const auto src = levelExtent(level - 1);
+    const auto dst = levelExtent(level);
+
+    vk::ImageBlit blit {
+        .srcSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                           .mipLevel = level - 1,
+                           .baseArrayLayer = 0,
+                           .layerCount = 1},
+        .srcOffsets = std::array<vk::Offset3D, 2> {
+            vk::Offset3D {},
+            vk::Offset3D {.x = static_cast<int32_t>(src.width),
+                          .y = static_cast<int32_t>(src.height),
+                          .z = 1}},
+        .dstSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                           .mipLevel = level,
+                           .baseArrayLayer = 0,
+                           .layerCount = 1},
+        .dstOffsets = std::array<vk::Offset3D, 2> {
+            vk::Offset3D {},
+            vk::Offset3D {.x = static_cast<int32_t>(dst.width),
+                          .y = static_cast<int32_t>(dst.height),
+                          .z = 1}}};
+
+    commandBuffer.blitImage(handle,
+                            vk::ImageLayout::eTransferSrcOptimal,
+                            handle,
+                            vk::ImageLayout::eTransferDstOptimal,
+                            blit,
+                            vk::Filter::eLinear);
+
+    transition(commandBuffer,
+               vk::ImageLayout::eTransferSrcOptimal,
+               vk::ImageLayout::eShaderReadOnlyOptimal,
+               level - 1,
+               1);
+  }
+
+  transition(commandBuffer,
+             vk::ImageLayout::eTransferDstOptimal,
+             vk::ImageLayout::eShaderReadOnlyOptimal,
+             mipLevels - 1,
+             1);
+}
+
+auto DeviceImage::mipLevelCount(vk::Extent2D extent) -> uint32_t
+{
+  return static_cast<uint32_t>(
+      std::bit_width(std::max(extent.width, extent.height)));
+}
+
+auto DeviceImage::texelSize(vk::Format format) -> uint32_t
+{
+  switch (format) {
+    case vk::Format::eR8Unorm:
+      return 1;
+    case vk::Format::eR8G8Unorm:
+      return 2;
+    case vk::Format::eR8G8B8A8Unorm:
+    case vk::Format::eR8G8B8A8Srgb:
+    case vk::Format::eB8G8R8A8Unorm:
+    case vk::Format::eB8G8R8A8Srgb:
+    case vk::Format::eR32Sfloat:
+      return 4;
+    case vk::Format::eR16G16B16A16Sfloat:
+      return 8;
+    case vk::Format::eR32G32B32A32Sfloat:
+      return 16;
+    default:
+      throw std::runtime_error("Unsupported texture format: "
+                               + vk::to_string(format));
+  }
+}
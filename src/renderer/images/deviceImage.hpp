@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+#include <vulkan/vulkan.hpp>
+
+#include "vk_mem_alloc.h"
+
+// A VMA-backed 2D image with a view over all of its mip levels.
+class DeviceImage
+{
+public:
+  DeviceImage(vk::Device& device,
+              VmaAllocator& allocator,
+              vk::Extent2D extent,
+              vk::Format format,
+              uint32_t mipLevels = 1,
+              vk::ImageUsageFlags usageFlags =
+                  vk::ImageUsageFlagBits::eSampled
+                  | vk::ImageUsageFlagBits::eTransferSrc
+                  | vk::ImageUsageFlagBits::eTransferDst);
+  ~DeviceImage();
+
+  DeviceImage(const DeviceImage&) = delete;
+  DeviceImage& operator=(const DeviceImage&) = delete;
+  DeviceImage(DeviceImage&&) = delete;
+  DeviceImage& operator=(DeviceImage&&) = delete;
+
+  VkImage handle {VK_NULL_HANDLE};
+  VmaAllocation allocation = VK_NULL_HANDLE;
+  VmaAllocationInfo allocInfo = {};
+  vk::ImageView view;
+
+  vk::Extent2D extent;
+  vk::Format format;
+  uint32_t mipLevels;
+
+  auto getHandle() -> vk::Image;
+
+  [[nodiscard]] auto levelExtent(uint32_t level) const -> vk::Extent2D;
+
+  // Records a layout transition of a range of mip levels, deriving access
+  // masks and pipeline stages from the layouts.
+  void transition(vk::CommandBuffer commandBuffer,
+                  vk::ImageLayout oldLayout,
+                  vk::ImageLayout newLayout,
+                  uint32_t baseMipLevel = 0,
+                  uint32_t levelCount = VK_REMAINING_MIP_LEVELS) const;
+
+  // Fills levels 1..n by successive linear blits from level 0. Expects every
+  // level in eTransferDstOptimal and leaves them all in
+  // eShaderReadOnlyOptimal. Must be recorded on a graphics queue.
+  void generateMipmaps(vk::CommandBuffer commandBuffer) const;
+
+  static auto mipLevelCount(vk::Extent2D extent) -> uint32_t;
+  static auto texelSize(vk::Format format) -> uint32_t;
+
+private:
+  vk::Device& device;
+  VmaAllocator& allocator;
+};
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <utility>
+
+#include "proceduralTextures.hpp"
+
+auto makeParticleSprite(uint32_t size) -> std::vector<std::array<uint8_t, 4>>
+{
+  std::vector<std::array<uint8_t, 4>> sprite(std::size_t {size} * size);
+  const auto scale = static_cast<float>(size);
+  for (uint32_t y = 0; y < size; y++) {
+    for (uint32_t x = 0; x < size; x++) {
+      const auto u = (((static_cast<float>(x) + 0.5F) / scale) * 2.0F) - 1.0F;
+      const auto v = (((static_cast<float>(y) + 0.5F) / scale) * 2.0F) - 1.0F;
+      const auto falloff =
+          std::clamp(1.0F - std::sqrt((u * u) + (v * v)), 0.0F, 1.0F);
+      const auto value = static_cast<uint8_t>(falloff * falloff * 255.0F);
+      sprite[(std::size_t {y} * size) + x] = {value, value, value, value};
+    }
+  }
+  return sprite;
+}
+
+auto makeSpeedRamp(uint32_t size) -> std::vector<std::array<uint8_t, 4>>
+{
+  std::vector<std::array<uint8_t, 4>> ramp(size);
+  for (uint32_t i = 0; i < size; i++) {
+    const auto t = static_cast<uint8_t>(i * 256 / size);
+    ramp[i] = {t,
+               static_cast<uint8_t>(64 + (t / 2)),
+               static_cast<uint8_t>(255 - t),
+               255};
+  }
+  return ramp;
+}
+
+auto makeMipChain(uint32_t width,
+                  uint32_t height,
+                  std::span<const std::array<uint8_t, 4>> texels)
+    -> std::vector<std::vector<std::byte>>
+{
+  using Texel = std::array<uint8_t, 4>;
+  std::vector<Texel> level(texels.begin(), texels.end());
+  std::vector<std::vector<std::byte>> chain;
+  const auto levelCount =
+      static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+
+  for (uint32_t mip = 0; mip < levelCount; mip++) {
+    const auto bytes = std::as_bytes(std::span(level));
+    chain.emplace_back(bytes.begin(), bytes.end());
+    if (mip + 1 == levelCount) {
+      break;
+    }
+
+    // Odd or unit dimensions repeat their last row or column
+    const uint32_t nextWidth = std::max(width / 2, 1U);
+    const uint32_t nextHeight = std::max(height / 2, 1U);
+    std::vector<Texel> next(std::size_t {nextWidth} * nextHeight);
+    for (uint32_t y = 0; y < nextHeight; y++) {
+      for (uint32_t x = 0; x < nextWidth; x++) {
+        const std::array<uint32_t, 2> xs = {std::min(2 * x, width - 1),
+                                            std::min((2 * x) + 1, width - 1)};
+        const std::array<uint32_t, 2> ys = {std::min(2 * y, height - 1),
+                                            std::min((2 * y) + 1, height - 1)};
+        for (std::size_t channel = 0; channel < 4; channel++) {
+          uint32_t sum = 2;  // Rounds to nearest
+          for (const auto sy : ys) {
+            for (const auto sx : xs) {
+              sum += level[(std::size_t {sy} * width) + sx][channel];
+            }
+          }
+          next[(std::size_t {y} * nextWidth) + x][channel] =
+              static_cast<uint8_t>(sum / 4);
+        }
+      }
+    }
+    level = std::move(next);
+    width = nextWidth;
+    height = nextHeight;
+  }
+  return chain;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// RGBA8 texels of the textures the renderer generates rather than loads,
+// shared with asset-baker
+
+// size x size radial falloff sprite for particles
+auto makeParticleSprite(uint32_t size) -> std::vector<std::array<uint8_t, 4>>;
+
+// size x 1 cool-to-warm ramp indexed by particle speed
+auto makeSpeedRamp(uint32_t size) -> std::vector<std::array<uint8_t, 4>>;
+
+// The full mip chain of width x height RGBA8 texels, largest first and
+// tightly packed, each level the 2x2 box filter of the one above
+auto makeMipChain(uint32_t width,
+                  uint32_t height,
+                  std::span<const std::array<uint8_t, 4>> texels)
+    -> std::vector<std::vector<std::byte>>;
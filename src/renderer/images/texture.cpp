@@ -0,0 +1,82 @@
+#include <utility>
+
+#include "texture.hpp"
+
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+Texture::Texture(vk::Device& device,
+                 std::shared_ptr<const TextureSource> source,
+                 std::unique_ptr<DeviceImage> image,
+                 uint32_t levelCount,
+                 uint32_t residentMip,
+                 uint32_t tailMip)
+    : source(std::move(source))
+    , image(std::move(image))
+    , levelCount(levelCount)
+    , residentMip(residentMip)
+    , tailMip(tailMip)
+    , device(device)
+{
+}
+
+void Texture::bindDescriptor(vk::DescriptorSet set,
+                             uint32_t binding,
+                             vk::Sampler sampler,
+                             uint32_t arrayElement)
+{
+  const DescriptorReference reference {.set = set,
+                                       .binding = binding,
+                                       .arrayElement = arrayElement,
+                                       .sampler = sampler};
+  writeDescriptor(reference);
+
+  std::erase_if(descriptorReferences, [&](const DescriptorReference& x) {
+    return x.set == set && x.binding == binding
+        && x.arrayElement == arrayElement;
+  });
+  descriptorReferences.push_back(reference);
+}
+
+auto Texture::replaceImage(std::unique_ptr<DeviceImage> newImage,
+                           uint32_t newMip) -> std::unique_ptr<DeviceImage>
+{
+  std::swap(image, newImage);
+  residentMip = newMip;
+
+  for (const auto& reference : descriptorReferences) {
+    writeDescriptor(reference);
+  }
+
+  return newImage;
+}
+
+auto Texture::residentBytes() const -> vk::DeviceSize
+{
+  const auto texelSize = DeviceImage::texelSize(image->format);
+
+  vk::DeviceSize bytes = 0;
+  for (uint32_t level = 0; level < image->mipLevels; level++) {
+    const auto extent = image->levelExtent(level);
+    bytes += vk::DeviceSize {extent.width} * extent.height * texelSize;
+  }
+  return bytes;
+}
+
+void Texture::writeDescriptor(const DescriptorReference& reference) const
+{
+  vk::DescriptorImageInfo imageInfo {
+      .sampler = reference.sampler,
+      .imageView = image->view,
+      .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal};
+
+  vk::WriteDescriptorSet writeDescriptorSet {
+      .dstSet = reference.set,
+      .dstBinding = reference.binding,
+      .dstArrayElement = reference.arrayElement,
+      .descriptorCount = 1,
+      .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+      .pImageInfo = &imageInfo};
+
+  device.updateDescriptorSets(writeDescriptorSet, nullptr);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "deviceImage.hpp"
+#include "textureSource.hpp"
+
+// A sampled image whose resident mip range may change over time. The image
+// always holds source levels [residentMip, levelCount); levels at or below
+// tailMip are never evicted. Descriptors written through bindDescriptor()
+// are rewritten whenever the image is replaced.
+class Texture
+{
+public:
+  Texture(vk::Device& device,
+          std::shared_ptr<const TextureSource> source,
+          std::unique_ptr<DeviceImage> image,
+          uint32_t levelCount,
+          uint32_t residentMip,
+          uint32_t tailMip);
+
+  Texture(const Texture&) = delete;
+  Texture& operator=(const Texture&) = delete;
+  Texture(Texture&&) = delete;
+  Texture& operator=(Texture&&) = delete;
+
+  // Null for textures that are fully resident from creation
+  std::shared_ptr<const TextureSource> source;
+  std::unique_ptr<DeviceImage> image;
+
+  uint32_t levelCount;
+  uint32_t residentMip;
+  uint32_t tailMip;
+
+  uint64_t lastUsedFrame = 0;
+  bool loadPending = false;
+
+  void bindDescriptor(vk::DescriptorSet set,
+                      uint32_t binding,
+                      vk::Sampler sampler,
+                      uint32_t arrayElement = 0);
+
+  // Swaps in a new image and returns the old one, which must be kept alive
+  // until commands referencing it have completed.
+  auto replaceImage(std::unique_ptr<DeviceImage> newImage, uint32_t newMip)
+      -> std::unique_ptr<DeviceImage>;
+
+  [[nodiscard]] auto residentBytes() const -> vk::DeviceSize;
+
+private:
+  struct DescriptorReference
+  {
+    vk::DescriptorSet set;
+    uint32_t binding;
+    uint32_t arrayElement;
+    vk::Sampler sampler;
+  };
+
+  vk::Device& device;
+  std::vector<DescriptorReference> descriptorReferences;
+
+  void writeDescriptor(const DescriptorReference& reference) const;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+// Supplies the pixels of a texture one mip level at a time. readLevel() is
+// called from the texture streaming thread and may block on I/O, so
+// implementations must be safe to call concurrently with the render thread.
+class TextureSource
+{
+public:
+  virtual ~TextureSource() = default;
+
+  [[nodiscard]] virtual auto extent() const -> vk::Extent2D = 0;
+  [[nodiscard]] virtual auto format() const -> vk::Format = 0;
+  [[nodiscard]] virtual auto levelCount() const -> uint32_t = 0;
+
+  // Tightly packed texels of a mip level
+  [[nodiscard]] virtual auto readLevel(uint32_t level) const
+      -> std::vector<std::byte> = 0;
+
+  [[nodiscard]] auto levelExtent(uint32_t level) const -> vk::Extent2D
+  {
+    const auto base = extent();
+    return {.width = std::max(base.width >> level, 1U),
+            .height = std::max(base.height >> level, 1U)};
+  }
+};
+
+// A texture whose full mip chain is already in memory (or in a mapped file).
+class MemoryTextureSource : public TextureSource
+{
+public:
+  MemoryTextureSource(vk::Extent2D extent,
+                      vk::Format format,
+                      std::vector<std::span<const std::byte>> levels)
+      : baseExtent(extent)
+      , texelFormat(format)
+      , levels(std::move(levels))
+  {
+    if (this->levels.empty()) {
+      throw std::runtime_error("Texture source has no mip levels.");
+    }
+  }
+
+  [[nodiscard]] auto extent() const -> vk::Extent2D override
+  {
+    return baseExtent;
+  }
+
+  [[nodiscard]] auto format() const -> vk::Format override
+  {
+    return texelFormat;
+  }
+
+  [[nodiscard]] auto levelCount() const -> uint32_t override
+  {
+    return static_cast<uint32_t>(levels.size());
+  }
+
+  [[nodiscard]] auto readLevel(uint32_t level) const
+      -> std::vector<std::byte> override
+  {
+    const auto& bytes = levels.at(level);
+    return {bytes.begin(), bytes.end()};
+  }
+
+private:
+  vk::Extent2D baseExtent;
+  vk::Format texelFormat;
+  std::vector<std::span<const std::byte>> levels;
+};
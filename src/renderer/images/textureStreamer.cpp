@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "textureStreamer.hpp"
+
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+TextureStreamer::TextureStreamer(vk::Device& device,
+                                 VmaAllocator& allocator,
+                                 uint32_t queueFamilyIndex,
+                                 vk::DeviceSize residencyBudget,
+                                 uint32_t tailSize)
+    : device(device)
+    , allocator(allocator)
+    , residencyBudget(residencyBudget)
+    , tailSize(tailSize)
+{
+  device.getQueue(queueFamilyIndex, 0, &queue);
+
+  commandPool = device.createCommandPool(
+      {.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+       .queueFamilyIndex = queueFamilyIndex});
+
+  commandBuffer = device
+                      .allocateCommandBuffers(
+                          {.commandPool = commandPool,
+                           .level = vk::CommandBufferLevel::ePrimary,
+                           .commandBufferCount = 1})
+                      .front();
+
+  fence = device.createFence({});
+
+  // Views only cover resident levels, so LOD clamping falls out naturally
+  sampler = device.createSampler(
+      {.magFilter = vk::Filter::eLinear,
+       .minFilter = vk::Filter::eLinear,
+       .mipmapMode = vk::SamplerMipmapMode::eLinear,
+       .addressModeU = vk::SamplerAddressMode::eClampToEdge,
+       .addressModeV = vk::SamplerAddressMode::eClampToEdge,
+       .addressModeW = vk::SamplerAddressMode::eClampToEdge,
+       .maxLod = VK_LOD_CLAMP_NONE});
+
+  worker = std::jthread(
+      [this](const std::stop_token& stopToken) { load(stopToken); });
+}
+
+TextureStreamer::~TextureStreamer()
+{
+  worker.request_stop();
+  worker.join();
+
+  textures.clear();
+  retiredImages.clear();
+  retiredStaging.clear();
+
+  device.destroySampler(sampler);
+  device.destroyFence(fence);
+  device.freeCommandBuffers(commandPool, commandBuffer);
+  device.destroyCommandPool(commandPool);
+}
+
+auto TextureStreamer::create(std::shared_ptr<const TextureSource> source,
+                             const std::string& label) -> Handle<Texture>
+{
+  const auto levelCount = source->levelCount();
+
+  // The tail starts at the first level that fits in tailSize
+  uint32_t tailMip = 0;
+  while (tailMip + 1 < levelCount) {
+    const auto extent = source->levelExtent(tailMip);
+    if (std::max(extent.width, extent.height) <= tailSize) {
+      break;
+    }
+    tailMip++;
+  }
+
+  auto image = std::make_unique<DeviceImage>(device,
+                                             allocator,
+                                             source->levelExtent(tailMip),
+                                             source->format(),
+                                             levelCount - tailMip);
+
+  std::vector<std::byte> tail;
+  std::vector<vk::BufferImageCopy> regions;
+  for (uint32_t level = tailMip; level < levelCount; level++) {
+    const auto pixels = source->readLevel(level);
+    const auto extent = source->levelExtent(level);
+    regions.push_back(
+        {.bufferOffset = tail.size(),
+         .imageSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                              .mipLevel = level - tailMip,
+                              .baseArrayLayer = 0,
+                              .layerCount = 1},
+         .imageExtent = {
+             .width = extent.width, .height = extent.height, .depth = 1}});
+    tail.insert(tail.end(), pixels.begin(), pixels.end());
+  }
+
+  HostBuffer staging(device,
+                     allocator,
+                     tail.size(),
+                     tail.data(),
+                     vk::BufferUsageFlagBits::eTransferSrc);
+
+  submitImmediately([&](vk::CommandBuffer commandBuffer) {
+    image->transition(commandBuffer,
+                      vk::ImageLayout::eUndefined,
+                      vk::ImageLayout::eTransferDstOptimal);
+    commandBuffer.copyBufferToImage(staging.getHandle(),
+                                    image->getHandle(),
+                                    vk::ImageLayout::eTransferDstOptimal,
+                                    regions);
+    image->transition(commandBuffer,
+                      vk::ImageLayout::eTransferDstOptimal,
+                      vk::ImageLayout::eShaderReadOnlyOptimal);
+  });
+
+  const auto handle = textures.emplace(device,
+                                       std::move(source),
+                                       std::move(image),
+                                       levelCount,
+                                       tailMip,
+                                       tailMip);
+  textures.setLabel(handle, label);
+
+  auto& texture = textures.get(handle);
+  stats.residentBytes += texture.residentBytes();
+  texture.lastUsedFrame = frame;
+
+  return handle;
+}
+
+auto TextureStreamer::createWithMipmaps(vk::Extent2D extent,
+                                        vk::Format format,
+                                        std::span<const std::byte> pixels,
+                                        const std::string& label)
+    -> Handle<Texture>
+{
+  const auto levelCount = DeviceImage::mipLevelCount(extent);
+  auto image = std::make_unique<DeviceImage>(
+      device, allocator, extent, format, levelCount);
+
+  HostBuffer staging(device,
+                     allocator,
+                     pixels.size(),
+                     pixels.data(),
+                     vk::BufferUsageFlagBits::eTransferSrc);
+
+  submitImmediately([&](vk::CommandBuffer commandBuffer) {
+    image->transition(commandBuffer,
+                      vk::ImageLayout::eUndefined,
+                      vk::ImageLayout::eTransferDstOptimal);
+    commandBuffer.copyBufferToImage(
+        staging.getHandle(),
+        image->getHandle(),
+        vk::ImageLayout::eTransferDstOptimal,
+        vk::BufferImageCopy {
+            .imageSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                                 .mipLevel = 0,
+                                 .baseArrayLayer = 0,
+                                 .layerCount = 1},
+            .imageExtent = {
+                .width = extent.width, .height = extent.height, .depth = 1}});
+    image->generateMipmaps(commandBuffer);
+  });
+
+  const auto handle =
+      textures.emplace(device, nullptr, std::move(image), levelCount, 0, 0);
+  textures.setLabel(handle, label);
+  stats.residentBytes += textures.get(handle).residentBytes();
+
+  return handle;
+}
+
+void TextureStreamer::destroy(Handle<Texture> handle)
+{
+  auto& texture = textures.get(handle);
+  stats.residentBytes -= texture.residentBytes();
+  retiredImages.push_back(std::move(texture.image));
+  textures.erase(handle);
+}
+
+auto TextureStreamer::get(Handle<Texture> handle) -> Texture&
+{
+  return textures.get(handle);
+}
+
+void TextureStreamer::touch(Handle<Texture> handle)
+{
+  textures.get(handle).lastUsedFrame = frame;
+}
+
+void TextureStreamer::bindDescriptor(Handle<Texture> handle,
+                                     vk::DescriptorSet set,
+                                     uint32_t binding,
+                                     uint32_t arrayElement)
+{
+  textures.get(handle).bindDescriptor(set, binding, sampler, arrayElement);
+}
+
+void TextureStreamer::update(vk::CommandBuffer commandBuffer)
+{
+  frame++;
+  retiredImages.clear();
+  retiredStaging.clear();
+
+  std::vector<LoadResult> completed;
+  {
+    const std::scoped_lock lock(mutex);
+    completed.swap(results);
+  }
+
+  for (auto& result : completed) {
+    auto* texture = textures.find(result.texture);
+    if (texture == nullptr) {
+      continue;
+    }
+    texture->loadPending = false;
+
+    // The texture may have been shrunk while the level was loading
+    if (result.level + 1 != texture->residentMip) {
+      continue;
+    }
+
+    const auto extent = texture->source->levelExtent(result.level);
+    const auto levelBytes = vk::DeviceSize {extent.width} * extent.height
+        * DeviceImage::texelSize(texture->image->format);
+    if (stats.residentBytes + levelBytes > residencyBudget) {
+      continue;
+    }
+
+    resize(*texture, result.level, result.pixels, commandBuffer);
+    stats.levelsStreamed++;
+  }
+
+  evict(commandBuffer);
+
+  textures.forEach([&](Handle<Texture> handle, Texture& texture) {
+    const auto recentlyUsed =
+        texture.lastUsedFrame + evictionDelayFrames >= frame;
+    if (texture.source && texture.residentMip > 0 && !texture.loadPending
+        && recentlyUsed)
+    {
+      requestLevel(handle, texture);
+    }
+  });
+}
+
+void TextureStreamer::requestLevel(Handle<Texture> handle, Texture& texture)
+{
+  const auto level = texture.residentMip - 1;
+  const auto extent = texture.source->levelExtent(level);
+  const auto levelBytes = vk::DeviceSize {extent.width} * extent.height
+      * DeviceImage::texelSize(texture.image->format);
+
+  // Don't fetch levels that could only be streamed in by evicting others
+  if (stats.residentBytes + levelBytes > residencyBudget) {
+    return;
+  }
+
+  texture.loadPending = true;
+  {
+    const std::scoped_lock lock(mutex);
+    requests.push_back(
+        {.texture = handle, .source = texture.source, .level = level});
+  }
+  condition.notify_one();
+}
+
+void TextureStreamer::evict(vk::CommandBuffer commandBuffer)
+{
+  while (stats.residentBytes > residencyBudget) {
+    Texture* victim = nullptr;
+    textures.forEach([&](Texture& texture) {
+      const auto unused = texture.lastUsedFrame + evictionDelayFrames < frame;
+      const auto evictable = texture.residentMip < texture.tailMip;
+      if (unused && evictable
+          && (victim == nullptr
+              || texture.lastUsedFrame < victim->lastUsedFrame))
+      {
+        victim = &texture;
+      }
+    });
+
+    if (victim == nullptr) {
+      return;
+    }
+
+    resize(*victim, victim->residentMip + 1, {}, commandBuffer);
+    stats.levelsEvicted++;
+  }
+}
+
+void TextureStreamer::resize(Texture& texture,
+                             uint32_t newMip,
+                             std::span<const std::byte> topLevel,
+                             vk::CommandBuffer commandBuffer)
+{
+  const auto& oldImage = *texture.image;
+  auto newImage =
+      std::make_unique<DeviceImage>(device,
+                                    allocator,
+                                    texture.source->levelExtent(newMip),
+                                    oldImage.format,
+                                    texture.levelCount - newMip);
+
+  oldImage.transition(commandBuffer,
+                      vk::ImageLayout::eShaderReadOnlyOptimal,
+                      vk::ImageLayout::eTransferSrcOptimal);
+  newImage->transition(commandBuffer,
+                       vk::ImageLayout::eUndefined,
+                       vk::ImageLayout::eTransferDstOptimal);
+
+  std::vector<vk::ImageCopy> regions;
+  for (auto level = std::max(texture.residentMip, newMip);
+       level < texture.levelCount;
+       level++)
+  {
+    const auto extent = texture.source->levelExtent(level);
+    regions.push_back(
+        {.srcSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                            .mipLevel = level - texture.residentMip,
+                            .baseArrayLayer = 0,
+                            .layerCount = 1},
+         .dstSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                            .mipLevel = level - newMip,
+                            .baseArrayLayer = 0,
+                            .layerCount = 1},
+         .extent = {
+             .width = extent.width, .height = extent.height, .depth = 1}});
+  }
+
+  commandBuffer.copyImage(oldImage.handle,
+                          vk::ImageLayout::eTransferSrcOptimal,
+                          newImage->handle,
+                          vk::ImageLayout::eTransferDstOptimal,
+                          regions);
+
+  if (!topLevel.empty()) {
+    const auto extent = texture.source->levelExtent(newMip);
+    commandBuffer.copyBufferToImage(
+        stage(topLevel).getHandle(),
+        newImage->getHandle(),
+        vk::ImageLayout::eTransferDstOptimal,
+        vk::BufferImageCopy {
+            .imageSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor,
+                                 .mipLevel = 0,
+                                 .baseArrayLayer = 0,
+                                 .layerCount = 1},
+            .imageExtent = {
+                .width = extent.width, .height = extent.height, .depth = 1}});
+  }
+
+  newImage->transition(commandBuffer,
+                       vk::ImageLayout::eTransferDstOptimal,
+                       vk::ImageLayout::eShaderReadOnlyOptimal);
+
+  stats.residentBytes -= texture.residentBytes();
+  retiredImages.push_back(texture.replaceImage(std::move(newImage), newMip));
+  stats.residentBytes += texture.residentBytes();
+}
+
+void TextureStreamer::load(const std::stop_token& stopToken)
+{
+  while (true) {
+    LoadRequest request;
+    {
+      std::unique_lock lock(mutex);
+      if (!condition.wait(
+              lock, stopToken, [this] { return !requests.empty(); }))
+      {
+        return;
+      }
+      request = std::move(requests.front());
+      requests.pop_front();
+    }
+
+    auto pixels = request.source->readLevel(request.level);
+
+    const std::scoped_lock lock(mutex);
+    results.push_back({.texture = request.texture,
+                       .level = request.level,
+                       .pixels = std::move(pixels)});
+  }
+}
+
+auto TextureStreamer::stage(std::span<const std::byte> bytes) -> HostBuffer&
+{
+  retiredStaging.push_back(
+      std::make_unique<HostBuffer>(device,
+                                   allocator,
+                                   bytes.size(),
+                                   bytes.data(),
+                                   vk::BufferUsageFlagBits::eTransferSrc));
+  return *retiredStaging.back();
+}
+
+void TextureStreamer::submitImmediately(
+    const std::function<void(vk::CommandBuffer)>& record)
+{
+  commandBuffer.begin(
+      {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+  record(commandBuffer);
+  commandBuffer.end();
+
+  device.resetFences(fence);
+  queue.submit(vk::SubmitInfo {.commandBufferCount = 1,
+                               .pCommandBuffers = &commandBuffer},
+               fence);
+
+  if (device.waitForFences(fence, vk::True, UINT64_MAX)
+      != vk::Result::eSuccess)
+  {
+    throw std::runtime_error("Failed to wait for fence.");
+  }
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include "../buffers/hostBuffer.hpp"
+#include "../slotMap.hpp"
+#include "deviceImage.hpp"
+#include "texture.hpp"
+#include "textureSource.hpp"
+#include "vk_mem_alloc.h"
+
+// Owns all textures and keeps their resident mip ranges within a memory
+// budget.
+//
+// Streamed textures start with only their small mip tail resident. Higher
+// levels are read from the TextureSource on a background thread, one level
+// at a time, and are spliced in on the render thread by update(): the image
+// is reallocated one level larger, existing levels are copied across on the
+// GPU and the new level is uploaded. When the budget is exceeded, the top
+// level of textures that have not been touched recently is dropped the same
+// way.
+class TextureStreamer
+{
+public:
+  struct Stats
+  {
+    vk::DeviceSize residentBytes = 0;
+    uint64_t levelsStreamed = 0;
+    uint64_t levelsEvicted = 0;
+  };
+
+  TextureStreamer(vk::Device& device,
+                  VmaAllocator& allocator,
+                  uint32_t queueFamilyIndex,
+                  vk::DeviceSize residencyBudget = 256ULL * 1024 * 1024,
+                  uint32_t tailSize = 64);
+  ~TextureStreamer();
+
+  TextureStreamer(const TextureStreamer&) = delete;
+  TextureStreamer& operator=(const TextureStreamer&) = delete;
+  TextureStreamer(TextureStreamer&&) = delete;
+  TextureStreamer& operator=(TextureStreamer&&) = delete;
+
+  // Uploads the mip tail immediately and streams the rest in the background
+  auto create(std::shared_ptr<const TextureSource> source,
+              const std::string& label) -> Handle<Texture>;
+
+  // Uploads level 0 and generates the full mip chain on the GPU. The result
+  // is always resident.
+  auto createWithMipmaps(vk::Extent2D extent,
+                         vk::Format format,
+                         std::span<const std::byte> pixels,
+                         const std::string& label) -> Handle<Texture>;
+
+  void destroy(Handle<Texture> handle);
+
+  auto get(Handle<Texture> handle) -> Texture&;
+
+  // Marks a texture as used this frame, keeping it eligible for streaming
+  // in and protecting it from eviction.
+  void touch(Handle<Texture> handle);
+
+  void bindDescriptor(Handle<Texture> handle,
+                      vk::DescriptorSet set,
+                      uint32_t binding,
+                      uint32_t arrayElement = 0);
+
+  // Splices in completed loads, enforces the budget and issues new load
+  // requests. Records GPU work into commandBuffer, which must be on a
+  // graphics-capable queue and outside of a render pass, and rewrites
+  // descriptors, so call it before descriptor sets are bound. Images
+  // replaced in the previous call are released here, so the previous frame
+  // must have completed.
+  void update(vk::CommandBuffer commandBuffer);
+
+  [[nodiscard]] auto getStats() const -> const Stats& { return stats; }
+
+  vk::Sampler sampler;
+
+  // Textures not touched for this many frames may lose their top levels
+  uint64_t evictionDelayFrames = 120;
+
+private:
+  struct LoadRequest
+  {
+    Handle<Texture> texture;
+    std::shared_ptr<const TextureSource> source;
+    uint32_t level = 0;
+  };
+
+  struct LoadResult
+  {
+    Handle<Texture> texture;
+    uint32_t level = 0;
+    std::vector<std::byte> pixels;
+  };
+
+  vk::Device& device;
+  VmaAllocator& allocator;
+  vk::DeviceSize residencyBudget;
+  uint32_t tailSize;
+
+  vk::Queue queue;
+  vk::CommandPool commandPool;
+  vk::CommandBuffer commandBuffer;
+  vk::Fence fence;
+
+  SlotMap<Texture> textures;
+  uint64_t frame = 0;
+  Stats stats;
+
+  std::vector<std::unique_ptr<DeviceImage>> retiredImages;
+  std::vector<std::unique_ptr<HostBuffer>> retiredStaging;
+
+  std::mutex mutex;
+  std::condition_variable_any condition;
+  std::deque<LoadRequest> requests;
+  std::vector<LoadResult> results;
+  std::jthread worker;
+
+  void load(const std::stop_token& stopToken);
+  void requestLevel(Handle<Texture> handle, Texture& texture);
+
+  // Reallocates the image to hold levels [newMip, levelCount), copying the
+  // levels both images share. topLevel, if not empty, holds the pixels of
+  // newMip when growing.
+  void resize(Texture& texture,
+              uint32_t newMip,
+              std::span<const std::byte> topLevel,
+              vk::CommandBuffer commandBuffer);
+
+  void evict(vk::CommandBuffer commandBuffer);
+
+  auto stage(std::span<const std::byte> bytes) -> HostBuffer&;
+  void submitImmediately(
+      const std::function<void(vk::CommandBuffer)>& record);
+};
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "mappedFile.hpp"
+
+#if defined(_WIN32)
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace
+{
+#if !defined(_WIN32)
+// madvise requires page-aligned addresses
+auto pageAlignedRange(const std::byte* base,
+                      size_t fileSize,
+                      size_t offset,
+                      size_t length) -> std::pair<void*, size_t>
+{
+  static const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+  const auto first = offset / pageSize * pageSize;
+  const auto last = std::min(offset + length, fileSize);
+  if (first >= last) {
+    return {nullptr, 0};
+  }
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  return {const_cast<std::byte*>(base + first), last - first};
+}
+#endif
+}  // namespace
+
+MappedFile::MappedFile(const std::string& path)
+{
+#if defined(_WIN32)
+  fileHandle = CreateFileA(path.c_str(),
+                           GENERIC_READ,
+                           FILE_SHARE_READ,
+                           nullptr,
+                           OPEN_EXISTING,
+                           FILE_FLAG_SEQUENTIAL_SCAN,
+                           nullptr);
+  if (fileHandle == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error(std::string("failed to open file: ") + path);
+  }
+
+  LARGE_INTEGER size;
+  GetFileSizeEx(fileHandle, &size);
+  fileSize = static_cast<size_t>(size.QuadPart);
+
+  if (fileSize > 0) {
+    mappingHandle =
+        CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr) {
+      CloseHandle(fileHandle);
+      throw std::runtime_error(std::string("failed to map file: ") + path);
+    }
+    mapping = static_cast<const std::byte*>(
+        MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+  }
+#else
+  fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor < 0) {
+    throw std::runtime_error(std::string("failed to open file: ") + path);
+  }
+
+  struct stat status {};
+  fstat(fileDescriptor, &status);
+  fileSize = static_cast<size_t>(status.st_size);
+
+  if (fileSize > 0) {
+    void* address =
+        mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (address == MAP_FAILED) {
+      close(fileDescriptor);
+      throw std::runtime_error(std::string("failed to map file: ") + path);
+    }
+    mapping = static_cast<const std::byte*>(address);
+  }
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#if defined(_WIN32)
+  if (mapping != nullptr) {
+    UnmapViewOfFile(mapping);
+  }
+  if (mappingHandle != nullptr) {
+    CloseHandle(mappingHandle);
+  }
+  CloseHandle(fileHandle);
+#else
+  if (mapping != nullptr) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    munmap(const_cast<std::byte*>(mapping), fileSize);
+  }
+  close(fileDescriptor);
+#endif
+}
+
+void MappedFile::adviseSequential() const
+{
+#if !defined(_WIN32)
+  const auto [address, length] = pageAlignedRange(mapping, fileSize, 0, fileSize);
+  if (address != nullptr) {
+    madvise(address, length, MADV_SEQUENTIAL);
+  }
+#endif
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const
+{
+#if defined(_WIN32)
+  if (offset >= fileSize) {
+    return;
+  }
+  WIN32_MEMORY_RANGE_ENTRY range {
+      .VirtualAddress = const_cast<std::byte*>(mapping + offset),
+      .NumberOfBytes = std::min(length, fileSize - offset)};
+  PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+  const auto [address, alignedLength] =
+      pageAlignedRange(mapping, fileSize, offset, length);
+  if (address != nullptr) {
+    madvise(address, alignedLength, MADV_WILLNEED);
+  }
+#endif
+}
+
+void MappedFile::release(size_t offset, size_t length) const
+{
+#if !defined(_WIN32)
+  const auto [address, alignedLength] =
+      pageAlignedRange(mapping, fileSize, offset, length);
+  if (address != nullptr) {
+    madvise(address, alignedLength, MADV_DONTNEED);
+  }
+#else
+  (void)offset;
+  (void)length;
+#endif
+}
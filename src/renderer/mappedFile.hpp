@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages are faulted in from disk
+// on first access, so a mapping can be far larger than available RAM.
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&&) = delete;
+  MappedFile& operator=(MappedFile&&) = delete;
+
+  [[nodiscard]] auto data() const -> const std::byte* { return mapping; }
+
+  [[nodiscard]] auto size() const -> size_t { return fileSize; }
+
+  [[nodiscard]] auto bytes() const -> std::span<const std::byte>
+  {
+    return {mapping, fileSize};
+  }
+
+  // Hints that the file will be read front to back, enabling aggressive
+  // readahead.
+  void adviseSequential() const;
+
+  // Asks the OS to start reading a range in the background.
+  void prefetch(size_t offset, size_t length) const;
+
+  // Lets the OS drop a range that has been consumed from the page cache.
+  void release(size_t offset, size_t length) const;
+
+private:
+  const std::byte* mapping = nullptr;
+  size_t fileSize = 0;
+
+#if defined(_WIN32)
+  void* fileHandle = nullptr;
+  void* mappingHandle = nullptr;
+#else
+  int fileDescriptor = -1;
+#endif
+};
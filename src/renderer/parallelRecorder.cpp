@@ -0,0 +1,102 @@
+#include <algorithm>
+
+#include "parallelRecorder.hpp"
+
+ParallelRecorder::ParallelRecorder(vk::Device& device,
+                                   uint32_t queueFamilyIndex,
+                                   TaskScheduler& scheduler,
+                                   uint32_t framesInFlight)
+    : device(device)
+    , scheduler(scheduler)
+{
+  frames.resize(framesInFlight);
+  for (auto& threads : frames) {
+    threads.resize(scheduler.threadCount());
+    for (auto& pool : threads) {
+      pool.commandPool = device.createCommandPool(
+          {.flags = vk::CommandPoolCreateFlagBits::eTransient,
+           .queueFamilyIndex = queueFamilyIndex});
+    }
+  }
+}
+
+ParallelRecorder::~ParallelRecorder()
+{
+  // Destroying a pool frees its command buffers
+  for (const auto& threads : frames) {
+    for (const auto& pool : threads) {
+      device.destroyCommandPool(pool.commandPool);
+    }
+  }
+}
+
+void ParallelRecorder::beginFrame()
+{
+  frame = (frame + 1) % static_cast<uint32_t>(frames.size());
+  for (auto& pool : frames[frame]) {
+    // Keeps the command buffers allocated, so steady state allocates nothing
+    device.resetCommandPool(pool.commandPool);
+    pool.used = 0;
+  }
+  stats.commandBuffers = 0;
+}
+
+auto ParallelRecorder::acquire(ThreadPool& pool) -> vk::CommandBuffer
+{
+  if (pool.used == pool.commandBuffers.size()) {
+    const vk::CommandBufferAllocateInfo allocateInfo {
+        .commandPool = pool.commandPool,
+        .level = vk::CommandBufferLevel::eSecondary,
+        .commandBufferCount = 1};
+    pool.commandBuffers.push_back(
+        device.allocateCommandBuffers(allocateInfo).front());
+  }
+  return pool.commandBuffers[pool.used++];
+}
+
+void ParallelRecorder::record(
+    vk::CommandBuffer primary,
+    std::size_t count,
+    std::size_t grain,
+    const RecordFunction& fn,
+    const vk::CommandBufferInheritanceRenderingInfo* rendering)
+{
+  if (count == 0) {
+    return;
+  }
+  grain = std::max<std::size_t>(grain, 1);
+  slices.assign((count + grain - 1) / grain, nullptr);
+
+  const vk::CommandBufferInheritanceInfo inheritance {.pNext = rendering};
+  vk::CommandBufferUsageFlags usage =
+      vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+  if (rendering != nullptr) {
+    usage |= vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+  }
+
+  // Slices are claimed in order but finish in any order; each writes only
+  // its own entry of slices
+  scheduler.parallelFor(
+      count,
+      grain,
+      [&](std::size_t first, std::size_t last)
+      {
+        auto& pool = frames[frame][TaskScheduler::currentThread()];
+        const auto commandBuffer = acquire(pool);
+        commandBuffer.begin(
+            {.flags = usage, .pInheritanceInfo = &inheritance});
+        fn(commandBuffer, first, last);
+        commandBuffer.end();
+        slices[first / grain] = commandBuffer;
+      });
+
+  primary.executeCommands(slices);
+
+  stats.commandBuffers += static_cast<uint32_t>(slices.size());
+  stats.allocated = 0;
+  for (const auto& threads : frames) {
+    for (const auto& pool : threads) {
+      stats.allocated += static_cast<uint32_t>(pool.commandBuffers.size());
+    }
+  }
+}
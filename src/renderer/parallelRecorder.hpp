@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include "../application/taskScheduler.hpp"
+
+// Records commands on a TaskScheduler into secondary command buffers.
+//
+// Every thread of the scheduler gets its own command pool per frame in
+// flight, so threads never share a pool and a frame's pools can be reset
+// wholesale once the GPU is done with them instead of freeing buffers one
+// by one. Work is split into slices that are each recorded into a separate
+// secondary command buffer, and the slices are executed into the primary
+// command buffer in their original order, so the result matches recording
+// everything on one thread.
+class ParallelRecorder
+{
+public:
+  // Records items [first, last) into commandBuffer, which has already been
+  // begun. Called concurrently for different slices.
+  using RecordFunction =
+      std::function<void(vk::CommandBuffer, std::size_t, std::size_t)>;
+
+  struct Stats
+  {
+    uint32_t commandBuffers = 0;  // Secondaries executed this frame
+    uint32_t allocated = 0;  // Secondaries kept across all pools
+  };
+
+  ParallelRecorder(vk::Device& device,
+                   uint32_t queueFamilyIndex,
+                   TaskScheduler& scheduler,
+                   uint32_t framesInFlight = 2);
+  ~ParallelRecorder();
+
+  ParallelRecorder(const ParallelRecorder&) = delete;
+  ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+  ParallelRecorder(ParallelRecorder&&) = delete;
+  ParallelRecorder& operator=(ParallelRecorder&&) = delete;
+
+  // Moves on to the next frame's pools and resets them. The GPU must have
+  // finished the commands recorded framesInFlight frames ago.
+  void beginFrame();
+
+  // Splits [0, count) into slices of at most grain items, records them in
+  // parallel and executes them into primary. Inside dynamic rendering begun
+  // with eContentsSecondaryCommandBuffers, pass the formats of the current
+  // attachments in rendering; outside of it, pass nullptr. Secondaries
+  // inherit no state, so fn must set the viewport, pipeline and descriptor
+  // sets it uses.
+  void record(vk::CommandBuffer primary,
+              std::size_t count,
+              std::size_t grain,
+              const RecordFunction& fn,
+              const vk::CommandBufferInheritanceRenderingInfo* rendering =
+                  nullptr);
+
+  [[nodiscard]] auto getStats() const -> const Stats& { return stats; }
+
+private:
+  struct ThreadPool
+  {
+    vk::CommandPool commandPool;
+    std::vector<vk::CommandBuffer> commandBuffers;
+    std::size_t used = 0;
+  };
+
+  vk::Device& device;
+  TaskScheduler& scheduler;
+  std::vector<std::vector<ThreadPool>> frames;  // [frame][thread]
+  uint32_t frame = 0;
+  Stats stats;
+
+  // One entry per slice of the current record() call
+  std::vector<vk::CommandBuffer> slices;
+
+  auto acquire(ThreadPool& pool) -> vk::CommandBuffer;
+};
@@ -0,0 +1,144 @@
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "prefixScan.hpp"
+
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "../shader.hpp"
+
+namespace
+{
+// Binding order of the globals in scan.slang
+enum Binding : uint32_t
+{
+  eInput,
+  eOutput,
+  eBlockSums,
+  eBindingCount,
+};
+}  // namespace
+
+PrefixScan::PrefixScan(Device& device,
+                       VmaAllocator& allocator,
+                       Compute& compute)
+    : device(device)
+    , allocator(allocator)
+    , compute(compute)
+{
+  std::vector<vk::DescriptorSetLayoutBinding> layoutBindings;
+  for (uint32_t binding = 0; binding < eBindingCount; binding++) {
+    layoutBindings.push_back(
+        {.binding = binding,
+         .descriptorType = vk::DescriptorType::eStorageBuffer,
+         .descriptorCount = 1,
+         .stageFlags = vk::ShaderStageFlagBits::eCompute});
+  }
+
+  auto createKernel = [&](const char* entryPoint) {
+    const auto shader = std::make_unique<Shader>(&device, "scan", entryPoint);
+    return compute.createKernel(
+        shader->getShaderStageCreateInfo(vk::ShaderStageFlagBits::eCompute),
+        layoutBindings,
+        sizeof(Params),
+        entryPoint);
+  };
+
+  reduceKernel = createKernel("reduce");
+  scanKernel = createKernel("scan");
+}
+
+PrefixScan::~PrefixScan()
+{
+  compute.destroyKernel(reduceKernel);
+  compute.destroyKernel(scanKernel);
+}
+
+void PrefixScan::exclusive(ComputeBatch& batch,
+                           Buffer& input,
+                           Buffer& output,
+                           uint32_t count)
+{
+  scan(batch, input, output, count, false, 0);
+}
+
+void PrefixScan::inclusive(ComputeBatch& batch,
+                           Buffer& input,
+                           Buffer& output,
+                           uint32_t count)
+{
+  scan(batch, input, output, count, true, 0);
+}
+
+void PrefixScan::scan(ComputeBatch& batch,
+                      Buffer& input,
+                      Buffer& output,
+                      uint32_t count,
+                      bool inclusive,
+                      size_t level)
+{
+  if (count == 0) {
+    return;
+  }
+
+  const auto groups = GroupCount::cover(count, tileSize);
+  const Params params {.count = count,
+                       .inclusive = inclusive ? 1U : 0U,
+                       .addBlockOffsets = groups.x > 1 ? 1U : 0U};
+
+  // A single tile needs no block offsets; blockSums is bound but unused
+  Buffer* offsets = &output;
+  if (groups.x > 1) {
+    auto& sums = blockSumsFor(level, groups.x);
+    batch.dispatch(reduceKernel,
+                   {{.binding = eInput,
+                     .buffer = &input,
+                     .access = BufferAccess::eRead},
+                    {.binding = eOutput,
+                     .buffer = &output,
+                     .access = BufferAccess::eRead},
+                    {.binding = eBlockSums,
+                     .buffer = &sums,
+                     .access = BufferAccess::eWrite}},
+                   groups,
+                   params);
+    scan(batch, sums, sums, groups.x, false, level + 1);
+    offsets = &sums;
+  }
+
+  batch.dispatch(scanKernel,
+                 {{.binding = eInput,
+                   .buffer = &input,
+                   .access = BufferAccess::eRead},
+                  {.binding = eOutput,
+                   .buffer = &output,
+                   .access = BufferAccess::eWrite},
+                  {.binding = eBlockSums,
+                   .buffer = offsets,
+                   .access = BufferAccess::eRead}},
+                 groups,
+                 params);
+}
+
+auto PrefixScan::blockSumsFor(size_t level, uint32_t blocks) -> DeviceBuffer&
+{
+  if (blockSums.size() <= level) {
+    blockSums.resize(level + 1);
+  }
+
+  auto& sums = blockSums[level];
+  const vk::DeviceSize size = blocks * sizeof(uint32_t);
+  if (!sums || sums->size < size) {
+    if (sums) {
+      compute.retire(std::move(sums));
+    }
+    sums = std::make_unique<DeviceBuffer>(
+        device.handle,
+        allocator,
+        size,
+        vk::BufferUsageFlagBits::eStorageBuffer);
+  }
+  return *sums;
+}
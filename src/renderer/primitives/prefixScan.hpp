@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "../buffers/buffer.hpp"
+#include "../buffers/deviceBuffer.hpp"
+#include "../compute.hpp"
+#include "../computeBatch.hpp"
+#include "../device.hpp"
+#include "vk_mem_alloc.h"
+
+// Exclusive and inclusive prefix sums of uint buffers.
+//
+// scan.slang reduces every tile of tileSize elements to a block sum, the
+// block sums are scanned recursively (one extra level per factor of
+// tileSize), and a second pass scans every tile from its block's offset:
+// two reads and one write of the data for any count.
+//
+// Block sums live in scratch buffers that only grow. Buffers replaced by
+// growth are released once the next Compute::submit() has completed, so a
+// batch recorded before a larger scan must not be submitted after it.
+class PrefixScan
+{
+public:
+  static constexpr uint32_t groupSize = 256;  // GROUP_SIZE in scan.slang
+  static constexpr uint32_t tileSize = 1024;  // TILE_SIZE in scan.slang
+
+  PrefixScan(Device& device, VmaAllocator& allocator, Compute& compute);
+  ~PrefixScan();
+
+  PrefixScan(const PrefixScan&) = delete;
+  PrefixScan& operator=(const PrefixScan&) = delete;
+  PrefixScan(PrefixScan&&) = delete;
+  PrefixScan& operator=(PrefixScan&&) = delete;
+
+  // output[i] = input[0] + ... + input[i - 1]. output may be input.
+  void exclusive(ComputeBatch& batch,
+                 Buffer& input,
+                 Buffer& output,
+                 uint32_t count);
+
+  // output[i] = input[0] + ... + input[i]. output may be input.
+  void inclusive(ComputeBatch& batch,
+                 Buffer& input,
+                 Buffer& output,
+                 uint32_t count);
+
+private:
+  // Matches Params in scan.slang
+  struct Params
+  {
+    uint32_t count;
+    uint32_t inclusive;
+    uint32_t addBlockOffsets;
+  };
+
+  Device& device;
+  VmaAllocator& allocator;
+  Compute& compute;
+
+  KernelHandle reduceKernel;
+  KernelHandle scanKernel;
+
+  // Block sums of each recursion level
+  std::vector<std::unique_ptr<DeviceBuffer>> blockSums;
+
+  void scan(ComputeBatch& batch,
+            Buffer& input,
+            Buffer& output,
+            uint32_t count,
+            bool inclusive,
+            size_t level);
+  auto blockSumsFor(size_t level, uint32_t blocks) -> DeviceBuffer&;
+};
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "radixSort.hpp"
+
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "../shader.hpp"
+
+namespace
+{
+// Binding order of the globals in radixSort.slang
+enum Binding : uint32_t
+{
+  eKeysIn,
+  eValuesIn,
+  eKeysOut,
+  eValuesOut,
+  eGlobalHistogram,
+  eTileStatus,
+  eTileCounters,
+  eBindingCount,
+};
+}  // namespace
+
+RadixSort::RadixSort(Device& device, VmaAllocator& allocator, Compute& compute)
+    : device(device)
+    , allocator(allocator)
+    , compute(compute)
+{
+  const auto storage = vk::BufferUsageFlagBits::eStorageBuffer;
+  globalHistogram = std::make_unique<DeviceBuffer>(
+      device.handle, allocator, maxPasses * radix * sizeof(uint32_t), storage);
+  tileCounters = std::make_unique<DeviceBuffer>(
+      device.handle, allocator, maxPasses * sizeof(uint32_t), storage);
+
+  std::vector<vk::DescriptorSetLayoutBinding> layoutBindings;
+  for (uint32_t binding = 0; binding < eBindingCount; binding++) {
+    layoutBindings.push_back(
+        {.binding = binding,
+         .descriptorType = vk::DescriptorType::eStorageBuffer,
+         .descriptorCount = 1,
+         .stageFlags = vk::ShaderStageFlagBits::eCompute});
+  }
+
+  auto createKernel = [&](const char* entryPoint) {
+    const auto shader =
+        std::make_unique<Shader>(&device, "radixSort", entryPoint);
+    return compute.createKernel(
+        shader->getShaderStageCreateInfo(vk::ShaderStageFlagBits::eCompute),
+        layoutBindings,
+        sizeof(Params),
+        entryPoint);
+  };
+
+  histogramKernel = createKernel("histogram");
+  scanHistogramKernel = createKernel("scanHistogram");
+  onesweepKernel = createKernel("onesweep");
+}
+
+RadixSort::~RadixSort()
+{
+  compute.destroyKernel(histogramKernel);
+  compute.destroyKernel(scanHistogramKernel);
+  compute.destroyKernel(onesweepKernel);
+}
+
+void RadixSort::sort(ComputeBatch& batch,
+                     Buffer& keys,
+                     Buffer& values,
+                     uint32_t count,
+                     uint32_t keyBits)
+{
+  if (count <= 1 || keyBits == 0) {
+    return;
+  }
+
+  reserve(count);
+
+  const auto passCount =
+      std::min((keyBits + bitsPerPass - 1) / bitsPerPass, maxPasses);
+  const auto tiles = GroupCount::cover(count, tileSize);
+  const vk::DeviceSize statusSize =
+      static_cast<vk::DeviceSize>(tiles.x) * radix * sizeof(uint32_t);
+
+  Buffer* keysIn = &keys;
+  Buffer* valuesIn = &values;
+  Buffer* keysOut = scratchKeys.get();
+  Buffer* valuesOut = scratchValues.get();
+
+  auto bindings = [&]() -> std::vector<KernelBinding> {
+    return {{.binding = eKeysIn,
+             .buffer = keysIn,
+             .access = BufferAccess::eRead},
+            {.binding = eValuesIn,
+             .buffer = valuesIn,
+             .access = BufferAccess::eRead},
+            {.binding = eKeysOut,
+             .buffer = keysOut,
+             .access = BufferAccess::eWrite},
+            {.binding = eValuesOut,
+             .buffer = valuesOut,
+             .access = BufferAccess::eWrite},
+            {.binding = eGlobalHistogram, .buffer = globalHistogram.get()},
+            {.binding = eTileStatus, .buffer = tileStatus.get()},
+            {.binding = eTileCounters, .buffer = tileCounters.get()}};
+  };
+
+  Params params {.count = count, .passCount = passCount, .pass = 0};
+
+  batch.fill(*globalHistogram, 0).fill(*tileCounters, 0);
+  batch.dispatch(histogramKernel, bindings(), tiles, params)
+      .dispatch(scanHistogramKernel, bindings(), {.x = passCount}, params);
+
+  for (uint32_t pass = 0; pass < passCount; pass++) {
+    params.pass = pass;
+
+    // Look-back only trusts status words written during this pass
+    batch.fill(*tileStatus, 0, 0, statusSize);
+    batch.dispatch(onesweepKernel, bindings(), tiles, params);
+
+    std::swap(keysIn, keysOut);
+    std::swap(valuesIn, valuesOut);
+  }
+
+  // An odd number of passes leaves the result in the scratch buffers
+  if (keysIn != &keys) {
+    const vk::DeviceSize size = count * sizeof(uint32_t);
+    batch.copy(*keysIn, keys, size).copy(*valuesIn, values, size);
+  }
+}
+
+void RadixSort::reserve(uint32_t count)
+{
+  const vk::DeviceSize elements = count * sizeof(uint32_t);
+  const vk::DeviceSize status =
+      static_cast<vk::DeviceSize>(GroupCount::cover(count, tileSize).x)
+      * radix * sizeof(uint32_t);
+
+  grow(scratchKeys, elements);
+  grow(scratchValues, elements);
+  grow(tileStatus, status);
+}
+
+void RadixSort::grow(std::unique_ptr<DeviceBuffer>& buffer,
+                     vk::DeviceSize size)
+{
+  if (!buffer || buffer->size < size) {
+    if (buffer) {
+      compute.retire(std::move(buffer));
+    }
+    buffer = std::make_unique<DeviceBuffer>(
+        device.handle,
+        allocator,
+        size,
+        vk::BufferUsageFlagBits::eStorageBuffer);
+  }
+}
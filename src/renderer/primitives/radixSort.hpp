@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include <vulkan/vulkan.hpp>
+
+#include "../buffers/buffer.hpp"
+#include "../buffers/deviceBuffer.hpp"
+#include "../compute.hpp"
+#include "../computeBatch.hpp"
+#include "../device.hpp"
+#include "vk_mem_alloc.h"
+
+// Stable key-value radix sort of uint keys and uint values, eight bits per
+// pass.
+//
+// radixSort.slang follows Onesweep: one histogram pass over the keys
+// produces the digit offsets for every pass, and each sorting pass then
+// reads and scatters the keys exactly once, chaining tile offsets through a
+// decoupled look-back instead of a separate scan. That is about 2 + 2 *
+// passes memory passes per sort, against 3 per pass for reduce-then-scan.
+//
+// Scratch buffers only grow; buffers replaced by growth are released once
+// the next Compute::submit() has completed, so a batch recorded before a
+// larger sort must not be submitted after it.
+class RadixSort
+{
+public:
+  static constexpr uint32_t groupSize = 256;  // GROUP_SIZE in radixSort.slang
+  static constexpr uint32_t tileSize = 1024;  // TILE_SIZE in radixSort.slang
+  static constexpr uint32_t radix = 256;
+  static constexpr uint32_t bitsPerPass = 8;
+  static constexpr uint32_t maxPasses = 4;
+
+  RadixSort(Device& device, VmaAllocator& allocator, Compute& compute);
+  ~RadixSort();
+
+  RadixSort(const RadixSort&) = delete;
+  RadixSort& operator=(const RadixSort&) = delete;
+  RadixSort(RadixSort&&) = delete;
+  RadixSort& operator=(RadixSort&&) = delete;
+
+  // Sorts the first count pairs ascending by the low keyBits bits of their
+  // keys, keeping the order of equal keys. The result is left in keys and
+  // values; bits above keyBits must be zero.
+  void sort(ComputeBatch& batch,
+            Buffer& keys,
+            Buffer& values,
+            uint32_t count,
+            uint32_t keyBits = 32);
+
+private:
+  // Matches Params in radixSort.slang
+  struct Params
+  {
+    uint32_t count;
+    uint32_t passCount;
+    uint32_t pass;
+  };
+
+  Device& device;
+  VmaAllocator& allocator;
+  Compute& compute;
+
+  KernelHandle histogramKernel;
+  KernelHandle scanHistogramKernel;
+  KernelHandle onesweepKernel;
+
+  std::unique_ptr<DeviceBuffer> scratchKeys;
+  std::unique_ptr<DeviceBuffer> scratchValues;
+  std::unique_ptr<DeviceBuffer> globalHistogram;
+  std::unique_ptr<DeviceBuffer> tileStatus;
+  std::unique_ptr<DeviceBuffer> tileCounters;
+
+  void reserve(uint32_t count);
+  void grow(std::unique_ptr<DeviceBuffer>& buffer, vk::DeviceSize size);
+};
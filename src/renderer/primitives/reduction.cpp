@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "reduction.hpp"
+
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "../shader.hpp"
+
+namespace
+{
+// Binding order of the globals in reduce.slang
+enum Binding : uint32_t
+{
+  eInput,
+  eResult,
+  eBindingCount,
+};
+}  // namespace
+
+Reduction::Reduction(Device& device, Compute& compute, bool preferSubgroups)
+    : compute(compute)
+{
+  useSubgroups = preferSubgroups
+      && device.subgroup.supports(vk::ShaderStageFlagBits::eCompute,
+                                  vk::SubgroupFeatureFlagBits::eBasic
+                                      | vk::SubgroupFeatureFlagBits::eVote
+                                      | vk::SubgroupFeatureFlagBits::eArithmetic
+                                      | vk::SubgroupFeatureFlagBits::eBallot);
+
+  std::vector<vk::DescriptorSetLayoutBinding> layoutBindings;
+  for (uint32_t binding = 0; binding < eBindingCount; binding++) {
+    layoutBindings.push_back(
+        {.binding = binding,
+         .descriptorType = vk::DescriptorType::eStorageBuffer,
+         .descriptorCount = 1,
+         .stageFlags = vk::ShaderStageFlagBits::eCompute});
+  }
+
+  // The shared memory entry points carry a "Shared" suffix
+  auto createKernel = [&](const std::string& name) {
+    const auto entryPoint = useSubgroups ? name : name + "Shared";
+    const auto shader =
+        std::make_unique<Shader>(&device, "reduce", entryPoint);
+    auto stage =
+        shader->getShaderStageCreateInfo(vk::ShaderStageFlagBits::eCompute);
+    if (useSubgroups && device.features.computeFullSubgroups) {
+      stage.flags |=
+          vk::PipelineShaderStageCreateFlagBits::eRequireFullSubgroups;
+    }
+    return compute.createKernel(
+        stage, layoutBindings, sizeof(Params), entryPoint);
+  };
+
+  reduceKernel = createKernel("reduce");
+  histogramKernel = createKernel("histogram");
+}
+
+Reduction::~Reduction()
+{
+  compute.destroyKernel(reduceKernel);
+  compute.destroyKernel(histogramKernel);
+}
+
+void Reduction::reduce(ComputeBatch& batch,
+                       Buffer& input,
+                       uint32_t count,
+                       ReduceOp op,
+                       Buffer& result)
+{
+  // Groups fold into result atomically, starting from the identity
+  batch.fill(result,
+             op == ReduceOp::eMin ? 0xffffffffU : 0U,
+             0,
+             sizeof(uint32_t));
+
+  const auto groups = groupsFor(count);
+  batch.dispatch(reduceKernel,
+                 {{.binding = eInput,
+                   .buffer = &input,
+                   .access = BufferAccess::eRead},
+                  {.binding = eResult, .buffer = &result}},
+                 {.x = groups},
+                 Params {.count = count,
+                         .op = static_cast<uint32_t>(op),
+                         .groupCount = groups});
+}
+
+void Reduction::histogram(ComputeBatch& batch,
+                          Buffer& input,
+                          uint32_t count,
+                          uint32_t binCount,
+                          Buffer& bins)
+{
+  if (binCount == 0 || binCount > maxBins
+      || (binCount & (binCount - 1)) != 0)
+  {
+    throw std::runtime_error(
+        "Histogram bin count must be a power of two up to 256.");
+  }
+
+  batch.fill(bins, 0, 0, binCount * sizeof(uint32_t));
+
+  const auto groups = groupsFor(count);
+  batch.dispatch(histogramKernel,
+                 {{.binding = eInput,
+                   .buffer = &input,
+                   .access = BufferAccess::eRead},
+                  {.binding = eResult, .buffer = &bins}},
+                 {.x = groups},
+                 Params {.count = count, .op = binCount, .groupCount = groups});
+}
+
+auto Reduction::groupsFor(uint32_t count) -> uint32_t
+{
+  // Each thread loads four elements per iteration
+  const auto vectors = (count + 3) / 4;
+  return std::clamp(GroupCount::cover(vectors, groupSize).x, 1U, maxGroups);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+#include <vulkan/vulkan.hpp>
+
+#include "../buffers/buffer.hpp"
+#include "../compute.hpp"
+#include "../computeBatch.hpp"
+#include "../device.hpp"
+
+enum class ReduceOp : uint32_t
+{
+  eSum,
+  eMin,
+  eMax,
+};
+
+// Single-dispatch reductions and histograms of uint buffers.
+//
+// reduce.slang combines within each group with wave intrinsics when the
+// device supports arithmetic and ballot subgroup operations in compute
+// shaders, and with a shared memory tree otherwise. The variants are
+// separate entry points, so devices without those operations never load a
+// module that declares them. Subgroup kernels request full subgroups when
+// computeFullSubgroups is available, so every wave of a group is complete.
+class Reduction
+{
+public:
+  static constexpr uint32_t groupSize = 256;  // GROUP_SIZE in reduce.slang
+  static constexpr uint32_t maxBins = groupSize;
+
+  // preferSubgroups = false forces the shared memory variant, e.g. to
+  // compare the two
+  Reduction(Device& device, Compute& compute, bool preferSubgroups = true);
+  ~Reduction();
+
+  Reduction(const Reduction&) = delete;
+  Reduction& operator=(const Reduction&) = delete;
+  Reduction(Reduction&&) = delete;
+  Reduction& operator=(Reduction&&) = delete;
+
+  // Combines the first count elements of input into result[0]
+  void reduce(ComputeBatch& batch,
+              Buffer& input,
+              uint32_t count,
+              ReduceOp op,
+              Buffer& result);
+
+  // Counts the first count elements of input into binCount bins by their
+  // low bits. binCount must be a power of two no larger than maxBins.
+  void histogram(ComputeBatch& batch,
+                 Buffer& input,
+                 uint32_t count,
+                 uint32_t binCount,
+                 Buffer& bins);
+
+  [[nodiscard]] auto usesSubgroups() const -> bool { return useSubgroups; }
+
+private:
+  // Matches Params in reduce.slang
+  struct Params
+  {
+    uint32_t count;
+    uint32_t op;
+    uint32_t groupCount;
+  };
+
+  // Enough groups to fill any current GPU; each strides over the rest
+  static constexpr uint32_t maxGroups = 1024;
+
+  Compute& compute;
+  bool useSubgroups = false;
+
+  KernelHandle reduceKernel;
+  KernelHandle histogramKernel;
+
+  static auto groupsFor(uint32_t count) -> uint32_t;
+};
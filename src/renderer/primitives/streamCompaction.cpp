@@ -0,0 +1,100 @@
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "streamCompaction.hpp"
+
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "../shader.hpp"
+
+namespace
+{
+// Binding order of the globals in compact.slang
+enum Binding : uint32_t
+{
+  eInput,
+  eFlags,
+  eOffsets,
+  eOutput,
+  eKeptCount,
+  eBindingCount,
+};
+}  // namespace
+
+StreamCompaction::StreamCompaction(Device& device,
+                                   VmaAllocator& allocator,
+                                   Compute& compute)
+    : device(device)
+    , allocator(allocator)
+    , compute(compute)
+    , scan(device, allocator, compute)
+{
+  std::vector<vk::DescriptorSetLayoutBinding> layoutBindings;
+  for (uint32_t binding = 0; binding < eBindingCount; binding++) {
+    layoutBindings.push_back(
+        {.binding = binding,
+         .descriptorType = vk::DescriptorType::eStorageBuffer,
+         .descriptorCount = 1,
+         .stageFlags = vk::ShaderStageFlagBits::eCompute});
+  }
+
+  const auto shader = std::make_unique<Shader>(&device, "compact", "main");
+  scatterKernel = compute.createKernel(
+      shader->getShaderStageCreateInfo(vk::ShaderStageFlagBits::eCompute),
+      layoutBindings,
+      sizeof(Params),
+      "compact");
+}
+
+StreamCompaction::~StreamCompaction()
+{
+  compute.destroyKernel(scatterKernel);
+}
+
+void StreamCompaction::compact(ComputeBatch& batch,
+                               Buffer& input,
+                               Buffer& flags,
+                               Buffer& output,
+                               Buffer& keptCount,
+                               uint32_t count)
+{
+  if (count == 0) {
+    batch.fill(keptCount, 0, 0, sizeof(uint32_t));
+    return;
+  }
+
+  // Slot of every element among the kept ones
+  const vk::DeviceSize size = count * sizeof(uint32_t);
+  if (!offsets || offsets->size < size) {
+    if (offsets) {
+      compute.retire(std::move(offsets));
+    }
+    offsets = std::make_unique<DeviceBuffer>(
+        device.handle,
+        allocator,
+        size,
+        vk::BufferUsageFlagBits::eStorageBuffer);
+  }
+  scan.exclusive(batch, flags, *offsets, count);
+
+  batch.dispatch(scatterKernel,
+                 {{.binding = eInput,
+                   .buffer = &input,
+                   .access = BufferAccess::eRead},
+                  {.binding = eFlags,
+                   .buffer = &flags,
+                   .access = BufferAccess::eRead},
+                  {.binding = eOffsets,
+                   .buffer = offsets.get(),
+                   .access = BufferAccess::eRead},
+                  {.binding = eOutput,
+                   .buffer = &output,
+                   .access = BufferAccess::eWrite},
+                  {.binding = eKeptCount,
+                   .buffer = &keptCount,
+                   .access = BufferAccess::eWrite}},
+                 GroupCount::cover(count, groupSize),
+                 Params {.count = count});
+}
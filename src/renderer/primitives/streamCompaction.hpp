@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include <vulkan/vulkan.hpp>
+
+#include "../buffers/buffer.hpp"
+#include "../buffers/deviceBuffer.hpp"
+#include "../compute.hpp"
+#include "../computeBatch.hpp"
+#include "../device.hpp"
+#include "prefixScan.hpp"
+#include "vk_mem_alloc.h"
+
+// Order-preserving stream compaction of uint buffers: an exclusive scan of
+// the keep flags gives every kept element its output slot, and
+// compact.slang scatters them there.
+class StreamCompaction
+{
+public:
+  static constexpr uint32_t groupSize = 256;  // GROUP_SIZE in compact.slang
+
+  StreamCompaction(Device& device, VmaAllocator& allocator, Compute& compute);
+  ~StreamCompaction();
+
+  StreamCompaction(const StreamCompaction&) = delete;
+  StreamCompaction& operator=(const StreamCompaction&) = delete;
+  StreamCompaction(StreamCompaction&&) = delete;
+  StreamCompaction& operator=(StreamCompaction&&) = delete;
+
+  // Packs every input[i] whose flags[i] is 1 to the front of output, in
+  // order, and writes how many were kept to keptCount[0]. Flags must be 0
+  // or 1 and output must not alias input.
+  void compact(ComputeBatch& batch,
+               Buffer& input,
+               Buffer& flags,
+               Buffer& output,
+               Buffer& keptCount,
+               uint32_t count);
+
+private:
+  // Matches Params in compact.slang
+  struct Params
+  {
+    uint32_t count;
+  };
+
+  Device& device;
+  VmaAllocator& allocator;
+  Compute& compute;
+  PrefixScan scan;
+
+  KernelHandle scatterKernel;
+
+  std::unique_ptr<DeviceBuffer> offsets;
+};
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <utility>
+
+#include "renderQueue.hpp"
+
+namespace
+{
+
+constexpr uint32_t radixBits = 8;
+constexpr uint32_t radixSize = 1U << radixBits;
+constexpr uint32_t radixPasses = 64 / radixBits;
+
+void recordDraw(vk::CommandBuffer commandBuffer, const DrawCommand& command)
+{
+  switch (command.type) {
+    case DrawCommand::Type::eDraw:
+      commandBuffer.draw(command.count,
+                         command.instanceCount,
+                         command.first,
+                         command.firstInstance);
+      break;
+    case DrawCommand::Type::eDrawIndexed:
+      commandBuffer.drawIndexed(command.count,
+                                command.instanceCount,
+                                command.first,
+                                command.vertexOffset,
+                                command.firstInstance);
+      break;
+    case DrawCommand::Type::eDrawIndirect:
+      commandBuffer.drawIndirect(command.arguments,
+                                 command.argumentsOffset,
+                                 command.count,
+                                 command.stride);
+      break;
+    case DrawCommand::Type::eDrawIndexedIndirect:
+      commandBuffer.drawIndexedIndirect(command.arguments,
+                                        command.argumentsOffset,
+                                        command.count,
+                                        command.stride);
+      break;
+    case DrawCommand::Type::eDrawIndexedIndirectCount:
+      commandBuffer.drawIndexedIndirectCount(command.arguments,
+                                             command.argumentsOffset,
+                                             command.countBuffer,
+                                             command.countOffset,
+                                             command.count,
+                                             command.stride);
+      break;
+  }
+}
+
+}  // namespace
+
+auto RenderQueue::makeKey(uint8_t pass,
+                          PipelineHandle pipeline,
+                          uint16_t material,
+                          float depth) -> uint64_t
+{
+  constexpr uint64_t depthMax = (uint64_t {1} << depthBits) - 1;
+  const float clamped = std::clamp(depth, 0.0F, 1.0F);
+  const auto quantizedDepth = static_cast<uint64_t>(
+      std::lround(clamped * static_cast<float>(depthMax)));
+
+  // Pipelines are told apart by slot index; live handles never share one
+  const uint64_t pipelineIndex =
+      pipeline.index & ((uint64_t {1} << pipelineBits) - 1);
+
+  return (static_cast<uint64_t>(pass) << (64 - passBits))
+      | (pipelineIndex << (materialBits + depthBits))
+      | (static_cast<uint64_t>(material) << depthBits) | quantizedDepth;
+}
+
+void RenderQueue::clear()
+{
+  items.clear();
+  order.clear();
+
+  draws = 0;
+  pipelineBinds = 0;
+  descriptorSetBinds = 0;
+  vertexBufferBinds = 0;
+  indexBufferBinds = 0;
+  bindsSaved = 0;
+}
+
+void RenderQueue::sort()
+{
+  order.resize(items.size());
+  for (std::size_t i = 0; i < items.size(); i++) {
+    order[i] = {.key = items[i].key, .item = static_cast<uint32_t>(i)};
+  }
+  if (order.size() < 2) {
+    return;
+  }
+
+  // All digit histograms in one read of the keys
+  std::array<std::array<uint32_t, radixSize>, radixPasses> counts {};
+  for (const auto& entry : order) {
+    for (uint32_t pass = 0; pass < radixPasses; pass++) {
+      counts[pass][(entry.key >> (pass * radixBits)) & (radixSize - 1)]++;
+    }
+  }
+
+  scratch.resize(order.size());
+  for (uint32_t pass = 0; pass < radixPasses; pass++) {
+    const uint32_t shift = pass * radixBits;
+    auto& histogram = counts[pass];
+
+    // A digit every key shares would not move anything
+    const auto firstDigit = (order.front().key >> shift) & (radixSize - 1);
+    if (histogram[firstDigit] == order.size()) {
+      continue;
+    }
+
+    uint32_t offset = 0;
+    for (auto& count : histogram) {
+      offset += std::exchange(count, offset);
+    }
+    for (const auto& entry : order) {
+      scratch[histogram[(entry.key >> shift) & (radixSize - 1)]++] = entry;
+    }
+    std::swap(order, scratch);
+  }
+}
+
+void RenderQueue::record(vk::CommandBuffer commandBuffer,
+                         const SlotMap<vk::Pipeline>& pipelines,
+                         vk::PipelineLayout layout,
+                         std::size_t first,
+                         std::size_t last)
+{
+  Stats local;
+  uint32_t naiveBinds = 0;
+
+  // What is bound in commandBuffer; nothing yet
+  PipelineHandle pipeline;
+  vk::DescriptorSet descriptorSet;
+  std::array<vk::Buffer, DrawItem::maxVertexBuffers> vertexBuffers {};
+  vk::Buffer indexBuffer;
+  vk::IndexType indexType = vk::IndexType::eUint32;
+
+  for (std::size_t i = first; i < last; i++) {
+    const DrawItem& item = items[order[i].item];
+
+    if (item.pipeline.isValid()) {
+      naiveBinds++;
+      if (item.pipeline != pipeline) {
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                                   pipelines.get(item.pipeline));
+        pipeline = item.pipeline;
+        local.pipelineBinds++;
+      }
+    }
+
+    if (item.descriptorSet) {
+      naiveBinds++;
+      if (item.descriptorSet != descriptorSet) {
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                         layout,
+                                         0,
+                                         item.descriptorSet,
+                                         {});
+        descriptorSet = item.descriptorSet;
+        local.descriptorSetBinds++;
+      }
+    }
+
+    // One call per run of consecutive bindings that changed
+    const std::array<vk::DeviceSize, DrawItem::maxVertexBuffers> offsets {};
+    uint32_t binding = 0;
+    while (binding < DrawItem::maxVertexBuffers) {
+      const auto changed = [&](uint32_t b)
+      {
+        return item.vertexBuffers[b]
+            && item.vertexBuffers[b] != vertexBuffers[b];
+      };
+      if (!changed(binding)) {
+        binding++;
+        continue;
+      }
+      uint32_t end = binding + 1;
+      while (end < DrawItem::maxVertexBuffers && changed(end)) {
+        end++;
+      }
+      const auto buffers =
+          std::span(item.vertexBuffers).subspan(binding, end - binding);
+      commandBuffer.bindVertexBuffers(
+          binding, buffers, std::span(offsets).first(buffers.size()));
+      std::ranges::copy(buffers, vertexBuffers.begin() + binding);
+      local.vertexBufferBinds++;
+      binding = end;
+    }
+    if (std::ranges::any_of(item.vertexBuffers,
+                            [](vk::Buffer buffer) { return bool(buffer); }))
+    {
+      naiveBinds++;
+    }
+
+    if (item.indexBuffer) {
+      naiveBinds++;
+      if (item.indexBuffer != indexBuffer || item.indexType != indexType) {
+        commandBuffer.bindIndexBuffer(item.indexBuffer, 0, item.indexType);
+        indexBuffer = item.indexBuffer;
+        indexType = item.indexType;
+        local.indexBufferBinds++;
+      }
+    }
+
+    recordDraw(commandBuffer, item.command);
+    local.draws++;
+  }
+
+  const uint32_t binds = local.pipelineBinds + local.descriptorSetBinds
+      + local.vertexBufferBinds + local.indexBufferBinds;
+  draws += local.draws;
+  pipelineBinds += local.pipelineBinds;
+  descriptorSetBinds += local.descriptorSetBinds;
+  vertexBufferBinds += local.vertexBufferBinds;
+  indexBufferBinds += local.indexBufferBinds;
+  bindsSaved += naiveBinds - binds;
+}
+
+auto RenderQueue::getStats() const -> Stats
+{
+  return {.draws = draws.load(),
+          .pipelineBinds = pipelineBinds.load(),
+          .descriptorSetBinds = descriptorSetBinds.load(),
+          .vertexBufferBinds = vertexBufferBinds.load(),
+          .indexBufferBinds = indexBufferBinds.load(),
+          .bindsSaved = bindsSaved.load()};
+}
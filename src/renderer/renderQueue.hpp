@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "executor.hpp"
+#include "slotMap.hpp"
+
+// The draw call itself, without any state
+struct DrawCommand
+{
+  enum class Type : uint8_t
+  {
+    eDraw,
+    eDrawIndexed,
+    eDrawIndirect,
+    eDrawIndexedIndirect,
+    eDrawIndexedIndirectCount,
+  };
+
+  Type type = Type::eDraw;
+
+  // Vertices or indices; for indirect draws the (maximum) number of draws
+  uint32_t count = 0;
+  uint32_t instanceCount = 1;
+  uint32_t first = 0;  // Vertex or index
+  int32_t vertexOffset = 0;
+  uint32_t firstInstance = 0;
+
+  vk::Buffer arguments;
+  vk::DeviceSize argumentsOffset = 0;
+  uint32_t stride = 0;
+  vk::Buffer countBuffer;
+  vk::DeviceSize countOffset = 0;
+};
+
+// One draw and all the state it needs. Null handles are left unbound.
+// Vertex and index buffers are bound at offset 0.
+struct DrawItem
+{
+  static constexpr uint32_t maxVertexBuffers = 2;
+
+  uint64_t key = 0;
+  PipelineHandle pipeline;
+  vk::DescriptorSet descriptorSet;
+  std::array<vk::Buffer, maxVertexBuffers> vertexBuffers {};
+  vk::Buffer indexBuffer;
+  vk::IndexType indexType = vk::IndexType::eUint32;
+  DrawCommand command;
+};
+
+// Draws submitted in any order and recorded in sort key order.
+//
+// Keys put the pass in the top bits, then the pipeline, the material and
+// the depth, so sorting groups draws that share state and record() only
+// binds what differs from the previous draw. Keys are sorted with an LSD
+// radix sort, which skips the digits all keys share; with few passes and
+// pipelines that is most of them.
+//
+// record() can be called for disjoint ranges from several threads. Each
+// call starts from unknown state, since secondary command buffers do not
+// inherit any.
+class RenderQueue
+{
+public:
+  struct Stats
+  {
+    uint32_t draws = 0;
+    uint32_t pipelineBinds = 0;
+    uint32_t descriptorSetBinds = 0;
+    uint32_t vertexBufferBinds = 0;
+    uint32_t indexBufferBinds = 0;
+    // Compared to binding every draw's state
+    uint32_t bindsSaved = 0;
+  };
+
+  // Key layout, from the most significant bit
+  static constexpr uint32_t passBits = 8;
+  static constexpr uint32_t pipelineBits = 16;
+  static constexpr uint32_t materialBits = 16;
+  static constexpr uint32_t depthBits = 24;
+
+  // depth is clamped to [0, 1] and sorts front to back; pass 1 - depth to
+  // sort back to front
+  static auto makeKey(uint8_t pass,
+                      PipelineHandle pipeline,
+                      uint16_t material,
+                      float depth) -> uint64_t;
+
+  RenderQueue() = default;
+  ~RenderQueue() = default;
+
+  RenderQueue(const RenderQueue&) = delete;
+  RenderQueue& operator=(const RenderQueue&) = delete;
+  RenderQueue(RenderQueue&&) = delete;
+  RenderQueue& operator=(RenderQueue&&) = delete;
+
+  // Forgets the previous frame's draws and stats
+  void clear();
+
+  void submit(const DrawItem& item) { items.push_back(item); }
+
+  [[nodiscard]] auto size() const -> std::size_t { return items.size(); }
+
+  void sort();
+
+  // Records sorted draws [first, last). Descriptor sets are bound to set 0
+  // of layout, which all pipelines must share.
+  void record(vk::CommandBuffer commandBuffer,
+              const SlotMap<vk::Pipeline>& pipelines,
+              vk::PipelineLayout layout,
+              std::size_t first,
+              std::size_t last);
+
+  [[nodiscard]] auto getStats() const -> Stats;
+
+private:
+  struct SortEntry
+  {
+    uint64_t key;
+    uint32_t item;
+  };
+
+  std::vector<DrawItem> items;  // In submission order
+  std::vector<SortEntry> order;
+  std::vector<SortEntry> scratch;
+
+  std::atomic<uint32_t> draws = 0;
+  std::atomic<uint32_t> pipelineBinds = 0;
+  std::atomic<uint32_t> descriptorSetBinds = 0;
+  std::atomic<uint32_t> vertexBufferBinds = 0;
+  std::atomic<uint32_t> indexBufferBinds = 0;
+  std::atomic<uint32_t> bindsSaved = 0;
+};
@@ -1,8 +1,15 @@
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>
 #include <memory>
+#include <numbers>
+#include <random>
 #include <ranges>
+#include <span>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -11,6 +18,7 @@
 
 #include <fmt/base.h>
 #include <fmt/ranges.h>
+#include <glm/gtc/matrix_transform.hpp>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_enums.hpp>
 #include <vulkan/vulkan_structs.hpp>
@@ -18,6 +26,8 @@
 #include "buffers/deviceBuffer.hpp"
 #include "buffers/hostBuffer.hpp"
 #include "graphics.hpp"
+#include "images/proceduralTextures.hpp"
+#include "scene/frustum.hpp"
 #include "shader.hpp"
 #include "validation.hpp"
 
@@ -25,10 +35,14 @@
 VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
 #endif
 
-Renderer::Renderer(std::string name, Window* window, Game& game)
+Renderer::Renderer(std::string name,
+                   Window* window,
+                   Game& game,
+                   TaskScheduler& scheduler)
     : appName(std::move(name))
     , window(window)
     , game(game)
+    , scheduler(scheduler)
     , allocator(nullptr) {};
 
 Renderer::~Renderer()
@@ -36,17 +50,61 @@ Renderer::~Renderer()
   cleanup();
 }
 
-[[noreturn]] void Renderer::run()
+void Renderer::run(EventPump& events)
 {
   initVulkan();
+  loadAssets();
   initCompute();
   initGraphics();
 
-  while (true) {
+  // Frames are paced to frameTime, which the GPU simulations step by. Input
+  // is pumped right before each frame, so it waits at most one frame.
+  using Clock = std::chrono::steady_clock;
+  const auto framePeriod =
+      std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<float>(frameTime));
+  auto nextFrame = Clock::now();
+  while (events.pump()) {
+    scheduler.runMainThreadTasks();
     update();
     draw();
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // All work for the frame has completed, so buffers can be moved
+    defragmenter->step();
+
+    nextFrame = std::max(nextFrame + framePeriod, Clock::now());
+    std::this_thread::sleep_until(nextFrame);
+  }
+
+  const auto& pumpStats = events.getStats();
+  fmt::println("Input events: {} forwarded, {} dropped",
+               pumpStats.events,
+               pumpStats.dropped);
+  if (queuedFrames > 0) {
+    const auto frames = static_cast<double>(queuedFrames);
+    fmt::println("Render queue: {:.1f} draws and {:.1f} binds saved per frame",
+                 static_cast<double>(queuedDraws) / frames,
+                 static_cast<double>(queuedBindsSaved) / frames);
+  }
+  if (cullingFrames > 0) {
+    const auto frames = static_cast<double>(cullingFrames);
+    fmt::println("Game mesh culling: {:.0f} of {:.0f} visible, {:.3f} ms "
+                 "per frame",
+                 static_cast<double>(cullingVisible) / frames,
+                 static_cast<double>(cullingObjects) / frames,
+                 cullingMilliseconds / frames);
+  }
+  const auto& textureStats = textures->getStats();
+  fmt::println("Textures: {} KB resident, {} levels streamed in, {} evicted",
+               textureStats.residentBytes / 1024,
+               textureStats.levelsStreamed,
+               textureStats.levelsEvicted);
+  if (inputLatency.samples > 0) {
+    fmt::println("Input to present latency: {:.2f} ms average, {:.2f} ms "
+                 "max over {} inputs",
+                 inputLatency.averageMilliseconds(),
+                 inputLatency.maxMilliseconds,
+                 inputLatency.samples);
   }
 }
 
@@ -55,17 +113,18 @@ auto Renderer::createHostBuffer(const std::string& name,
                                 void* data,
                                 vk::BufferUsageFlags usageFlags,
                                 VmaMemoryUsage memoryUsage,
-                                VmaAllocationCreateFlags flags) -> HostBuffer&
+                                VmaAllocationCreateFlags flags)
+    -> Handle<HostBuffer>
 {
-  auto [fst, snd] = hostBuffers.try_emplace(name,
-                                            device->handle,
-                                            allocator,
-                                            size,
-                                            data,
-                                            usageFlags,
-                                            memoryUsage,
-                                            flags);
-  return fst->second;
+  const auto handle = hostBuffers.emplace(device->handle,
+                                          allocator,
+                                          size,
+                                          data,
+                                          usageFlags,
+                                          memoryUsage,
+                                          flags);
+  hostBuffers.setLabel(handle, name);
+  return handle;
 };
 
 auto Renderer::createDeviceBuffer(const std::string& name,
@@ -73,13 +132,40 @@ auto Renderer::createDeviceBuffer(const std::string& name,
                                   vk::BufferUsageFlags usageFlags,
                                   VmaMemoryUsage memoryUsage,
                                   VmaAllocationCreateFlags flags)
-    -> DeviceBuffer&
+    -> Handle<DeviceBuffer>
 {
-  auto [fst, snd] = deviceBuffers.try_emplace(
-      name, device->handle, allocator, size, usageFlags, memoryUsage, flags);
-  return fst->second;
+  const auto handle = deviceBuffers.emplace(
+      device->handle, allocator, size, usageFlags, memoryUsage, flags);
+  deviceBuffers.setLabel(handle, name);
+  return handle;
 };
 
+auto Renderer::getHostBuffer(Handle<HostBuffer> handle) -> HostBuffer&
+{
+  return hostBuffers.get(handle);
+}
+
+auto Renderer::getDeviceBuffer(Handle<DeviceBuffer> handle) -> DeviceBuffer&
+{
+  return deviceBuffers.get(handle);
+}
+
+void Renderer::destroyHostBuffer(Handle<HostBuffer> handle)
+{
+  if (hostBuffers.contains(handle)) {
+    hostBuffers.erase(handle);
+    defragmenter->request();
+  }
+}
+
+void Renderer::destroyDeviceBuffer(Handle<DeviceBuffer> handle)
+{
+  if (deviceBuffers.contains(handle)) {
+    deviceBuffers.erase(handle);
+    defragmenter->request();
+  }
+}
+
 void Renderer::initVulkan()
 {
   createInstance();
@@ -96,11 +182,43 @@ void Renderer::initVulkan()
 
   vmaCreateAllocator(&allocatorInfo, &allocator);
 
+  defragmenter = std::make_unique<Defragmenter>(
+      device->handle,
+      allocator,
+      device->queueFamilyIndices.computeFamily.value());
+
+  streamingUploader = std::make_unique<StreamingUploader>(
+      device->handle,
+      allocator,
+      device->queueFamilyIndices.computeFamily.value());
+
   std::tie(swapchain, swapchainExtent) = device->createSwapchain(*window);
   images = device->getSwapchainImages(swapchain);
   imagesViews = device->getImageViews(images);
 }
 
+void Renderer::loadAssets()
+{
+  if (!std::filesystem::exists(assetPackPath)) {
+    fmt::println("No asset pack at {}, generating assets", assetPackPath);
+    return;
+  }
+
+  // Only the table of contents is read here; blobs are faulted in as the
+  // uploads touch them
+  const auto start = std::chrono::steady_clock::now();
+  assets = std::make_unique<AssetPack>(assetPackPath);
+  // Pipelines created from here on load their modules from the pack
+  device->shaderPack = assets.get();
+  fmt::println("Mapped {} assets ({:.1f} MB) from {} in {:.3f} ms",
+               assets->entries().size(),
+               static_cast<double>(assets->size()) / 1.0e6,
+               assetPackPath,
+               std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+                   .count());
+}
+
 void Renderer::initCompute()
 {
   std::vector<vk::DescriptorPoolSize> computeDescriptorPoolSizes = {
@@ -112,9 +230,9 @@ void Renderer::initCompute()
            .type = vk::DescriptorType::eCombinedImageSampler,
            .descriptorCount = 1}}};
 
-  const auto computeDescriptorPool =
-      device->createDescriptorPool(computeDescriptorPoolSizes, 1);
-  descriptorPools["compute"] = computeDescriptorPool;
+  computeDescriptorPool = descriptorPools.emplace(
+      device->createDescriptorPool(computeDescriptorPoolSizes, 1));
+  descriptorPools.setLabel(computeDescriptorPool, "compute");
 
   // Create compute executor
   std::vector<vk::DescriptorSetLayoutBinding> descriptorSetLayoutBindings = {
@@ -132,94 +250,128 @@ void Renderer::initCompute()
   compute = std::make_unique<Compute>(
       device->handle,
       device->queueFamilyIndices.computeFamily.value(),
-      descriptorPools["compute"],
+      descriptorPools.get(computeDescriptorPool),
       descriptorSetLayoutBindings);
 
-  // Create and load buffers
-  const auto resultSize = game.vertices.size();
-
-  const HostBuffer& hostBuffer0 =
-      createHostBuffer("buffer0",
-                       game.vertices.size() * sizeof(glm::vec2),
-                       game.vertices.data(),
-                       vk::BufferUsageFlagBits::eTransferSrc);
-
-  createHostBuffer("result",
-                   game.vertices.size() * sizeof(glm::vec2),
-                   game.vertices.data(),
-                   vk::BufferUsageFlagBits::eTransferDst);
-
-  const DeviceBuffer& deviceBuffer0 =
-      createDeviceBuffer("buffer0",
-                         game.vertices.size() * sizeof(glm::vec2),
-                         vk::BufferUsageFlagBits::eStorageBuffer
-                             | vk::BufferUsageFlagBits::eTransferDst);
-
-  const DeviceBuffer& deviceResultBuffer =
-      createDeviceBuffer("result",
-                         resultSize * sizeof(glm::vec2),
-                         vk::BufferUsageFlagBits::eStorageBuffer
-                             | vk::BufferUsageFlagBits::eTransferSrc
-                             | vk::BufferUsageFlagBits::eTransferDst
-                             | vk::BufferUsageFlagBits::eVertexBuffer);
-
-  compute->commandBuffer.begin(vk::CommandBufferBeginInfo {});
-
-  compute->commandBuffer.copyBuffer(
-      hostBuffer0.handle,
-      deviceBuffer0.handle,
-      {{0, 0, game.vertices.size() * sizeof(glm::vec2)}});
-
-  vk::MemoryBarrier memoryBarrier;
-  memoryBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-  memoryBarrier.dstAccessMask =
-      vk::AccessFlagBits::eShaderRead;  // Access by compute shader
-
-  compute->commandBuffer.pipelineBarrier(
-      vk::PipelineStageFlagBits::eTransfer,  // Src stage mask
-      vk::PipelineStageFlagBits::eComputeShader,  // Dst stage mask
-      {},  // Dependency flags
-      memoryBarrier,  // Memory barriers
-      nullptr,  // Buffer memory barriers (could use instead of memory barrier)
-      nullptr);  // Image memory barriers
-
-  // No barrier because using the same queue for now
-  compute->commandBuffer.end();
-
-  const vk::SubmitInfo submitInfo {.commandBufferCount = 1,
-                                   .pCommandBuffers = &compute->commandBuffer};
-  compute->queue.submit(submitInfo);
-  compute->queue.waitIdle();
-
-  // Create pipeline including descriptors and shaders
-  vk::DescriptorBufferInfo buffer0Descriptor(
-      deviceBuffer0.handle, 0, VK_WHOLE_SIZE);
-
-  vk::DescriptorBufferInfo resultDescriptor(
-      deviceResultBuffer.handle, 0, VK_WHOLE_SIZE);
-
-  std::array<vk::WriteDescriptorSet, 2> writeDescriptorSets = {
-      {{.dstSet = compute->descriptorSet,
-        .dstBinding = 0,
-        .descriptorCount = 1,
-        .descriptorType = vk::DescriptorType::eStorageBuffer,
-        .pBufferInfo = &buffer0Descriptor},
-       {.dstSet = compute->descriptorSet,
-        .dstBinding = 1,
-        .descriptorCount = 1,
-        .descriptorType = vk::DescriptorType::eStorageBuffer,
-        .pBufferInfo = &resultDescriptor}}};
-
-  device->handle.updateDescriptorSets(writeDescriptorSets, nullptr);
-
-  std::string shaderPath = "src/shaders/bin/hello-world.slang.main.spv";
-  const auto helloWorldShader =
-      std::make_unique<Shader>(device.get(), shaderPath);
-  auto stage = helloWorldShader->getShaderStageCreateInfo(
-      vk::ShaderStageFlagBits::eCompute);
-
-  compute->pipelines["compute1"] =
-      device->createComputePipeline(stage, compute->pipelineLayout);
+  if (assets != nullptr) {
+    nbody = std::make_unique<NBody>(*device,
+                                    allocator,
+                                    *compute,
+                                    NBodySettings {},
+                                    assets->galaxy("galaxy"),
+                                    *streamingUploader);
+
+    // If read time dominates the upload is I/O-bound; if copy time dominates
+    // it is limited by the CPU (memcpy into staging); if wait time dominates
+    // it is limited by the GPU transfer.
+    const auto& stats = nbody->getLoadStats();
+    fmt::println("Streamed galaxy ({:.1f} MB) in {:.3f} s ({:.1f} MB/s): "
+                 "read {:.3f} s, copy {:.3f} s, GPU wait {:.3f} s",
+                 static_cast<double>(stats.bytesUploaded) / 1.0e6,
+                 stats.seconds,
+                 stats.megabytesPerSecond(),
+                 stats.readSeconds,
+                 stats.copySeconds,
+                 stats.waitSeconds);
+  } else {
+    nbody = std::make_unique<NBody>(*device, allocator, *compute);
+  }
+
+  // Cells just fit the contact distance, which leaves the disc with fewer
+  // than one particle per cell on average
+  galaxyCollisions = {.particleRadius = 0.005F,
+                      .stiffness = 500.0F,
+                      .damping = 2.0F,
+                      .timeStep = nbody->settings.timeStep};
+  galaxyGrid = std::make_unique<SpatialGrid>(
+      *device,
+      allocator,
+      *compute,
+      SpatialGridSettings {.cellSize = 2.0F * galaxyCollisions.particleRadius});
+
+  // Two fountains on either side of the galaxy
+  particles = std::make_unique<ParticleSystem>(*device, allocator, *compute);
+  for (const auto x : {-0.8F, 0.8F}) {
+    particles->emitters.push_back(
+        {.position = {x, 0.0F, 0.0F}, .speed = 1.2F, .rate = 20000.0F});
+  }
+
+  // A belt of asteroids around the galaxy, most of them outside the view
+  scene = std::make_unique<GpuScene>(*device, allocator, *compute);
+  // Baked meshes already have their levels of detail and are copied as
+  // they are; generated ones are simplified and optimized here
+  const auto addSceneMesh =
+      [&](const char* name, const auto& generate, float& radius) -> uint32_t
+  {
+    if (assets != nullptr) {
+      const SceneMeshView mesh = assets->sceneMesh(name);
+      radius = mesh.info.radius;
+      return scene->addMesh(mesh);
+    }
+    const MeshData mesh = generate();
+    radius = mesh.boundingRadius();
+    return scene->addMesh(mesh);
+  };
+  cubeMesh = addSceneMesh("cube", makeCube, cubeRadius);
+  sphereMesh = addSceneMesh(
+      "sphere", [] { return makeIcosphere(2); }, sphereRadius);
+
+  const auto geometry = scene->getStats();
+  fmt::println("Scene geometry: {} meshes with {} levels of detail in {} KB, "
+               "{:.1f}x smaller than float32; {:.2f} vertices transformed "
+               "per triangle, down from {:.2f}",
+               geometry.meshes,
+               geometry.lods,
+               geometry.geometryBytes / 1024,
+               static_cast<double>(geometry.unpackedGeometryBytes)
+                   / static_cast<double>(geometry.geometryBytes),
+               static_cast<double>(geometry.cacheMisses)
+                   / static_cast<double>(geometry.triangles),
+               static_cast<double>(geometry.unoptimizedCacheMisses)
+                   / static_cast<double>(geometry.triangles));
+  const std::array<uint32_t, 2> meshes = {cubeMesh, sphereMesh};
+
+  constexpr uint32_t asteroidCount = 32768;
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> unit(0.0F, 1.0F);
+  for (uint32_t i = 0; i < asteroidCount; i++) {
+    const auto radius = 1.5F + (2.5F * unit(random));
+    const auto angle = 2.0F * std::numbers::pi_v<float> * unit(random);
+    const auto shade = 0.3F + (0.7F * unit(random));
+    scene->addObject(
+        {.position = {radius * std::cos(angle),
+                      radius * std::sin(angle),
+                      0.3F * (unit(random) - 0.5F)},
+         .scale = 0.01F + (0.03F * unit(random)),
+         .color = {shade, 0.8F * shade, 0.6F * shade, 1.0F},
+         .mesh = meshes[i % meshes.size()]});
+  }
+
+  // Dense moons, culled a meshlet at a time
+  clusters = std::make_unique<ClusterScene>(*device, allocator, *compute);
+  const uint32_t moonMesh = assets != nullptr
+      ? clusters->addMesh(assets->clusterMesh("moon"))
+      : clusters->addMesh(makeIcosphere(5));
+  for (const auto& position : {glm::vec3(-1.2F, 0.8F, 0.2F),
+                               glm::vec3(1.3F, 0.9F, -0.1F),
+                               glm::vec3(0.0F, 1.8F, 0.3F)})
+  {
+    clusters->addObject({.position = position,
+                         .scale = 0.15F,
+                         .color = {0.5F, 0.55F, 0.6F, 1.0F},
+                         .mesh = moonMesh});
+  }
+  const auto clusterStats = clusters->getStats();
+  if (clusterStats.meshlets > 0) {
+    fmt::println("Clusters: {} meshlets of {:.1f} vertices and {:.1f} "
+                 "triangles on average, {} instanced",
+                 clusterStats.meshlets,
+                 static_cast<double>(clusterStats.meshletVertices)
+                     / clusterStats.meshlets,
+                 static_cast<double>(clusterStats.triangles)
+                     / clusterStats.meshlets,
+                 clusterStats.clusters);
+  }
 }
 
 void Renderer::initGraphics()
@@ -233,9 +385,9 @@ void Renderer::initGraphics()
            .type = vk::DescriptorType::eCombinedImageSampler,
            .descriptorCount = 2}}};
 
-  auto graphicsDescriptorPool =
-      device->createDescriptorPool(graphicsDescriptorPoolSizes, 1);
-  descriptorPools["graphics"] = graphicsDescriptorPool;
+  graphicsDescriptorPool = descriptorPools.emplace(
+      device->createDescriptorPool(graphicsDescriptorPoolSizes, 1));
+  descriptorPools.setLabel(graphicsDescriptorPool, "graphics");
 
   // Create graphics executor
   std::vector<vk::DescriptorSetLayoutBinding> descriptorSetLayoutBindings = {
@@ -258,158 +410,290 @@ void Renderer::initGraphics()
   graphics = std::make_unique<Graphics>(
       device->handle,
       device->queueFamilyIndices.graphicsFamily.value(),
-      descriptorPools["graphics"],
+      descriptorPools.get(graphicsDescriptorPool),
       descriptorSetLayoutBindings);
 
-  std::string vertShaderPath = "src/shaders/bin/graphics.slang.vertMain.spv";
+  recorder = std::make_unique<ParallelRecorder>(
+      device->handle,
+      device->queueFamilyIndices.graphicsFamily.value(),
+      scheduler);
+
+  gamePositions = std::make_unique<GpuVector<glm::vec4>>(
+      device->handle, allocator, vk::BufferUsageFlagBits::eVertexBuffer);
+  gameColors = std::make_unique<GpuVector<glm::vec4>>(
+      device->handle, allocator, vk::BufferUsageFlagBits::eVertexBuffer);
+  gameMeshes = std::make_unique<InstanceBatcher>(device->handle, allocator);
+
+  // Shaders are loaded and pipelines compiled as tasks while this thread
+  // creates the textures below. Registering the pipelines touches
+  // graphics->pipelines, which is not synchronised, so that runs here.
+  vk::Pipeline compiledParticlePipeline;
+  vk::Pipeline compiledScenePipeline;
+  TaskCounter pipelinesCompiled;
+  scheduler.spawn([&] { compiledParticlePipeline = createParticlePipeline(); },
+                  &pipelinesCompiled);
+  scheduler.spawn([&] { compiledScenePipeline = createScenePipeline(); },
+                  &pipelinesCompiled);
+
+  TaskCounter pipelinesRegistered;
+  scheduler.spawnAfter(
+      pipelinesCompiled,
+      [&]
+      {
+        particlePipeline =
+            graphics->pipelines.emplace(compiledParticlePipeline);
+        graphics->pipelines.setLabel(particlePipeline, "particles");
+        scenePipeline = graphics->pipelines.emplace(compiledScenePipeline);
+        graphics->pipelines.setLabel(scenePipeline, "scene");
+      },
+      &pipelinesRegistered,
+      TaskAffinity::eMainThread);
+
+  // Camera looking down at the galaxy disc at an angle
+  const auto aspect = static_cast<float>(swapchainExtent.width)
+      / static_cast<float>(swapchainExtent.height);
+  const glm::vec3 cameraPosition(0.0F, -1.6F, 1.4F);
+  ParticleUniforms uniforms {
+      .projection =
+          glm::perspectiveRH_ZO(glm::radians(60.0F), aspect, 0.1F, 100.0F),
+      .modelview = glm::lookAt(cameraPosition,
+                               glm::vec3(0.0F),
+                               glm::vec3(0.0F, 0.0F, 1.0F)),
+      .screendim = {static_cast<float>(swapchainExtent.width),
+                    static_cast<float>(swapchainExtent.height)}};
+  uniforms.projection[1][1] *= -1.0F;  // Vulkan clip space has y down
+  viewProjection = uniforms.projection * uniforms.modelview;
+  lodView = {.cameraPosition = cameraPosition,
+             .pixelsPerUnit = std::abs(uniforms.projection[1][1])
+                 * static_cast<float>(swapchainExtent.height) * 0.5F};
+
+  particleUniformBuffer =
+      createHostBuffer("particle uniforms",
+                       sizeof(ParticleUniforms),
+                       &uniforms,
+                       vk::BufferUsageFlagBits::eUniformBuffer);
+  hostBuffers.get(particleUniformBuffer)
+      .bindDescriptor(
+          graphics->descriptorSet, 2, vk::DescriptorType::eUniformBuffer);
+
+  textures = std::make_unique<TextureStreamer>(
+      device->handle,
+      allocator,
+      device->queueFamilyIndices.graphicsFamily.value());
+
+  // Baked textures only upload their mip tail here; the larger levels
+  // stream in over the first frames and may be evicted again under memory
+  // pressure. Generated ones upload their base level and the GPU blits the
+  // rest of the chain, so they are always resident.
+  const auto createTexture = [&](const char* name,
+                                 uint32_t width,
+                                 uint32_t height,
+                                 const auto& generate) -> Handle<Texture>
+  {
+    if (assets != nullptr) {
+      TextureView view = assets->texture(name);
+      return textures->create(
+          std::make_shared<MemoryTextureSource>(
+              view.extent, view.format, std::move(view.levels)),
+          name);
+    }
+    const auto texels = generate();
+    return textures->createWithMipmaps(
+        {.width = width, .height = height},
+        vk::Format::eR8G8B8A8Unorm,
+        std::as_bytes(std::span(texels)),
+        name);
+  };
+
+  constexpr uint32_t spriteSize = 256;
+  particleTexture =
+      createTexture("particle",
+                    spriteSize,
+                    spriteSize,
+                    [] { return makeParticleSprite(spriteSize); });
+
+  constexpr uint32_t rampSize = 256;
+  gradientTexture = createTexture(
+      "gradient", rampSize, 1, [] { return makeSpeedRamp(rampSize); });
+
+  textures->bindDescriptor(particleTexture, graphics->descriptorSet, 0);
+  textures->bindDescriptor(gradientTexture, graphics->descriptorSet, 1);
+
+  // Runs the registration task on this thread and rethrows shader errors
+  scheduler.wait(pipelinesRegistered);
+}
+
+auto Renderer::createParticlePipeline() const -> vk::Pipeline
+{
   const auto vertShader =
-      std::make_unique<Shader>(device.get(), vertShaderPath);
+      std::make_unique<Shader>(device.get(), "graphics", "vertMain");
   auto vertStage =
       vertShader->getShaderStageCreateInfo(vk::ShaderStageFlagBits::eVertex);
 
-  std::string fragShaderPath = "src/shaders/bin/graphics.slang.fragMain.spv";
   const auto fragShader =
-      std::make_unique<Shader>(device.get(), fragShaderPath);
+      std::make_unique<Shader>(device.get(), "graphics", "fragMain");
   auto fragStage =
       fragShader->getShaderStageCreateInfo(vk::ShaderStageFlagBits::eFragment);
 
-  vk::VertexInputBindingDescription vertexInputBindingDescription {
-      .binding = 0,
-      .stride = sizeof(game.vertices.at(0)),
-      .inputRate = vk::VertexInputRate::eVertex};
-
-  std::array<vk::VertexInputAttributeDescription, 1> vertexInputAttributes = {{
+  // Positions and velocities come from separate simulation buffers
+  std::array<vk::VertexInputBindingDescription, 2>
+      vertexInputBindingDescriptions = {{
+          {.binding = 0,
+           .stride = ShaderLayout<glm::vec4>::stride,
+           .inputRate = vk::VertexInputRate::eVertex},
+          {.binding = 1,
+           .stride = ShaderLayout<glm::vec4>::stride,
+           .inputRate = vk::VertexInputRate::eVertex},
+      }};
+
+  std::array<vk::VertexInputAttributeDescription, 2> vertexInputAttributes = {{
       {.location = 0,
        .binding = 0,
-       .format = vk::Format::eR32G32Sfloat,
-       .offset = 0},  // Location 0 : Position
-      //  {.location = 1,
-      //   .binding = 0,
-      //   .format = vk::Format::eR32G32B32A32Sfloat,
-      //   .offset = offsetof(Particle, vel)}
-  }};  // Location 1 : Velocity
+       .format = vk::Format::eR32G32B32A32Sfloat,
+       .offset = 0},  // Location 0 : Position and mass
+      {.location = 1,
+       .binding = 1,
+       .format = vk::Format::eR32G32B32A32Sfloat,
+       .offset = 0},  // Location 1 : Velocity and speed
+  }};
 
   vk::PipelineVertexInputStateCreateInfo vertexInputBindingInfo {
-      .vertexBindingDescriptionCount = 1,
-      .pVertexBindingDescriptions = &vertexInputBindingDescription,
+      .vertexBindingDescriptionCount =
+          static_cast<uint32_t>(vertexInputBindingDescriptions.size()),
+      .pVertexBindingDescriptions = vertexInputBindingDescriptions.data(),
       .vertexAttributeDescriptionCount =
           static_cast<uint32_t>(vertexInputAttributes.size()),
       .pVertexAttributeDescriptions = vertexInputAttributes.data()};
 
-  graphics->pipelines["graphics1"] = device->createGraphicsPipeline(
-      vertStage, fragStage, vertexInputBindingInfo, graphics->pipelineLayout);
+  return device->createGraphicsPipeline(vertStage,
+                                        fragStage,
+                                        vertexInputBindingInfo,
+                                        graphics->pipelineLayout,
+                                        vk::PrimitiveTopology::ePointList);
 }
 
-void Renderer::update() const
+auto Renderer::createScenePipeline() const -> vk::Pipeline
 {
-  std::vector<glm::vec2> result {{0, 0}, {0, 0}, {0, 0}};
-
-  const auto& hostResultBuffer = hostBuffers.at("result");
-  const auto& deviceResultBuffer = deviceBuffers.at("result");
-
-  // Execute compute pipeline
-  compute->commandBuffer.begin(vk::CommandBufferBeginInfo {});
-
-  // Barrier to ensure that input buffer transfer is finished before compute
-  // shader reads from it
-  vk::BufferMemoryBarrier bufferBarrier {};
-  bufferBarrier.buffer = deviceResultBuffer.handle;
-  bufferBarrier.size = vk::WholeSize;
-  bufferBarrier.srcAccessMask = vk::AccessFlagBits::eHostWrite;
-  bufferBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-  bufferBarrier.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
-  bufferBarrier.dstQueueFamilyIndex = vk::QueueFamilyIgnored;
-
-  compute->commandBuffer.pipelineBarrier(
-      vk::PipelineStageFlagBits::eHost,
-      vk::PipelineStageFlagBits::eComputeShader,
-      {},
-      nullptr,
-      bufferBarrier,
-      nullptr);
-
-  compute->commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute,
-                                      compute->pipelines.at("compute1"));
-
-  compute->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute,
-                                            compute->pipelineLayout,
-                                            0,
-                                            compute->descriptorSet,
-                                            {});
-
-  compute->commandBuffer.dispatch(static_cast<uint32_t>(result.size()), 1, 1);
-
-  // Barrier to ensure that shader writes are finished before buffer is read
-  // back from GPU
-  bufferBarrier.buffer = deviceResultBuffer.handle;
-  bufferBarrier.size = vk::WholeSize;
-  bufferBarrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
-  bufferBarrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
-  bufferBarrier.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
-  bufferBarrier.dstQueueFamilyIndex = vk::QueueFamilyIgnored;
-
-  compute->commandBuffer.pipelineBarrier(
-      vk::PipelineStageFlagBits::eComputeShader,
-      vk::PipelineStageFlagBits::eTransfer,
-      {},
-      nullptr,
-      bufferBarrier,
-      nullptr);
-
-  // copy to host
-  compute->commandBuffer.copyBuffer(
-      deviceResultBuffer.handle,
-      hostResultBuffer.handle,
-      {{0, 0, result.size() * sizeof(glm::vec2)}});
-
-  // Barrier to ensure that buffer copy is finished before host reading from it
-  bufferBarrier.buffer = hostResultBuffer.handle;
-  bufferBarrier.size = vk::WholeSize;
-  bufferBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-  bufferBarrier.dstAccessMask = vk::AccessFlagBits::eHostRead;
-  bufferBarrier.srcQueueFamilyIndex = vk::QueueFamilyIgnored;
-  bufferBarrier.dstQueueFamilyIndex = vk::QueueFamilyIgnored;
-
-  compute->commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
-                                         vk::PipelineStageFlagBits::eHost,
-                                         {},
-                                         nullptr,
-                                         bufferBarrier,
-                                         nullptr);
-
-  compute->commandBuffer.end();
-
-  const auto fence = device->handle.createFence({});
-  device->handle.resetFences(fence);
-
-  const vk::SubmitInfo submitInfo {
-      .commandBufferCount = 1,
-      .pCommandBuffers = &compute->commandBuffer,
-  };
-  compute->queue.submit(submitInfo, fence);
+  const auto sceneVertShader =
+      std::make_unique<Shader>(device.get(), "scene", "vertMain");
+  auto sceneVertStage = sceneVertShader->getShaderStageCreateInfo(
+      vk::ShaderStageFlagBits::eVertex);
+  const auto sceneFragShader =
+      std::make_unique<Shader>(device.get(), "scene", "fragMain");
+  auto sceneFragStage = sceneFragShader->getShaderStageCreateInfo(
+      vk::ShaderStageFlagBits::eFragment);
+
+  return device->createGraphicsPipeline(sceneVertStage,
+                                        sceneFragStage,
+                                        GpuScene::vertexInputState(),
+                                        graphics->pipelineLayout);
+}
 
-  if (device->handle.waitForFences(fence, vk::True, UINT64_MAX)
-      != vk::Result::eSuccess)
-  {
-    throw std::runtime_error("Failed to wait for fence.");
+void Renderer::updateGame()
+{
+  constexpr std::size_t chunkSize = 16 * 1024;
+
+  // The game may have ticked any number of times since the last frame
+  const auto& snapshot = game.latestSnapshot();
+  frameInputTimestamp = snapshot.inputTimestamp;
+  const float alpha = interpolateGame
+      ? snapshot.alphaAt(GameSnapshot::Clock::now())
+      : 1.0F;
+
+  const auto count = snapshot.size();
+  gamePositions->resize(count);
+
+  // Colours are already laid out as vertices and only change with a tick
+  if (snapshot.tick != gameColorsTick || gameColors->size() != count) {
+    gameColors->assign(snapshot.colors);
+    gameColorsTick = snapshot.tick;
   }
 
-  device->handle.destroyFence(fence);
-
-  vmaFlushAllocation(allocator, hostResultBuffer.allocation, 0, vk::WholeSize);
-  vmaInvalidateAllocation(
-      allocator, hostResultBuffer.allocation, 0, vk::WholeSize);
-
-  memcpy(result.data(),
-         hostResultBuffer.allocInfo.pMappedData,
-         result.size() * sizeof(glm::vec2));
+  const auto positions = gamePositions->modify(0, count);
+  scheduler.parallelFor(
+      count,
+      chunkSize,
+      [&](std::size_t first, std::size_t last)
+      {
+        for (std::size_t i = first; i < last; i++) {
+          const float x = std::lerp(
+              snapshot.previousX[i], snapshot.positionX[i], alpha);
+          const float y = std::lerp(
+              snapshot.previousY[i], snapshot.positionY[i], alpha);
+          // Mass for graphics.slang to draw a sprite of this size; meshes
+          // leave a single pixel
+          const float size = snapshot.shapes[i] == Shape::Value::eSprite
+              ? snapshot.sizes[i]
+              : 0.0F;
+          positions[i] = {x, y, 0.0F, 0.25F * size * size};
+        }
+      });
+
+  // Meshes outside the view are culled on the CPU, since they never reach
+  // the GPU scene's culling
+  gameMeshEntities.clear();
+  gameBoundsX.clear();
+  gameBoundsY.clear();
+  gameBoundsZ.clear();
+  gameBoundsRadius.clear();
+  for (std::size_t i = 0; i < count; i++) {
+    const auto shape = snapshot.shapes[i];
+    if (shape == Shape::Value::eSprite) {
+      continue;
+    }
+    const float meshRadius =
+        shape == Shape::Value::eCube ? cubeRadius : sphereRadius;
+    gameMeshEntities.push_back(static_cast<uint32_t>(i));
+    gameBoundsX.push_back(positions[i].x);
+    gameBoundsY.push_back(positions[i].y);
+    gameBoundsZ.push_back(positions[i].z);
+    gameBoundsRadius.push_back(meshRadius * snapshot.sizes[i]);
+  }
+  gameCulling.build({.centerX = gameBoundsX.data(),
+                     .centerY = gameBoundsY.data(),
+                     .centerZ = gameBoundsZ.data(),
+                     .radius = gameBoundsRadius.data(),
+                     .count = gameMeshEntities.size()});
+  const auto visible = gameCulling.cull(
+      Frustum::fromMatrix(viewProjection).planes, scheduler);
+
+  const auto cullStats = gameCulling.getStats();
+  cullingFrames++;
+  cullingObjects += cullStats.objects;
+  cullingVisible += cullStats.visible;
+  cullingMilliseconds +=
+      cullStats.buildMilliseconds + cullStats.cullMilliseconds;
+
+  // Each mesh becomes one instanced draw however many entities use it
+  gameMeshes->clear();
+  for (const auto object : visible) {
+    const uint32_t i = gameMeshEntities[object];
+    const uint32_t mesh =
+        snapshot.shapes[i] == Shape::Value::eCube ? cubeMesh : sphereMesh;
+    gameMeshes->add(scenePipeline,
+                    mesh,
+                    {.positionScale = {glm::vec3(positions[i]),
+                                       snapshot.sizes[i]},
+                     .color = snapshot.colors[i],
+                     .mesh = mesh,
+                     .padding = {}});
+  }
+  gameMeshes->build();
+}
 
-  compute->queue.waitIdle();
+void Renderer::update()
+{
+  updateGame();
 
-  for (auto& item : result) {
-    fmt::print("({},{}), ", item.x, item.y);
+  ComputeBatch batch;
+  for (uint32_t i = 0; i < simulationStepsPerFrame; i++) {
+    nbody->step(batch);
+    nbody->collide(batch, *galaxyGrid, galaxyCollisions);
   }
-  fmt::print("\n");
+  particles->update(batch, frameTime);
+  scene->cull(batch, viewProjection, lodView);
+  clusters->cull(batch, viewProjection, lodView.cameraPosition);
+  compute->submit(batch);
 }
 
 void Renderer::draw()
@@ -450,6 +734,31 @@ void Renderer::draw()
 
   graphics->commandBuffer.begin(vk::CommandBufferBeginInfo());
 
+  // The simulations and culling passes wrote vertices, indices and draw
+  // arguments in a separate submission
+  const vk::MemoryBarrier simulationBarrier {
+      .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+      .dstAccessMask = vk::AccessFlagBits::eVertexAttributeRead
+          | vk::AccessFlagBits::eIndexRead
+          | vk::AccessFlagBits::eIndirectCommandRead};
+  graphics->commandBuffer.pipelineBarrier(
+      vk::PipelineStageFlagBits::eComputeShader,
+      vk::PipelineStageFlagBits::eDrawIndirect
+          | vk::PipelineStageFlagBits::eVertexInput,
+      {},
+      simulationBarrier,
+      nullptr,
+      nullptr);
+
+  // Texture residency changes are recorded ahead of the render pass
+  gamePositions->sync(graphics->commandBuffer);
+  gameColors->sync(graphics->commandBuffer);
+  gameMeshes->sync(graphics->commandBuffer);
+
+  textures->touch(particleTexture);
+  textures->touch(gradientTexture);
+  textures->update(graphics->commandBuffer);
+
   graphics->insertImageMemoryBarrier(
       images[currentImageIndex],
       vk::AccessFlagBits::eNone,
@@ -464,35 +773,96 @@ void Renderer::draw()
                                  .baseArrayLayer = 0,
                                  .layerCount = 1});
 
-  graphics->commandBuffer.beginRenderingKHR(renderingInfo);
-
-  vk::Viewport viewport(0.0F,
-                        0.0F,
-                        static_cast<float>(swapchainExtent.width),
-                        static_cast<float>(swapchainExtent.height),
-                        0.0F,
-                        1.0F);
-
-  vk::Rect2D scissor({.x = 0, .y = 0}, swapchainExtent);
-  graphics->commandBuffer.setViewport(0, viewport);
-  graphics->commandBuffer.setScissor(0, scissor);
-
-  graphics->commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
-                                             graphics->pipelineLayout,
-                                             0,
-                                             graphics->descriptorSet,
-                                             {});
-
-  graphics->commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics,
-                                       graphics->pipelines.at("graphics1"));
+  // Draws carry all their state, so any range of the sorted queue can go
+  // to a secondary command buffer of its own
+  renderQueue.clear();
+  const auto spriteDraw = [&](vk::Buffer positions,
+                              vk::Buffer velocities,
+                              uint32_t count) -> DrawItem
+  {
+    return {.vertexBuffers = {positions, velocities},
+            .command = {.count = count}};
+  };
+  const auto submit = [&](DrawItem item, PipelineHandle pipeline)
+  {
+    item.key = RenderQueue::makeKey(additivePass, pipeline, 0, 0.0F);
+    item.pipeline = pipeline;
+    item.descriptorSet = graphics->descriptorSet;
+    renderQueue.submit(item);
+  };
 
-  graphics->commandBuffer.bindVertexBuffers(
-      0, deviceBuffers.at("result").getHandle(), {0});
+  submit(spriteDraw(nbody->positions().getHandle(),
+                    nbody->velocities().getHandle(),
+                    nbody->particleCount()),
+         particlePipeline);
+  // Live count is only known on the GPU
+  submit(particles->drawItem(), particlePipeline);
+  // So is the visible object count
+  if (scene->objectCount() > 0) {
+    submit(scene->drawItem(), scenePipeline);
+  }
+  if (clusters->objectCount() > 0) {
+    submit(clusters->drawItem(), scenePipeline);
+  }
+  if (!gamePositions->empty()) {
+    submit(spriteDraw(gamePositions->buffer().getHandle(),
+                      gameColors->buffer().getHandle(),
+                      static_cast<uint32_t>(gamePositions->size())),
+           particlePipeline);
+  }
+  gameMeshes->submit(
+      renderQueue, *scene, additivePass, graphics->descriptorSet);
+  renderQueue.sort();
+
+  const vk::Viewport viewport {
+      .x = 0.0F,
+      .y = 0.0F,
+      .width = static_cast<float>(swapchainExtent.width),
+      .height = static_cast<float>(swapchainExtent.height),
+      .minDepth = 0.0F,
+      .maxDepth = 1.0F};
+  const vk::Rect2D scissor {.offset = {.x = 0, .y = 0},
+                            .extent = swapchainExtent};
+  const auto recordDraws =
+      [&](vk::CommandBuffer commandBuffer, std::size_t first, std::size_t last)
+  {
+    commandBuffer.setViewport(0, viewport);
+    commandBuffer.setScissor(0, scissor);
+    renderQueue.record(commandBuffer,
+                       graphics->pipelines,
+                       graphics->pipelineLayout,
+                       first,
+                       last);
+  };
 
-  graphics->commandBuffer.draw(3, 1, 0, 0);
+  if (parallelRecording) {
+    // The previous frame's fence was waited on, so its pools are free
+    recorder->beginFrame();
+    renderingInfo.setFlags(
+        vk::RenderingFlagBits::eContentsSecondaryCommandBuffers);
+    const vk::CommandBufferInheritanceRenderingInfo inheritance {
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &device->surfaceFormat.format,
+        .rasterizationSamples = vk::SampleCountFlagBits::e1};
+
+    graphics->commandBuffer.beginRenderingKHR(renderingInfo);
+    recorder->record(graphics->commandBuffer,
+                     renderQueue.size(),
+                     drawsPerSlice,
+                     recordDraws,
+                     &inheritance);
+  } else {
+    graphics->commandBuffer.beginRenderingKHR(renderingInfo);
+    recordDraws(graphics->commandBuffer, 0, renderQueue.size());
+  }
 
   graphics->commandBuffer.endRenderingKHR();
 
+  const auto queueStats = renderQueue.getStats();
+  queuedFrames++;
+  queuedDraws += queueStats.draws;
+  queuedBindsSaved += queueStats.bindsSaved;
+
   graphics->insertImageMemoryBarrier(
       images[currentImageIndex],
       vk::AccessFlagBits::eColorAttachmentWrite,
@@ -555,6 +925,14 @@ void Renderer::draw()
     throw std::runtime_error("Failed present.");
   }
 
+  // The first frame to show the effect of an input closes its latency
+  // sample. Later inputs in the same snapshot are newer, so this measures
+  // the latest input and under-reports earlier ones in a burst.
+  if (frameInputTimestamp > presentedInputTimestamp) {
+    inputLatency.add(inputClock() - frameInputTimestamp);
+    presentedInputTimestamp = frameInputTimestamp;
+  }
+
   if (std::ranges::any_of(
           results, [](const auto& x) { return x != vk::Result::eSuccess; }))
   {
@@ -570,6 +948,24 @@ void Renderer::cleanup()
 
   device->computeQueue.waitIdle();
   device->graphicsQueue.waitIdle();
+  // Buffers retired after the last submit still belong to the allocator
+  if (compute != nullptr) {
+    compute->releaseRetired();
+  }
+  defragmenter.reset();
+  streamingUploader.reset();
+  textures.reset();
+  device->shaderPack = nullptr;
+  assets.reset();
+  galaxyGrid.reset();
+  nbody.reset();
+  particles.reset();
+  scene.reset();
+  clusters.reset();
+  gamePositions.reset();
+  gameColors.reset();
+  gameMeshes.reset();
+  recorder.reset();
   hostBuffers.clear();
   deviceBuffers.clear();
 
@@ -578,9 +974,10 @@ void Renderer::cleanup()
   compute.reset();
   graphics.reset();
 
-  for (const auto& descriptorPool : descriptorPools | std::views::values) {
+  descriptorPools.forEach([this](const vk::DescriptorPool& descriptorPool) {
     device->handle.destroyDescriptorPool(descriptorPool);
-  }
+  });
+  descriptorPools.clear();
 
   // device->handle.destroyCommandPool(commandPool);
   for (const auto& imageView : imagesViews) {
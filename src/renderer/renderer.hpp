@@ -1,21 +1,42 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include <glm/glm.hpp>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_handles.hpp>
 
+#include "../application/cullingGrid.hpp"
+#include "../application/entities.hpp"
+#include "../application/eventPump.hpp"
 #include "../application/game.hpp"
+#include "../application/taskScheduler.hpp"
 #include "../application/window.hpp"
+#include "assets/assetPack.hpp"
 #include "buffers/buffer.hpp"
 #include "buffers/deviceBuffer.hpp"
+#include "buffers/gpuVector.hpp"
 #include "buffers/hostBuffer.hpp"
 #include "compute.hpp"
+#include "defragmenter.hpp"
 #include "device.hpp"
 #include "graphics.hpp"
+#include "images/textureStreamer.hpp"
+#include "parallelRecorder.hpp"
+#include "renderQueue.hpp"
+#include "scene/clusterScene.hpp"
+#include "scene/gpuScene.hpp"
+#include "scene/instanceBatcher.hpp"
+#include "simulation/nbody.hpp"
+#include "simulation/particleSystem.hpp"
+#include "simulation/spatialGrid.hpp"
+#include "slotMap.hpp"
+#include "streamingUploader.hpp"
 #include "vk_mem_alloc.h"
 #include "vulkan/vulkan_enums.hpp"
 #include "vulkan/vulkan_structs.hpp"
@@ -23,10 +44,14 @@
 class Renderer
 {
 public:
-  Renderer(std::string name, Window* window, Game& game);
+  Renderer(std::string name,
+           Window* window,
+           Game& game,
+           TaskScheduler& scheduler);
   ~Renderer();
 
-  HostBuffer& createHostBuffer(
+  // Buffers are addressed by handle; the name is only a debug label
+  Handle<HostBuffer> createHostBuffer(
       const std::string& name,
       size_t size = 0,
       void* data = nullptr,
@@ -37,26 +62,44 @@ public:
           VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
           | VMA_ALLOCATION_CREATE_MAPPED_BIT);
 
-  DeviceBuffer& createDeviceBuffer(
+  Handle<DeviceBuffer> createDeviceBuffer(
       const std::string& name,
       size_t size = 0,
       vk::BufferUsageFlags usageFlags = vk::BufferUsageFlagBits::eStorageBuffer,
       VmaMemoryUsage memoryUsage = VMA_MEMORY_USAGE_AUTO,
-      VmaAllocationCreateFlags flags =
-          VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT);
+      VmaAllocationCreateFlags flags = 0);
+
+  HostBuffer& getHostBuffer(Handle<HostBuffer> handle);
+  DeviceBuffer& getDeviceBuffer(Handle<DeviceBuffer> handle);
+
+  void destroyHostBuffer(Handle<HostBuffer> handle);
+  void destroyDeviceBuffer(Handle<DeviceBuffer> handle);
 
   // void createComputeTask(std::string name);
-  [[noreturn]] void run();
+  // Runs frames until the event pump reports a quit, then waits for the
+  // GPU so the renderer can be destroyed
+  void run(EventPump& events);
 
 private:
+  // graphics.slang: struct UBO
+  struct ParticleUniforms
+  {
+    glm::mat4 projection;
+    glm::mat4 modelview;
+    glm::vec2 screendim;
+  };
+
   std::string appName;
 
   vk::Instance instance {VK_NULL_HANDLE};
 
   Window* window = nullptr;
   Game& game;
+  TaskScheduler& scheduler;
   vk::SurfaceKHR surface {VK_NULL_HANDLE};
-  std::unordered_map<std::string, vk::DescriptorPool> descriptorPools;
+  SlotMap<vk::DescriptorPool> descriptorPools;
+  Handle<vk::DescriptorPool> computeDescriptorPool;
+  Handle<vk::DescriptorPool> graphicsDescriptorPool;
   // vk::CommandPool commandPool {VK_NULL_HANDLE};
   // std::vector<vk::CommandBuffer> commandBuffers;
 
@@ -68,23 +111,113 @@ private:
   // uint32_t currentBuffer {0};  // TODO: not used yet
   std::vector<vk::Image> images;
   std::vector<vk::ImageView> imagesViews;
-  std::unordered_map<std::string, DeviceBuffer> deviceBuffers;
-  std::unordered_map<std::string, HostBuffer> hostBuffers;
+  SlotMap<DeviceBuffer> deviceBuffers;
+  SlotMap<HostBuffer> hostBuffers;
+  Handle<HostBuffer> particleUniformBuffer;
 
   std::vector<vk::Semaphore> recycledSemaphores;
 
   std::unique_ptr<Device> device = nullptr;
   std::unique_ptr<Compute> compute = nullptr;
   std::unique_ptr<Graphics> graphics = nullptr;
+  // Records the render passes into secondary command buffers on the
+  // scheduler's threads; off records them inline on this thread
+  std::unique_ptr<ParallelRecorder> recorder = nullptr;
+  bool parallelRecording = true;
+  // Every draw of a frame, sorted to group state. All of them blend
+  // additively, so their order does not change the image and a single pass
+  // lets the queue group them by pipeline.
+  RenderQueue renderQueue;
+  static constexpr uint8_t additivePass = 0;
+  static constexpr std::size_t drawsPerSlice = 64;
+  uint64_t queuedFrames = 0;
+  uint64_t queuedDraws = 0;
+  uint64_t queuedBindsSaved = 0;
+  // Game entities, drawn as sprites between the two states of the newest
+  // game snapshot; with interpolation off, at the newer state
+  std::unique_ptr<GpuVector<glm::vec4>> gamePositions = nullptr;
+  std::unique_ptr<GpuVector<glm::vec4>> gameColors = nullptr;
+  uint64_t gameColorsTick = 0;
+  // Game entities drawn as meshes instead, with the scene's geometry
+  std::unique_ptr<InstanceBatcher> gameMeshes = nullptr;
+  uint32_t cubeMesh = 0;
+  uint32_t sphereMesh = 0;
+  float cubeRadius = 0.0F;
+  float sphereRadius = 0.0F;
+  // Bounding spheres of the game's meshes, culled on the CPU before they
+  // are batched; gameMeshEntities maps them back to snapshot entities
+  static constexpr float gameCullingCellSize = 0.25F;
+  CullingGrid gameCulling {gameCullingCellSize};
+  AlignedFloats gameBoundsX;
+  AlignedFloats gameBoundsY;
+  AlignedFloats gameBoundsZ;
+  AlignedFloats gameBoundsRadius;
+  std::vector<uint32_t> gameMeshEntities;
+  uint64_t cullingFrames = 0;
+  uint64_t cullingObjects = 0;
+  uint64_t cullingVisible = 0;
+  double cullingMilliseconds = 0.0;
+  bool interpolateGame = true;
+
+  // From an input event's timestamp to the present call of the first frame
+  // showing its effect
+  struct InputLatency
+  {
+    uint64_t samples = 0;
+    double totalMilliseconds = 0.0;
+    double maxMilliseconds = 0.0;
+
+    void add(uint64_t nanoseconds)
+    {
+      const double milliseconds = static_cast<double>(nanoseconds) * 1.0e-6;
+      samples++;
+      totalMilliseconds += milliseconds;
+      maxMilliseconds = std::max(maxMilliseconds, milliseconds);
+    }
+
+    [[nodiscard]] auto averageMilliseconds() const -> double
+    {
+      return totalMilliseconds / static_cast<double>(samples);
+    }
+  };
+  InputLatency inputLatency;
+  uint64_t frameInputTimestamp = 0;
+  uint64_t presentedInputTimestamp = 0;
+  PipelineHandle particlePipeline;
+  // Baked by asset-baker into the build directory; without it, meshes,
+  // textures and the galaxy are generated at startup
+  static constexpr const char* assetPackPath = "assets/scene.pack";
+  std::unique_ptr<AssetPack> assets = nullptr;
+  std::unique_ptr<NBody> nbody = nullptr;
+  std::unique_ptr<SpatialGrid> galaxyGrid = nullptr;
+  CollisionSettings galaxyCollisions;
+  std::unique_ptr<ParticleSystem> particles = nullptr;
+  std::unique_ptr<GpuScene> scene = nullptr;
+  std::unique_ptr<ClusterScene> clusters = nullptr;
+  PipelineHandle scenePipeline;
+  glm::mat4 viewProjection {1.0F};
+  LodView lodView;
+  uint32_t simulationStepsPerFrame = 2;
+  float frameTime = 1.0F / 60.0F;
+  std::unique_ptr<Defragmenter> defragmenter = nullptr;
+  std::unique_ptr<StreamingUploader> streamingUploader = nullptr;
+  std::unique_ptr<TextureStreamer> textures = nullptr;
+  Handle<Texture> particleTexture;
+  Handle<Texture> gradientTexture;
 
 #if !defined(NDEBUG)
   vk::DebugUtilsMessengerEXT debugUtilsMessenger {VK_NULL_HANDLE};
 #endif
 
   void initVulkan();
+  void loadAssets();
   void initCompute();
   void initGraphics();
-  void update() const;
+  // Load their shaders and compile; safe to call from any thread
+  [[nodiscard]] auto createParticlePipeline() const -> vk::Pipeline;
+  [[nodiscard]] auto createScenePipeline() const -> vk::Pipeline;
+  void update();
+  void updateGame();
   void draw();
   void cleanup();
 
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "clusterScene.hpp"
+
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "../shader.hpp"
+#include "frustum.hpp"
+#include "meshOptimizer.hpp"
+#include "meshlet.hpp"
+
+namespace
+{
+// Binding order of the globals in clusterCull.slang
+enum Binding : uint32_t
+{
+  eObjects,
+  eMeshlets,
+  eMeshletVertices,
+  eMeshletTriangles,
+  eClusters,
+  eCommands,
+  eIndices,
+  eBindingCount,
+};
+}  // namespace
+
+ClusterScene::ClusterScene(Device& device,
+                           VmaAllocator& allocator,
+                           Compute& compute)
+    : device(device)
+    , allocator(allocator)
+    , compute(compute)
+    , vertices(device.handle, allocator, vk::BufferUsageFlagBits::eVertexBuffer)
+    , meshlets(
+          device.handle, allocator, vk::BufferUsageFlagBits::eStorageBuffer)
+    , meshletVertices(
+          device.handle, allocator, vk::BufferUsageFlagBits::eStorageBuffer)
+    , meshletTriangles(
+          device.handle, allocator, vk::BufferUsageFlagBits::eStorageBuffer)
+    , objects(device.handle,
+              allocator,
+              vk::BufferUsageFlagBits::eStorageBuffer
+                  | vk::BufferUsageFlagBits::eVertexBuffer)
+    , clusters(
+          device.handle, allocator, vk::BufferUsageFlagBits::eStorageBuffer)
+    , emptyCommands(
+          device.handle, allocator, vk::BufferUsageFlagBits::eStorageBuffer)
+{
+  std::vector<vk::DescriptorSetLayoutBinding> layoutBindings;
+  for (uint32_t binding = 0; binding < eBindingCount; binding++) {
+    layoutBindings.push_back(
+        {.binding = binding,
+         .descriptorType = vk::DescriptorType::eStorageBuffer,
+         .descriptorCount = 1,
+         .stageFlags = vk::ShaderStageFlagBits::eCompute});
+  }
+
+  const auto shader =
+      std::make_unique<Shader>(&device, "clusterCull", "main");
+  cullKernel = compute.createKernel(
+      shader->getShaderStageCreateInfo(vk::ShaderStageFlagBits::eCompute),
+      layoutBindings,
+      sizeof(Params),
+      "cluster cull");
+}
+
+ClusterScene::~ClusterScene()
+{
+  compute.destroyKernel(cullKernel);
+}
+
+auto buildClusterMesh(const MeshData& mesh) -> ClusterMeshData
+{
+  MeshData optimized = mesh;
+  optimizeVertexCache(optimized.indices, optimized.vertices.size());
+  optimizeVertexFetch(optimized);
+  const MeshletData split = buildMeshlets(optimized);
+
+  ClusterMeshData data {.meshlets = {},
+                        .vertices = {},
+                        .meshletVertices = split.vertices,
+                        .triangles = {}};
+  for (const auto& meshlet : split.meshlets) {
+    data.meshlets.push_back(
+        {.centerRadius = glm::vec4(meshlet.center, meshlet.radius),
+         .coneApexCutoff = glm::vec4(meshlet.coneApex, meshlet.coneCutoff),
+         .coneAxis = meshlet.coneAxis,
+         .vertexOffset = meshlet.vertexOffset,
+         .triangleOffset = meshlet.triangleOffset / 3,
+         .triangleCount = meshlet.triangleCount,
+         .padding = {}});
+  }
+  for (const auto& vertex : optimized.vertices) {
+    data.vertices.push_back(packVertex(vertex));
+  }
+  const auto& triangles = split.triangles;
+  for (std::size_t i = 0; i + 2 < triangles.size(); i += 3) {
+    data.triangles.push_back(
+        static_cast<uint32_t>(triangles[i])
+        | (static_cast<uint32_t>(triangles[i + 1]) << 8U)
+        | (static_cast<uint32_t>(triangles[i + 2]) << 16U));
+  }
+  return data;
+}
+
+auto ClusterScene::addMesh(const MeshData& mesh) -> uint32_t
+{
+  const ClusterMeshData data = buildClusterMesh(mesh);
+  return addMesh({.meshlets = data.meshlets,
+                  .vertices = data.vertices,
+                  .meshletVertices = data.meshletVertices,
+                  .triangles = data.triangles});
+}
+
+auto ClusterScene::addMesh(const ClusterMeshView& mesh) -> uint32_t
+{
+  for (const auto& meshlet : mesh.meshlets) {
+    if (meshlet.vertexOffset > mesh.meshletVertices.size()
+        || meshlet.triangleOffset > mesh.triangles.size()
+        || meshlet.triangleCount
+            > mesh.triangles.size() - meshlet.triangleOffset)
+    {
+      throw std::runtime_error("Cluster mesh meshlet out of range.");
+    }
+  }
+
+  stats.meshes++;
+  stats.meshlets += static_cast<uint32_t>(mesh.meshlets.size());
+  stats.meshletVertices += mesh.meshletVertices.size();
+  stats.triangles += mesh.triangles.size();
+
+  const auto firstMeshlet = meshlets.size();
+  meshes.push_back(
+      {.vertexOffset = static_cast<int32_t>(vertices.size()),
+       .firstMeshlet = static_cast<uint32_t>(firstMeshlet),
+       .meshletCount = static_cast<uint32_t>(mesh.meshlets.size()),
+       .indexCount = static_cast<uint32_t>(mesh.triangles.size() * 3)});
+
+  // Only meshes after the first need their meshlets moved past the others'
+  const auto vertexBase = static_cast<uint32_t>(meshletVertices.size());
+  const auto triangleBase = static_cast<uint32_t>(meshletTriangles.size());
+  meshlets.append(mesh.meshlets);
+  if (vertexBase != 0 || triangleBase != 0) {
+    for (auto& meshlet : meshlets.modify(firstMeshlet, mesh.meshlets.size())) {
+      meshlet.vertexOffset += vertexBase;
+      meshlet.triangleOffset += triangleBase;
+    }
+  }
+  meshletVertices.append(mesh.meshletVertices);
+  meshletTriangles.append(mesh.triangles);
+  vertices.append(mesh.vertices);
+
+  return static_cast<uint32_t>(meshes.size() - 1);
+}
+
+auto ClusterScene::addObject(const SceneObject& object) -> uint32_t
+{
+  if (object.mesh >= meshes.size()) {
+    throw std::runtime_error("Cluster object references an unknown mesh.");
+  }
+
+  const Mesh& mesh = meshes[object.mesh];
+  const auto index = objectCount();
+  objects.push_back({.positionScale = glm::vec4(object.position, object.scale),
+                     .color = object.color,
+                     .mesh = object.mesh,
+                     .padding = {}});
+  for (uint32_t i = 0; i < mesh.meshletCount; i++) {
+    clusters.push_back({.object = index, .meshlet = mesh.firstMeshlet + i});
+  }
+
+  // Room for all of the mesh's triangles, in case they are all visible
+  emptyCommands.push_back({.indexCount = 0,
+                           .instanceCount = 1,
+                           .firstIndex = indexCount,
+                           .vertexOffset = mesh.vertexOffset,
+                           .firstInstance = index});
+  indexCount += mesh.indexCount;
+
+  stats.clusters += mesh.meshletCount;
+  return index;
+}
+
+void ClusterScene::sync()
+{
+  if (objects.size() > commandCapacity) {
+    commandCapacity =
+        std::max(static_cast<uint32_t>(objects.size()), commandCapacity * 2);
+    commands = std::make_unique<DeviceBuffer>(
+        device.handle,
+        allocator,
+        commandCapacity * sizeof(vk::DrawIndexedIndirectCommand),
+        vk::BufferUsageFlagBits::eStorageBuffer
+            | vk::BufferUsageFlagBits::eIndirectBuffer);
+  }
+  if (indexCount > indexCapacity) {
+    indexCapacity = std::max(indexCount, indexCapacity * 2);
+    indices = std::make_unique<DeviceBuffer>(
+        device.handle,
+        allocator,
+        indexCapacity * sizeof(uint32_t),
+        vk::BufferUsageFlagBits::eStorageBuffer
+            | vk::BufferUsageFlagBits::eIndexBuffer);
+  }
+
+  if (vertices.isDirty() || meshlets.isDirty() || meshletVertices.isDirty()
+      || meshletTriangles.isDirty() || objects.isDirty() || clusters.isDirty()
+      || emptyCommands.isDirty())
+  {
+    compute.execute([this](vk::CommandBuffer commandBuffer) {
+      vertices.sync(commandBuffer);
+      meshlets.sync(commandBuffer);
+      meshletVertices.sync(commandBuffer);
+      meshletTriangles.sync(commandBuffer);
+      objects.sync(commandBuffer);
+      clusters.sync(commandBuffer);
+      emptyCommands.sync(commandBuffer);
+    });
+  }
+}
+
+void ClusterScene::cull(ComputeBatch& batch,
+                        const glm::mat4& viewProjection,
+                        const glm::vec3& cameraPosition)
+{
+  if (objects.empty()) {
+    return;
+  }
+  sync();
+
+  const auto frustum = Frustum::fromMatrix(viewProjection);
+  const Params params {
+      .planes = frustum.planes,
+      .cameraPosition = cameraPosition,
+      .clusterCount = static_cast<uint32_t>(clusters.size())};
+
+  batch.copy(emptyCommands.buffer(),
+             *commands,
+             objects.size() * sizeof(vk::DrawIndexedIndirectCommand));
+  batch.dispatch(
+      cullKernel,
+      {{.binding = eObjects,
+        .buffer = &objects.buffer(),
+        .access = BufferAccess::eRead},
+       {.binding = eMeshlets,
+        .buffer = &meshlets.buffer(),
+        .access = BufferAccess::eRead},
+       {.binding = eMeshletVertices,
+        .buffer = &meshletVertices.buffer(),
+        .access = BufferAccess::eRead},
+       {.binding = eMeshletTriangles,
+        .buffer = &meshletTriangles.buffer(),
+        .access = BufferAccess::eRead},
+       {.binding = eClusters,
+        .buffer = &clusters.buffer(),
+        .access = BufferAccess::eRead},
+       {.binding = eCommands, .buffer = commands.get()},
+       {.binding = eIndices,
+        .buffer = indices.get(),
+        .access = BufferAccess::eWrite}},
+      GroupCount::cover(params.clusterCount, groupSize),
+      params);
+}
+
+auto ClusterScene::drawItem() -> DrawItem
+{
+  return {.vertexBuffers = {vertices.buffer().getHandle(),
+                            objects.buffer().getHandle()},
+          .indexBuffer = indices->getHandle(),
+          .indexType = vk::IndexType::eUint32,
+          .command = {.type = DrawCommand::Type::eDrawIndexedIndirect,
+                      .count = objectCount(),
+                      .arguments = commands->getHandle(),
+                      .stride = sizeof(vk::DrawIndexedIndirectCommand)}};
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include "../buffers/deviceBuffer.hpp"
+#include "../buffers/gpuVector.hpp"
+#include "../compute.hpp"
+#include "../computeBatch.hpp"
+#include "../device.hpp"
+#include "../renderQueue.hpp"
+#include "../shaderLayout.hpp"
+#include "gpuScene.hpp"
+#include "mesh.hpp"
+#include "meshlet.hpp"
+#include "vk_mem_alloc.h"
+
+// clusterCull.slang: struct Meshlet
+struct GpuMeshlet
+{
+  glm::vec4 centerRadius;  // Bounding sphere, in mesh space
+  glm::vec4 coneApexCutoff;
+  glm::vec3 coneAxis;
+  uint32_t vertexOffset;  // Into the meshlet vertex buffer
+  uint32_t triangleOffset;  // Into the meshlet triangle buffer
+  uint32_t triangleCount;
+  std::array<uint32_t, 2> padding;
+};
+
+template <>
+struct ShaderLayout<GpuMeshlet>
+{
+  static constexpr std::size_t stride = 64;
+
+  static_assert(offsetof(GpuMeshlet, coneApexCutoff) == 16);
+  static_assert(offsetof(GpuMeshlet, coneAxis) == 32);
+  static_assert(offsetof(GpuMeshlet, vertexOffset) == 44);
+  static_assert(offsetof(GpuMeshlet, triangleCount) == 52);
+};
+
+// A mesh as ClusterScene stores it: reordered for the vertex cache and
+// vertex fetch and split into meshlets, with packed vertices and each
+// triangle's three 8-bit meshlet vertex indices in one word. Meshlet offsets
+// are relative to the mesh's own meshlet vertices and triangles.
+struct ClusterMeshData
+{
+  std::vector<GpuMeshlet> meshlets;
+  std::vector<PackedVertex> vertices;
+  std::vector<uint32_t> meshletVertices;
+  std::vector<uint32_t> triangles;
+};
+
+// ClusterMeshData in memory owned elsewhere, such as a mapped asset pack
+struct ClusterMeshView
+{
+  std::span<const GpuMeshlet> meshlets;
+  std::span<const PackedVertex> vertices;
+  std::span<const uint32_t> meshletVertices;
+  std::span<const uint32_t> triangles;
+};
+
+// Optimizes mesh, splits it into meshlets and packs it
+auto buildClusterMesh(const MeshData& mesh) -> ClusterMeshData;
+
+// clusterCull.slang: struct Cluster, one meshlet of one object
+struct GpuCluster
+{
+  uint32_t object;
+  uint32_t meshlet;
+};
+
+template <>
+struct ShaderLayout<GpuCluster>
+{
+  static constexpr std::size_t stride = 8;
+};
+
+// clusterCull.slang: struct DrawIndexedIndirectCommand
+template <>
+struct ShaderLayout<vk::DrawIndexedIndirectCommand>
+{
+  static constexpr std::size_t stride = 20;
+};
+
+// Objects culled a meshlet at a time on the GPU, for dense meshes that
+// GpuScene could only draw whole.
+//
+// Meshes are split into meshlets (see buildClusterMesh()) and every object
+// instantiates all meshlets of its mesh as clusters. Every frame
+// clusterCull.slang tests each cluster's bounding sphere against the frustum
+// and its normal cone against the camera, and writes the indices of the
+// surviving triangles into the object's range of one index buffer, so the
+// triangles facing away or outside the view are never sent to the vertex
+// shader. drawItem() then draws all objects with a single
+// drawIndexedIndirect; objects without visible clusters draw nothing.
+//
+// Objects use the same vertex input as GpuScene, so they draw with the
+// scene pipeline, and cannot be changed once added.
+class ClusterScene
+{
+public:
+  static constexpr uint32_t groupSize = 64;  // GROUP_SIZE in clusterCull.slang
+
+  // Of the meshes and objects added so far
+  struct Stats
+  {
+    uint32_t meshes = 0;
+    uint32_t meshlets = 0;
+    uint64_t meshletVertices = 0;
+    uint64_t triangles = 0;
+    uint64_t clusters = 0;
+  };
+
+  ClusterScene(Device& device, VmaAllocator& allocator, Compute& compute);
+  ~ClusterScene();
+
+  ClusterScene(const ClusterScene&) = delete;
+  ClusterScene& operator=(const ClusterScene&) = delete;
+  ClusterScene(ClusterScene&&) = delete;
+  ClusterScene& operator=(ClusterScene&&) = delete;
+
+  // Appends the mesh, from buildClusterMesh(), to the shared buffers and
+  // returns its index
+  auto addMesh(const MeshData& mesh) -> uint32_t;
+
+  // Same for a mesh that was already built, e.g. when baked into an asset
+  // pack. Its buffers are appended as they are.
+  auto addMesh(const ClusterMeshView& mesh) -> uint32_t;
+
+  auto addObject(const SceneObject& object) -> uint32_t;
+
+  // Uploads pending changes, then enqueues the pass that writes this frame's
+  // visible triangles and draw commands. Must be called after the previous
+  // frame's draw has completed.
+  void cull(ComputeBatch& batch,
+            const glm::mat4& viewProjection,
+            const glm::vec3& cameraPosition);
+
+  // The indirect draw of all objects, for a pipeline created with
+  // GpuScene::vertexInputState(). Only valid once there are objects.
+  [[nodiscard]] auto drawItem() -> DrawItem;
+
+  [[nodiscard]] auto objectCount() const -> uint32_t
+  {
+    return static_cast<uint32_t>(objects.size());
+  }
+
+  [[nodiscard]] auto getStats() const -> Stats { return stats; }
+
+private:
+  // Matches Params in clusterCull.slang
+  struct Params
+  {
+    std::array<glm::vec4, 6> planes;
+    glm::vec3 cameraPosition;
+    uint32_t clusterCount;
+  };
+
+  struct Mesh
+  {
+    int32_t vertexOffset;
+    uint32_t firstMeshlet;
+    uint32_t meshletCount;
+    uint32_t indexCount;
+  };
+
+  Device& device;
+  VmaAllocator& allocator;
+  Compute& compute;
+
+  KernelHandle cullKernel;
+
+  std::vector<Mesh> meshes;
+  GpuVector<PackedVertex> vertices;
+  GpuVector<GpuMeshlet> meshlets;
+  GpuVector<uint32_t> meshletVertices;
+  // Three 8-bit meshlet vertex indices per triangle
+  GpuVector<uint32_t> meshletTriangles;
+  GpuVector<GpuObject> objects;
+  GpuVector<GpuCluster> clusters;
+  // Each object's command with no indices, copied over commands every frame
+  // before the clusters add theirs
+  GpuVector<vk::DrawIndexedIndirectCommand> emptyCommands;
+
+  std::unique_ptr<DeviceBuffer> commands;
+  std::unique_ptr<DeviceBuffer> indices;
+  uint32_t commandCapacity = 0;
+  uint32_t indexCount = 0;
+  uint32_t indexCapacity = 0;
+
+  Stats stats;
+
+  void sync();
+};
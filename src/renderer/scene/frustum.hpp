@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+// Six inward-facing planes (xyz: normal, w: distance) extracted from a
+// view-projection matrix with Vulkan's [0, 1] clip depth. A point p is
+// inside a plane when dot(plane.xyz, p) + plane.w >= 0.
+struct Frustum
+{
+  std::array<glm::vec4, 6> planes;
+
+  static auto fromMatrix(const glm::mat4& viewProjection) -> Frustum
+  {
+    // glm is column-major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    const auto row = [&](int i) {
+      return glm::vec4(viewProjection[0][i],
+                       viewProjection[1][i],
+                       viewProjection[2][i],
+                       viewProjection[3][i]);
+    };
+
+    Frustum frustum {.planes = {row(3) + row(0),  // Left
+                                row(3) - row(0),  // Right
+                                row(3) + row(1),  // Bottom
+                                row(3) - row(1),  // Top
+                                row(2),  // Near
+                                row(3) - row(2)}};  // Far
+
+    for (auto& plane : frustum.planes) {
+      plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+  }
+
+  [[nodiscard]] auto intersectsSphere(const glm::vec3& center,
+                                      float radius) const -> bool
+  {
+    for (const auto& plane : planes) {
+      if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
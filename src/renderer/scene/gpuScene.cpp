@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "gpuScene.hpp"
+
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "../shader.hpp"
+#include "frustum.hpp"
+#include "meshLod.hpp"
+#include "meshOptimizer.hpp"
+
+namespace
+{
+// Binding order of the globals in cull.slang
+enum Binding : uint32_t
+{
+  eObjects,
+  eMeshes,
+  eCommands,
+  eDrawCount,
+  eObjectLods,
+  eBindingCount,
+};
+}  // namespace
+
+GpuScene::GpuScene(Device& device, VmaAllocator& allocator, Compute& compute)
+    : device(device)
+    , allocator(allocator)
+    , compute(compute)
+    , vertices(device.handle, allocator, vk::BufferUsageFlagBits::eVertexBuffer)
+    , indices(device.handle, allocator, vk::BufferUsageFlagBits::eIndexBuffer)
+    , meshes(device.handle, allocator, vk::BufferUsageFlagBits::eStorageBuffer)
+    , objects(device.handle,
+              allocator,
+              vk::BufferUsageFlagBits::eStorageBuffer
+                  | vk::BufferUsageFlagBits::eVertexBuffer)
+{
+  drawCount = std::make_unique<DeviceBuffer>(
+      device.handle,
+      allocator,
+      sizeof(uint32_t),
+      vk::BufferUsageFlagBits::eStorageBuffer
+          | vk::BufferUsageFlagBits::eIndirectBuffer);
+
+  std::vector<vk::DescriptorSetLayoutBinding> layoutBindings;
+  for (uint32_t binding = 0; binding < eBindingCount; binding++) {
+    layoutBindings.push_back(
+        {.binding = binding,
+         .descriptorType = vk::DescriptorType::eStorageBuffer,
+         .descriptorCount = 1,
+         .stageFlags = vk::ShaderStageFlagBits::eCompute});
+  }
+
+  const auto shader = std::make_unique<Shader>(&device, "cull", "main");
+  cullKernel = compute.createKernel(
+      shader->getShaderStageCreateInfo(vk::ShaderStageFlagBits::eCompute),
+      layoutBindings,
+      sizeof(Params),
+      "cull");
+}
+
+GpuScene::~GpuScene()
+{
+  compute.destroyKernel(cullKernel);
+}
+
+auto buildSceneMesh(const MeshData& mesh) -> SceneMeshData
+{
+  LodChain chain = buildLodChain(mesh, GpuMesh::maxLods);
+  for (const auto& level : chain.levels) {
+    optimizeVertexCache(
+        std::span(chain.mesh.indices).subspan(level.firstIndex,
+                                              level.indexCount),
+        chain.mesh.vertices.size());
+  }
+  optimizeVertexFetch(chain.mesh);
+  if (chain.mesh.vertices.size() > GpuScene::maxMeshVertices) {
+    throw std::runtime_error("Scene mesh has too many vertices for 16-bit "
+                             "indices.");
+  }
+
+  const auto finest = std::span(chain.mesh.indices)
+                          .first(chain.levels.front().indexCount);
+  SceneMeshData data {
+      .info = {.radius = mesh.boundingRadius(),
+               .cacheMisses = static_cast<uint32_t>(
+                   countCacheMisses(finest, chain.mesh.vertices.size())),
+               .unoptimizedCacheMisses = static_cast<uint32_t>(
+                   countCacheMisses(mesh.indices, mesh.vertices.size())),
+               .padding = 0},
+      .levels = chain.levels,
+      .vertices = {},
+      .indices = {}};
+  for (const auto& vertex : chain.mesh.vertices) {
+    data.vertices.push_back(packVertex(vertex));
+  }
+  for (const auto index : chain.mesh.indices) {
+    data.indices.push_back(static_cast<uint16_t>(index));
+  }
+  return data;
+}
+
+auto GpuScene::addMesh(const MeshData& mesh) -> uint32_t
+{
+  const SceneMeshData data = buildSceneMesh(mesh);
+  return addMesh({.info = data.info,
+                  .levels = data.levels,
+                  .vertices = data.vertices,
+                  .indices = data.indices});
+}
+
+auto GpuScene::addMesh(const SceneMeshView& mesh) -> uint32_t
+{
+  if (mesh.levels.empty() || mesh.levels.size() > GpuMesh::maxLods
+      || mesh.vertices.size() > maxMeshVertices)
+  {
+    throw std::runtime_error("Scene mesh exceeds the scene's limits.");
+  }
+  for (const auto& level : mesh.levels) {
+    if (level.firstIndex > mesh.indices.size()
+        || level.indexCount > mesh.indices.size() - level.firstIndex)
+    {
+      throw std::runtime_error("Scene mesh level out of range.");
+    }
+  }
+
+  stats.meshes++;
+  stats.lods += static_cast<uint32_t>(mesh.levels.size());
+  stats.triangles += mesh.levels.front().indexCount / 3;
+  stats.cacheMisses += mesh.info.cacheMisses;
+  stats.unoptimizedCacheMisses += mesh.info.unoptimizedCacheMisses;
+  stats.geometryBytes +=
+      (mesh.vertices.size() * ShaderLayout<PackedVertex>::stride)
+      + (mesh.indices.size() * ShaderLayout<uint16_t>::stride);
+  stats.unpackedGeometryBytes += (mesh.vertices.size() * sizeof(MeshVertex))
+      + (mesh.indices.size() * sizeof(uint32_t));
+
+  const auto firstIndex = static_cast<uint32_t>(indices.size());
+  GpuMesh gpuMesh {.vertexOffset = static_cast<int32_t>(vertices.size()),
+                   .radius = mesh.info.radius,
+                   .lodCount = static_cast<uint32_t>(mesh.levels.size()),
+                   .padding = 0,
+                   .lods = {}};
+  for (std::size_t lod = 0; lod < mesh.levels.size(); lod++) {
+    const auto& level = mesh.levels[lod];
+    gpuMesh.lods[lod] = {.firstIndex = firstIndex + level.firstIndex,
+                         .indexCount = level.indexCount,
+                         .error = level.error,
+                         .padding = 0};
+  }
+  meshes.push_back(gpuMesh);
+
+  vertices.append(mesh.vertices);
+  indices.append(mesh.indices);
+
+  return static_cast<uint32_t>(meshes.size() - 1);
+}
+
+auto GpuScene::addObject(const SceneObject& object) -> uint32_t
+{
+  objects.push_back({});
+  const auto index = objectCount() - 1;
+  setObject(index, object);
+  return index;
+}
+
+void GpuScene::setObject(uint32_t index, const SceneObject& object)
+{
+  if (object.mesh >= meshes.size()) {
+    throw std::runtime_error("Scene object references an unknown mesh.");
+  }
+
+  objects.set(index,
+              {.positionScale = glm::vec4(object.position, object.scale),
+               .color = object.color,
+               .mesh = object.mesh,
+               .padding = {}});
+}
+
+void GpuScene::sync()
+{
+  // One command per object at most
+  if (objects.size() > commandCapacity) {
+    commandCapacity =
+        std::max(static_cast<uint32_t>(objects.size()), commandCapacity * 2);
+    commands = std::make_unique<DeviceBuffer>(
+        device.handle,
+        allocator,
+        commandCapacity * sizeof(vk::DrawIndexedIndirectCommand),
+        vk::BufferUsageFlagBits::eStorageBuffer
+            | vk::BufferUsageFlagBits::eIndirectBuffer);
+    objectLods = std::make_unique<DeviceBuffer>(
+        device.handle,
+        allocator,
+        commandCapacity * sizeof(uint32_t),
+        vk::BufferUsageFlagBits::eStorageBuffer);
+    objectLodsCleared = false;
+  }
+
+  if (vertices.isDirty() || indices.isDirty() || meshes.isDirty()
+      || objects.isDirty())
+  {
+    compute.execute([this](vk::CommandBuffer commandBuffer) {
+      vertices.sync(commandBuffer);
+      indices.sync(commandBuffer);
+      meshes.sync(commandBuffer);
+      objects.sync(commandBuffer);
+    });
+  }
+}
+
+void GpuScene::cull(ComputeBatch& batch,
+                    const glm::mat4& viewProjection,
+                    const LodView& view)
+{
+  // Geometry is uploaded even without objects, for meshDrawItem()
+  sync();
+  if (objects.empty()) {
+    return;
+  }
+
+  const auto frustum = Frustum::fromMatrix(viewProjection);
+  const Params params {.planes = frustum.planes,
+                       .cameraPosition = view.cameraPosition,
+                       .objectCount = objectCount(),
+                       .pixelsPerUnit = view.pixelsPerUnit,
+                       .lodErrorPixels = lodSettings.errorPixels,
+                       .lodHysteresis = lodSettings.hysteresis};
+
+  if (!objectLodsCleared) {
+    batch.fill(*objectLods, 0);
+    objectLodsCleared = true;
+  }
+  batch.fill(*drawCount, 0);
+  if (!device.features.drawIndirectCount) {
+    batch.fill(*commands, 0);
+  }
+
+  batch.dispatch(
+      cullKernel,
+      {{.binding = eObjects,
+        .buffer = &objects.buffer(),
+        .access = BufferAccess::eRead},
+       {.binding = eMeshes,
+        .buffer = &meshes.buffer(),
+        .access = BufferAccess::eRead},
+       {.binding = eCommands,
+        .buffer = commands.get(),
+        .access = BufferAccess::eWrite},
+       {.binding = eDrawCount, .buffer = drawCount.get()},
+       {.binding = eObjectLods, .buffer = objectLods.get()}},
+      GroupCount::cover(objectCount(), groupSize),
+      params);
+}
+
+auto GpuScene::drawItem() -> DrawItem
+{
+  DrawItem item {
+      .vertexBuffers = {vertices.buffer().getHandle(),
+                        objects.buffer().getHandle()},
+      .indexBuffer = indices.buffer().getHandle(),
+      .indexType = vk::IndexType::eUint16,
+      .command = {.type = DrawCommand::Type::eDrawIndexedIndirectCount,
+                  .count = objectCount(),
+                  .arguments = commands->getHandle(),
+                  .stride = sizeof(vk::DrawIndexedIndirectCommand),
+                  .countBuffer = drawCount->getHandle()}};
+
+  // Slots past the visible count were cleared and draw nothing
+  if (!device.features.drawIndirectCount) {
+    item.command.type = DrawCommand::Type::eDrawIndexedIndirect;
+  }
+  return item;
+}
+
+auto GpuScene::meshDrawItem(uint32_t mesh,
+                            vk::Buffer instances,
+                            uint32_t firstInstance,
+                            uint32_t instanceCount) -> DrawItem
+{
+  const GpuMesh& geometry = meshes[mesh];
+  const GpuMeshLod& finest = geometry.lods[0];
+  return {.vertexBuffers = {vertices.buffer().getHandle(), instances},
+          .indexBuffer = indices.buffer().getHandle(),
+          .indexType = vk::IndexType::eUint16,
+          .command = {.type = DrawCommand::Type::eDrawIndexed,
+                      .count = finest.indexCount,
+                      .instanceCount = instanceCount,
+                      .first = finest.firstIndex,
+                      .vertexOffset = geometry.vertexOffset,
+                      .firstInstance = firstInstance}};
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include "../buffers/deviceBuffer.hpp"
+#include "../buffers/gpuVector.hpp"
+#include "../compute.hpp"
+#include "../computeBatch.hpp"
+#include "../device.hpp"
+#include "../renderQueue.hpp"
+#include "../shaderLayout.hpp"
+#include "mesh.hpp"
+#include "meshLod.hpp"
+#include "vk_mem_alloc.h"
+
+struct SceneObject
+{
+  glm::vec3 position {0.0F};
+  float scale = 1.0F;
+  glm::vec4 color {1.0F};
+  uint32_t mesh = 0;
+};
+
+// cull.slang: struct Object
+struct GpuObject
+{
+  glm::vec4 positionScale;
+  glm::vec4 color;
+  uint32_t mesh;
+  std::array<uint32_t, 3> padding;
+};
+
+template <>
+struct ShaderLayout<GpuObject>
+{
+  static constexpr std::size_t stride = 48;
+
+  static_assert(offsetof(GpuObject, positionScale) == 0);
+  static_assert(offsetof(GpuObject, color) == 16);
+  static_assert(offsetof(GpuObject, mesh) == 32);
+};
+
+// cull.slang: struct MeshLod
+struct GpuMeshLod
+{
+  uint32_t firstIndex;
+  uint32_t indexCount;
+  float error;  // LodChain::Level::error
+  uint32_t padding;
+};
+
+template <>
+struct ShaderLayout<GpuMeshLod>
+{
+  static constexpr std::size_t stride = 16;
+
+  static_assert(offsetof(GpuMeshLod, error) == 8);
+};
+
+// cull.slang: struct Mesh
+struct GpuMesh
+{
+  static constexpr uint32_t maxLods = 4;  // MAX_LODS in cull.slang
+
+  int32_t vertexOffset;
+  float radius;
+  uint32_t lodCount;
+  uint32_t padding;
+  std::array<GpuMeshLod, maxLods> lods;  // Finest first
+};
+
+template <>
+struct ShaderLayout<GpuMesh>
+{
+  static constexpr std::size_t stride = 80;
+
+  static_assert(offsetof(GpuMesh, radius) == 4);
+  static_assert(offsetof(GpuMesh, lodCount) == 8);
+  static_assert(offsetof(GpuMesh, lods) == 16);
+};
+
+struct SceneMeshInfo
+{
+  float radius;  // MeshData::boundingRadius()
+  // Of the finest level, see GpuScene::Stats
+  uint32_t cacheMisses;
+  uint32_t unoptimizedCacheMisses;
+  uint32_t padding;
+};
+
+// A mesh as GpuScene stores it: its levels of detail, reordered for the
+// vertex cache and vertex fetch, with packed vertices and 16-bit indices
+struct SceneMeshData
+{
+  SceneMeshInfo info;
+  std::vector<LodChain::Level> levels;
+  std::vector<PackedVertex> vertices;
+  std::vector<uint16_t> indices;
+};
+
+// SceneMeshData in memory owned elsewhere, such as a mapped asset pack
+struct SceneMeshView
+{
+  SceneMeshInfo info;
+  std::span<const LodChain::Level> levels;
+  std::span<const PackedVertex> vertices;
+  std::span<const uint16_t> indices;
+};
+
+// Builds up to GpuMesh::maxLods levels of detail of mesh and optimizes and
+// packs them. Throws if they have more than GpuScene::maxMeshVertices
+// vertices together.
+auto buildSceneMesh(const MeshData& mesh) -> SceneMeshData;
+
+// How cull.slang picks each object's level of detail: the coarsest whose
+// error, projected to the screen, stays within errorPixels. Refining is
+// immediate, but an object only coarsens once the next level's error falls
+// below errorPixels * hysteresis, so objects near a threshold do not switch
+// back and forth every frame.
+struct LodSettings
+{
+  float errorPixels = 1.0F;
+  float hysteresis = 0.75F;
+};
+
+// The camera as LOD selection needs it
+struct LodView
+{
+  glm::vec3 cameraPosition {0.0F};
+  // Pixels covered by one unit at distance one: the projection's y scale
+  // times half the viewport height
+  float pixelsPerUnit = 1.0F;
+};
+
+// Objects whose visibility, level of detail and draw calls are decided on
+// the GPU.
+//
+// Meshes share one vertex and one index buffer, with a chain of levels of
+// detail each, and object data lives in a storage buffer. Every frame
+// cull.slang tests each object against the frustum, picks a level for the
+// visible ones and appends a vk::DrawIndexedIndirectCommand for it,
+// then drawItem() consumes them with a single drawIndexedIndirectCount, so the
+// host cost is the same for ten objects as for a million. Without the
+// drawIndirectCount feature the command buffer is cleared first and all
+// slots are drawn; the empty ones draw nothing.
+class GpuScene
+{
+public:
+  static constexpr uint32_t groupSize = 256;  // GROUP_SIZE in cull.slang
+  static constexpr std::size_t maxMeshVertices = 1 << 16;
+
+  // Of the meshes added so far
+  struct Stats
+  {
+    uint32_t meshes = 0;
+    uint32_t lods = 0;
+    uint64_t triangles = 0;  // Of the finest levels
+    // Vertices transformed for the finest levels with a vertexCacheSize
+    // FIFO cache
+    uint64_t cacheMisses = 0;
+    uint64_t unoptimizedCacheMisses = 0;
+    uint64_t geometryBytes = 0;
+    // As MeshVertex and 32-bit indices
+    uint64_t unpackedGeometryBytes = 0;
+  };
+
+  GpuScene(Device& device, VmaAllocator& allocator, Compute& compute);
+  ~GpuScene();
+
+  GpuScene(const GpuScene&) = delete;
+  GpuScene& operator=(const GpuScene&) = delete;
+  GpuScene(GpuScene&&) = delete;
+  GpuScene& operator=(GpuScene&&) = delete;
+
+  // Appends the mesh and its levels of detail, from buildSceneMesh(), to
+  // the shared geometry buffers and returns its index
+  auto addMesh(const MeshData& mesh) -> uint32_t;
+
+  // Same for a mesh built ahead of time, e.g. baked into an asset pack,
+  // which is appended as it is
+  auto addMesh(const SceneMeshView& mesh) -> uint32_t;
+
+  auto addObject(const SceneObject& object) -> uint32_t;
+  void setObject(uint32_t index, const SceneObject& object);
+
+  // Uploads pending changes, then enqueues the culling pass that writes this
+  // frame's draw commands. Must be called after the previous frame's draw
+  // has completed.
+  void cull(ComputeBatch& batch,
+            const glm::mat4& viewProjection,
+            const LodView& view);
+
+  // The indirect draw of the visible objects, for a pipeline created with
+  // vertexInputState(). Only valid once there are objects.
+  [[nodiscard]] auto drawItem() -> DrawItem;
+
+  // A draw of mesh's finest level with the shared vertex and index buffers,
+  // for instances from elsewhere in binding 1. Only valid once cull() has
+  // uploaded them.
+  [[nodiscard]] auto meshDrawItem(uint32_t mesh,
+                                  vk::Buffer instances,
+                                  uint32_t firstInstance,
+                                  uint32_t instanceCount) -> DrawItem;
+
+
+  [[nodiscard]] auto objectCount() const -> uint32_t
+  {
+    return static_cast<uint32_t>(objects.size());
+  }
+
+  [[nodiscard]] auto getStats() const -> Stats { return stats; }
+
+  LodSettings lodSettings;
+
+  // Binding 0: PackedVertex per vertex, binding 1: GpuObject per instance
+  static constexpr std::array<vk::VertexInputBindingDescription, 2>
+      vertexBindings = {{
+          {.binding = 0,
+           .stride = ShaderLayout<PackedVertex>::stride,
+           .inputRate = vk::VertexInputRate::eVertex},
+          {.binding = 1,
+           .stride = ShaderLayout<GpuObject>::stride,
+           .inputRate = vk::VertexInputRate::eInstance},
+      }};
+
+  static constexpr std::array<vk::VertexInputAttributeDescription, 4>
+      vertexAttributes = {{
+          {.location = 0,
+           .binding = 0,
+           .format = vk::Format::eR16G16B16A16Sfloat,
+           .offset = offsetof(PackedVertex, position)},
+          {.location = 1,
+           .binding = 0,
+           .format = vk::Format::eR8G8Snorm,
+           .offset = offsetof(PackedVertex, normal)},
+          {.location = 2,
+           .binding = 1,
+           .format = vk::Format::eR32G32B32A32Sfloat,
+           .offset = offsetof(GpuObject, positionScale)},
+          {.location = 3,
+           .binding = 1,
+           .format = vk::Format::eR32G32B32A32Sfloat,
+           .offset = offsetof(GpuObject, color)},
+      }};
+
+  static auto vertexInputState() -> vk::PipelineVertexInputStateCreateInfo
+  {
+    return {.vertexBindingDescriptionCount =
+                static_cast<uint32_t>(vertexBindings.size()),
+            .pVertexBindingDescriptions = vertexBindings.data(),
+            .vertexAttributeDescriptionCount =
+                static_cast<uint32_t>(vertexAttributes.size()),
+            .pVertexAttributeDescriptions = vertexAttributes.data()};
+  }
+
+private:
+  // Matches Params in cull.slang
+  struct Params
+  {
+    std::array<glm::vec4, 6> planes;
+    glm::vec3 cameraPosition;
+    uint32_t objectCount;
+    float pixelsPerUnit;
+    float lodErrorPixels;
+    float lodHysteresis;
+  };
+
+  Device& device;
+  VmaAllocator& allocator;
+  Compute& compute;
+
+  KernelHandle cullKernel;
+
+  GpuVector<PackedVertex> vertices;
+  GpuVector<uint16_t> indices;
+  GpuVector<GpuMesh> meshes;
+  GpuVector<GpuObject> objects;
+
+  std::unique_ptr<DeviceBuffer> commands;
+  std::unique_ptr<DeviceBuffer> drawCount;
+  // Level each object was last drawn at, for hysteresis; sized like
+  // commands and cleared when reallocated
+  std::unique_ptr<DeviceBuffer> objectLods;
+  bool objectLodsCleared = false;
+  uint32_t commandCapacity = 0;
+
+  Stats stats;
+
+  void sync();
+};
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <span>
+
+#include "instanceBatcher.hpp"
+
+InstanceBatcher::InstanceBatcher(vk::Device& device, VmaAllocator& allocator)
+    : instances(device, allocator, vk::BufferUsageFlagBits::eVertexBuffer)
+{
+}
+
+void InstanceBatcher::clear()
+{
+  batches.clear();
+  batchOfKey.clear();
+  objects.clear();
+  objectBatches.clear();
+}
+
+void InstanceBatcher::build()
+{
+  // Instances are laid out in pipeline and mesh order
+  std::ranges::sort(batches,
+                    {},
+                    [](const Batch& batch)
+                    { return keyOf(batch.pipeline, batch.mesh); });
+
+  // objectBatches still index batches as they were before sorting
+  cursors.resize(batches.size());
+  uint32_t firstInstance = 0;
+  for (auto& batch : batches) {
+    batch.firstInstance = firstInstance;
+    cursors[batchOfKey[keyOf(batch.pipeline, batch.mesh)]] = firstInstance;
+    firstInstance += batch.instanceCount;
+  }
+
+  instances.resize(objects.size());
+  const std::span<GpuObject> written = instances.modify(0, objects.size());
+  for (std::size_t i = 0; i < objects.size(); i++) {
+    written[cursors[objectBatches[i]]++] = objects[i];
+  }
+
+  // Sorting invalidated the indices in batchOfKey
+  batchOfKey.clear();
+
+  stats.objects = static_cast<uint32_t>(objects.size());
+  stats.batches = static_cast<uint32_t>(batches.size());
+}
+
+void InstanceBatcher::submit(RenderQueue& queue,
+                             GpuScene& scene,
+                             uint8_t pass,
+                             vk::DescriptorSet descriptorSet)
+{
+  for (const auto& batch : batches) {
+    DrawItem item = scene.meshDrawItem(batch.mesh,
+                                       instances.buffer().getHandle(),
+                                       batch.firstInstance,
+                                       batch.instanceCount);
+    item.key = RenderQueue::makeKey(
+        pass, batch.pipeline, static_cast<uint16_t>(batch.mesh), 0.0F);
+    item.pipeline = batch.pipeline;
+    item.descriptorSet = descriptorSet;
+    queue.submit(item);
+  }
+}
+
+auto InstanceBatcher::batchFor(PipelineHandle pipeline, uint32_t mesh)
+    -> uint32_t
+{
+  const uint64_t key = keyOf(pipeline, mesh);
+  if (!batches.empty() && key == lastKey) {
+    return lastBatch;
+  }
+
+  const auto [found, inserted] =
+      batchOfKey.try_emplace(key, static_cast<uint32_t>(batches.size()));
+  if (inserted) {
+    batches.push_back({.pipeline = pipeline,
+                       .mesh = mesh,
+                       .firstInstance = 0,
+                       .instanceCount = 0});
+  }
+  lastKey = key;
+  lastBatch = found->second;
+  return lastBatch;
+}
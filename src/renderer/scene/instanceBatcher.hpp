@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "../buffers/gpuVector.hpp"
+#include "../executor.hpp"
+#include "../renderQueue.hpp"
+#include "gpuScene.hpp"
+#include "vk_mem_alloc.h"
+
+// Merges objects submitted from the host into instanced draws.
+//
+// Objects are added one at a time every frame with the pipeline and scene
+// mesh to draw them with. build() groups them by pipeline and mesh and
+// writes each group's instances next to each other into one instance
+// buffer, so submit() queues a single drawIndexed per group, with the group
+// as its instance range, instead of one per object.
+//
+// Instances use GpuScene's layout and are read through the same
+// instance-rate binding as its GPU-culled objects, so any pipeline created
+// with GpuScene::vertexInputState() can draw them.
+class InstanceBatcher
+{
+public:
+  struct Batch
+  {
+    PipelineHandle pipeline;
+    uint32_t mesh;
+    uint32_t firstInstance;
+    uint32_t instanceCount;
+  };
+
+  struct Stats
+  {
+    uint32_t objects = 0;
+    uint32_t batches = 0;
+  };
+
+  InstanceBatcher(vk::Device& device, VmaAllocator& allocator);
+  ~InstanceBatcher() = default;
+
+  InstanceBatcher(const InstanceBatcher&) = delete;
+  InstanceBatcher& operator=(const InstanceBatcher&) = delete;
+  InstanceBatcher(InstanceBatcher&&) = delete;
+  InstanceBatcher& operator=(InstanceBatcher&&) = delete;
+
+  // Forgets the previous frame's objects
+  void clear();
+
+  void add(PipelineHandle pipeline, uint32_t mesh, const GpuObject& instance)
+  {
+    const uint32_t batch = batchFor(pipeline, mesh);
+    batches[batch].instanceCount++;
+    objectBatches.push_back(batch);
+    objects.push_back(instance);
+  }
+
+  [[nodiscard]] auto objectCount() const -> std::size_t
+  {
+    return objects.size();
+  }
+
+  // Sorts the batches and writes the objects added since clear() to the
+  // instance buffer, which is uploaded on the next sync()
+  void build();
+
+  // Records the instance upload; see GpuVector::sync()
+  void sync(vk::CommandBuffer commandBuffer) { instances.sync(commandBuffer); }
+
+  // Queues one draw per batch with the scene's geometry, keyed by pass,
+  // pipeline and mesh
+  void submit(RenderQueue& queue,
+              GpuScene& scene,
+              uint8_t pass,
+              vk::DescriptorSet descriptorSet);
+
+  // In draw order once built
+  [[nodiscard]] auto getBatches() const -> const std::vector<Batch>&
+  {
+    return batches;
+  }
+
+  [[nodiscard]] auto getStats() const -> Stats { return stats; }
+
+private:
+  // Pipeline in the high bits, so batches sorted by key share pipelines
+  static auto keyOf(PipelineHandle pipeline, uint32_t mesh) -> uint64_t
+  {
+    return (static_cast<uint64_t>(pipeline.index) << 32) | mesh;
+  }
+
+  std::vector<Batch> batches;
+  std::unordered_map<uint64_t, uint32_t> batchOfKey;
+  // Objects mostly arrive in runs of the same batch, which skip the lookup
+  uint64_t lastKey = 0;
+  uint32_t lastBatch = 0;
+
+  std::vector<GpuObject> objects;
+  std::vector<uint32_t> objectBatches;
+  std::vector<uint32_t> cursors;  // Next instance per batch, in build()
+
+  GpuVector<GpuObject> instances;
+  Stats stats;
+
+  auto batchFor(PipelineHandle pipeline, uint32_t mesh) -> uint32_t;
+};
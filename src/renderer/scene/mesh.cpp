@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+#include "mesh.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+auto MeshData::boundingRadius() const -> float
+{
+  float radius = 0.0F;
+  for (const auto& vertex : vertices) {
+    radius = std::max(radius, glm::length(vertex.position));
+  }
+  return radius;
+}
+
+auto octahedralEncode(const glm::vec3& normal) -> glm::vec2
+{
+  const glm::vec3 n =
+      normal / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+  if (n.z >= 0.0F) {
+    return {n.x, n.y};
+  }
+  const auto sign = [](float value) { return value >= 0.0F ? 1.0F : -1.0F; };
+  return {(1.0F - std::abs(n.y)) * sign(n.x),
+          (1.0F - std::abs(n.x)) * sign(n.y)};
+}
+
+auto packVertex(const MeshVertex& vertex) -> PackedVertex
+{
+  return {.position = {glm::packHalf1x16(vertex.position.x),
+                       glm::packHalf1x16(vertex.position.y),
+                       glm::packHalf1x16(vertex.position.z)},
+          .normal = glm::packSnorm2x8(octahedralEncode(vertex.normal))};
+}
+
+auto makeCube() -> MeshData
+{
+  MeshData mesh;
+
+  // Four vertices per face so every face gets its own normal
+  const std::array<glm::vec3, 6> normals = {{{1.0F, 0.0F, 0.0F},
+                                             {-1.0F, 0.0F, 0.0F},
+                                             {0.0F, 1.0F, 0.0F},
+                                             {0.0F, -1.0F, 0.0F},
+                                             {0.0F, 0.0F, 1.0F},
+                                             {0.0F, 0.0F, -1.0F}}};
+
+  for (const auto& normal : normals) {
+    // Two axes spanning the face, ordered for counter-clockwise winding
+    const glm::vec3 u(normal.y, normal.z, normal.x);
+    const auto v = glm::cross(normal, u);
+
+    const auto base = static_cast<uint32_t>(mesh.vertices.size());
+    for (const auto& [s, t] : {std::pair {-1.0F, -1.0F},
+                               std::pair {1.0F, -1.0F},
+                               std::pair {1.0F, 1.0F},
+                               std::pair {-1.0F, 1.0F}})
+    {
+      mesh.vertices.push_back(
+          {.position = 0.5F * (normal + (s * u) + (t * v)),
+           .normal = normal});
+    }
+    mesh.indices.insert(
+        mesh.indices.end(),
+        {base, base + 1, base + 2, base, base + 2, base + 3});
+  }
+
+  return mesh;
+}
+
+auto makeIcosphere(uint32_t subdivisions) -> MeshData
+{
+  const auto t = (1.0F + glm::sqrt(5.0F)) / 2.0F;
+
+  std::vector<glm::vec3> positions = {{-1.0F, t, 0.0F},
+                                      {1.0F, t, 0.0F},
+                                      {-1.0F, -t, 0.0F},
+                                      {1.0F, -t, 0.0F},
+                                      {0.0F, -1.0F, t},
+                                      {0.0F, 1.0F, t},
+                                      {0.0F, -1.0F, -t},
+                                      {0.0F, 1.0F, -t},
+                                      {t, 0.0F, -1.0F},
+                                      {t, 0.0F, 1.0F},
+                                      {-t, 0.0F, -1.0F},
+                                      {-t, 0.0F, 1.0F}};
+  for (auto& position : positions) {
+    position = glm::normalize(position);
+  }
+
+  std::vector<uint32_t> indices = {
+      0, 11, 5, 0, 5,  1,  0,  1,  7,  0,  7, 10, 0, 10, 11,
+      1, 5,  9, 5, 11, 4,  11, 10, 2,  10, 7, 6,  7, 1,  8,
+      3, 9,  4, 3, 4,  2,  3,  2,  6,  3,  6, 8,  3, 8,  9,
+      4, 9,  5, 2, 4,  11, 6,  2,  10, 8,  6, 7,  9, 8,  1};
+
+  for (uint32_t level = 0; level < subdivisions; level++) {
+    // Shared edges get a single midpoint vertex
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> midpoints;
+    auto midpoint = [&](uint32_t a, uint32_t b) {
+      const auto key = std::minmax(a, b);
+      const auto [it, inserted] = midpoints.try_emplace(
+          key, static_cast<uint32_t>(positions.size()));
+      if (inserted) {
+        positions.push_back(glm::normalize(positions[a] + positions[b]));
+      }
+      return it->second;
+    };
+
+    std::vector<uint32_t> split;
+    split.reserve(indices.size() * 4);
+    for (size_t i = 0; i < indices.size(); i += 3) {
+      const auto a = indices[i];
+      const auto b = indices[i + 1];
+      const auto c = indices[i + 2];
+      const auto ab = midpoint(a, b);
+      const auto bc = midpoint(b, c);
+      const auto ca = midpoint(c, a);
+      split.insert(split.end(),
+                   {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+    }
+    indices = std::move(split);
+  }
+
+  MeshData mesh;
+  mesh.indices = std::move(indices);
+  mesh.vertices.reserve(positions.size());
+  for (const auto& position : positions) {
+    mesh.vertices.push_back({.position = position, .normal = position});
+  }
+  return mesh;
+}
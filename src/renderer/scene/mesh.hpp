@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../shaderLayout.hpp"
+
+struct MeshVertex
+{
+  glm::vec3 position;
+  glm::vec3 normal;
+};
+
+// MeshVertex as uploaded, in 8 bytes instead of 24: the position in half
+// floats and the normal octahedron-encoded in two snorm8s.
+//
+// scene.slang: struct VSInput { float4 Position; float2 Normal; ... }. The
+// position attribute reads four halves, the last of which is the normal.
+struct PackedVertex
+{
+  std::array<uint16_t, 3> position;
+  uint16_t normal;  // x in the low byte
+};
+
+template <>
+struct ShaderLayout<PackedVertex>
+{
+  static constexpr std::size_t stride = 8;
+
+  static_assert(offsetof(PackedVertex, position) == 0);
+  static_assert(offsetof(PackedVertex, normal) == 6);
+};
+
+// Maps a unit vector onto [-1, 1]^2 through the octahedron |x|+|y|+|z| = 1,
+// whose lower half is folded out over the diagonals
+auto octahedralEncode(const glm::vec3& normal) -> glm::vec2;
+
+auto packVertex(const MeshVertex& vertex) -> PackedVertex;
+
+// Indexed triangle list centred on the origin
+struct MeshData
+{
+  std::vector<MeshVertex> vertices;
+  std::vector<uint32_t> indices;
+
+  // Radius of the bounding sphere around the origin
+  [[nodiscard]] auto boundingRadius() const -> float;
+};
+
+// Unit cube with flat faces
+auto makeCube() -> MeshData;
+
+// Unit sphere from an icosahedron whose faces are split into four
+// subdivisions times
+auto makeIcosphere(uint32_t subdivisions) -> MeshData;
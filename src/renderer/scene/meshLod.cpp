@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+#include "meshLod.hpp"
+
+#include <glm/glm.hpp>
+
+namespace
+{
+
+struct Simplified
+{
+  MeshData mesh;
+  float error;
+};
+
+auto simplify(const MeshData& mesh, float cellSize) -> Simplified
+{
+  glm::vec3 origin(std::numeric_limits<float>::max());
+  for (const auto& vertex : mesh.vertices) {
+    origin = glm::min(origin, vertex.position);
+  }
+
+  // Cluster of each vertex, keyed by 21 bits of cell per axis
+  const auto cellOf = [&](const glm::vec3& position) -> uint64_t
+  {
+    const glm::vec3 cell = (position - origin) / cellSize;
+    return static_cast<uint64_t>(cell.x)
+        | (static_cast<uint64_t>(cell.y) << 21)
+        | (static_cast<uint64_t>(cell.z) << 42);
+  };
+  std::unordered_map<uint64_t, uint32_t> clusterOfCell;
+  std::vector<uint32_t> clusterOf(mesh.vertices.size());
+  std::vector<MeshVertex> sums;
+  std::vector<uint32_t> counts;
+  for (std::size_t v = 0; v < mesh.vertices.size(); v++) {
+    const auto& vertex = mesh.vertices[v];
+    const auto [it, inserted] = clusterOfCell.try_emplace(
+        cellOf(vertex.position), static_cast<uint32_t>(sums.size()));
+    if (inserted) {
+      sums.push_back({.position = glm::vec3(0.0F), .normal = glm::vec3(0.0F)});
+      counts.push_back(0);
+    }
+    const uint32_t cluster = it->second;
+    clusterOf[v] = cluster;
+    sums[cluster].position += vertex.position;
+    sums[cluster].normal += vertex.normal;
+    counts[cluster]++;
+  }
+
+  Simplified result {.mesh = {}, .error = 0.0F};
+  result.mesh.vertices.reserve(sums.size());
+  for (std::size_t cluster = 0; cluster < sums.size(); cluster++) {
+    const float normalLength = glm::length(sums[cluster].normal);
+    result.mesh.vertices.push_back(
+        {.position = sums[cluster].position
+             / static_cast<float>(counts[cluster]),
+         // Opposite normals, as on thin parts, cancel out
+         .normal = normalLength > 0.0F ? sums[cluster].normal / normalLength
+                                       : glm::vec3(0.0F, 0.0F, 1.0F)});
+  }
+  for (std::size_t v = 0; v < mesh.vertices.size(); v++) {
+    result.error = std::max(
+        result.error,
+        glm::length(mesh.vertices[v].position
+                    - result.mesh.vertices[clusterOf[v]].position));
+  }
+
+  for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+    const uint32_t a = clusterOf[mesh.indices[i]];
+    const uint32_t b = clusterOf[mesh.indices[i + 1]];
+    const uint32_t c = clusterOf[mesh.indices[i + 2]];
+    if (a != b && b != c && c != a) {
+      result.mesh.indices.insert(result.mesh.indices.end(), {a, b, c});
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+auto buildLodChain(const MeshData& mesh, std::size_t maxLevels) -> LodChain
+{
+  LodChain chain {.mesh = mesh, .levels = {}};
+  chain.levels.push_back(
+      {.firstIndex = 0,
+       .indexCount = static_cast<uint32_t>(mesh.indices.size()),
+       .error = 0.0F});
+
+  const float radius = mesh.boundingRadius();
+  std::size_t previousIndices = mesh.indices.size();
+  for (float cellSize = radius / 8.0F;
+       chain.levels.size() < maxLevels && cellSize <= 2.0F * radius;
+       cellSize *= 2.0F)
+  {
+    auto [simplified, error] = simplify(mesh, cellSize);
+    if (simplified.indices.empty()) {
+      break;
+    }
+    if (4 * simplified.indices.size() > 3 * previousIndices) {
+      continue;
+    }
+
+    const auto base = static_cast<uint32_t>(chain.mesh.vertices.size());
+    chain.levels.push_back(
+        {.firstIndex = static_cast<uint32_t>(chain.mesh.indices.size()),
+         .indexCount = static_cast<uint32_t>(simplified.indices.size()),
+         .error = error});
+    chain.mesh.vertices.insert(chain.mesh.vertices.end(),
+                               simplified.vertices.begin(),
+                               simplified.vertices.end());
+    for (const auto index : simplified.indices) {
+      chain.mesh.indices.push_back(base + index);
+    }
+    previousIndices = simplified.indices.size();
+  }
+  return chain;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mesh.hpp"
+
+// Levels of detail of a mesh, finest first, in one mesh: the vertices of
+// every level are in one array and their index lists follow each other.
+struct LodChain
+{
+  struct Level
+  {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    // Largest distance any vertex of the original moved, in mesh units; 0
+    // for the original itself
+    float error;
+  };
+
+  MeshData mesh;
+  std::vector<Level> levels;
+};
+
+// The mesh followed by up to maxLevels - 1 simplifications of it.
+//
+// Each level clusters the original's vertices on a grid (Rossignac and
+// Borrel, "Multi-resolution 3D approximations for rendering complex
+// scenes", 1993) and replaces every cluster by its average; triangles whose
+// corners share a cluster disappear. Cells start at an eighth of the
+// bounding radius and double per level. Levels that remove less than a
+// quarter of the previous level's triangles are skipped, so small meshes
+// get few levels or none.
+auto buildLodChain(const MeshData& mesh, std::size_t maxLevels) -> LodChain;
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "meshOptimizer.hpp"
+
+namespace
+{
+
+// Triangles using each vertex, as offsets into one flat list
+struct Adjacency
+{
+  std::vector<uint32_t> offsets;  // vertexCount + 1
+  std::vector<uint32_t> triangles;
+
+  Adjacency(std::span<const uint32_t> indices, std::size_t vertexCount)
+      : offsets(vertexCount + 1, 0)
+      , triangles(indices.size())
+  {
+    for (const auto index : indices) {
+      offsets[index + 1]++;
+    }
+    for (std::size_t v = 1; v <= vertexCount; v++) {
+      offsets[v] += offsets[v - 1];
+    }
+    std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < indices.size(); i++) {
+      triangles[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+  }
+
+  [[nodiscard]] auto of(std::size_t vertex) const -> std::span<const uint32_t>
+  {
+    return std::span(triangles)
+        .subspan(offsets[vertex], offsets[vertex + 1] - offsets[vertex]);
+  }
+};
+
+constexpr uint32_t noVertex = std::numeric_limits<uint32_t>::max();
+
+}  // namespace
+
+void optimizeVertexCache(std::span<uint32_t> indices,
+                         std::size_t vertexCount,
+                         uint32_t cacheSize)
+{
+  const std::size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0) {
+    return;
+  }
+
+  const Adjacency adjacency(indices, vertexCount);
+  std::vector<uint32_t> output;
+  output.reserve(indices.size());
+
+  // Triangles still to emit per vertex, and the time each vertex last
+  // entered the cache; a vertex is cached while time - cacheTime < size
+  std::vector<uint32_t> live(vertexCount);
+  for (std::size_t v = 0; v < vertexCount; v++) {
+    live[v] = static_cast<uint32_t>(adjacency.of(v).size());
+  }
+  std::vector<uint32_t> cacheTime(vertexCount, 0);
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<uint32_t> deadEnds;  // Recently used vertices, most recent last
+  std::vector<uint32_t> candidates;
+  uint32_t time = cacheSize + 1;
+  uint32_t cursor = 0;  // Where to look for a fan when both run out
+
+  // Cached vertices with the fewest live triangles that would still be in
+  // the cache after emitting them all, else the most recent dead end, else
+  // the next vertex with live triangles
+  const auto nextFan = [&]() -> uint32_t
+  {
+    uint32_t best = noVertex;
+    int64_t bestPriority = 0;
+    for (const auto v : candidates) {
+      if (live[v] == 0) {
+        continue;
+      }
+      int64_t priority = 0;
+      if (time - cacheTime[v] + (2 * live[v]) <= cacheSize) {
+        priority = time - cacheTime[v];
+      }
+      if (priority > bestPriority) {
+        best = v;
+        bestPriority = priority;
+      }
+    }
+    if (best != noVertex) {
+      return best;
+    }
+
+    while (!deadEnds.empty()) {
+      const uint32_t v = deadEnds.back();
+      deadEnds.pop_back();
+      if (live[v] > 0) {
+        return v;
+      }
+    }
+    for (; cursor < vertexCount; cursor++) {
+      if (live[cursor] > 0) {
+        return cursor;
+      }
+    }
+    return noVertex;
+  };
+
+  for (uint32_t fan = nextFan(); fan != noVertex; fan = nextFan()) {
+    candidates.clear();
+    for (const auto triangle : adjacency.of(fan)) {
+      if (emitted[triangle]) {
+        continue;
+      }
+      emitted[triangle] = true;
+      for (std::size_t corner = 0; corner < 3; corner++) {
+        const uint32_t v = indices[(3 * triangle) + corner];
+        output.push_back(v);
+        deadEnds.push_back(v);
+        candidates.push_back(v);
+        live[v]--;
+        if (time - cacheTime[v] > cacheSize) {
+          cacheTime[v] = time++;
+        }
+      }
+    }
+  }
+
+  std::ranges::copy(output, indices.begin());
+}
+
+void optimizeVertexFetch(MeshData& mesh)
+{
+  std::vector<uint32_t> remap(mesh.vertices.size(), noVertex);
+  std::vector<MeshVertex> vertices;
+  vertices.reserve(mesh.vertices.size());
+
+  for (auto& index : mesh.indices) {
+    if (remap[index] == noVertex) {
+      remap[index] = static_cast<uint32_t>(vertices.size());
+      vertices.push_back(mesh.vertices[index]);
+    }
+    index = remap[index];
+  }
+  mesh.vertices = std::move(vertices);
+}
+
+auto countCacheMisses(std::span<const uint32_t> indices,
+                      std::size_t vertexCount,
+                      uint32_t cacheSize) -> std::size_t
+{
+  // Same timestamps as Tipsify: a vertex is cached while fewer than
+  // cacheSize vertices have entered since it did
+  std::vector<std::size_t> cacheTime(vertexCount, 0);
+  std::size_t time = cacheSize + 1;
+  std::size_t misses = 0;
+  for (const auto v : indices) {
+    if (time - cacheTime[v] > cacheSize) {
+      cacheTime[v] = time++;
+      misses++;
+    }
+  }
+  return misses;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "mesh.hpp"
+
+// Entries in the FIFO post-transform cache the optimizations assume. Small
+// enough for any GPU; larger caches only do better.
+constexpr uint32_t vertexCacheSize = 16;
+
+// Reorders the triangles of an indexed triangle list so consecutive ones
+// reuse recently transformed vertices, with Tipsify (Sander et al., "Fast
+// Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007).
+// Runs in time linear in the number of triangles.
+void optimizeVertexCache(std::span<uint32_t> indices,
+                         std::size_t vertexCount,
+                         uint32_t cacheSize = vertexCacheSize);
+
+// Reorders the vertices into the order the indices first use them, so
+// vertex fetch streams through memory, and drops unused vertices
+void optimizeVertexFetch(MeshData& mesh);
+
+// Vertices a FIFO cache of cacheSize entries transforms for the indices;
+// divided by the triangle count, this is the average cache miss ratio
+// (ACMR), between 0.5 for an ideal mesh and 3
+auto countCacheMisses(std::span<const uint32_t> indices,
+                      std::size_t vertexCount,
+                      uint32_t cacheSize = vertexCacheSize) -> std::size_t;
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <span>
+
+#include "meshlet.hpp"
+
+namespace
+{
+
+constexpr uint8_t noLocalIndex = std::numeric_limits<uint8_t>::max();
+
+// Culling data from the meshlet's positions and triangles, as in
+// meshoptimizer's meshopt_computeClusterBounds
+void computeBounds(Meshlet& meshlet,
+                   const MeshData& mesh,
+                   std::span<const uint32_t> vertices,
+                   std::span<const uint8_t> triangles)
+{
+  glm::vec3 center(0.0F);
+  for (const auto v : vertices) {
+    center += mesh.vertices[v].position;
+  }
+  center /= static_cast<float>(vertices.size());
+
+  meshlet.center = center;
+  meshlet.radius = 0.0F;
+  for (const auto v : vertices) {
+    meshlet.radius = std::max(
+        meshlet.radius, glm::length(mesh.vertices[v].position - center));
+  }
+
+  // Face normals of the non-degenerate triangles, and their average
+  std::vector<std::array<glm::vec3, 2>> faces;  // Normal and a corner
+  glm::vec3 axis(0.0F);
+  for (std::size_t i = 0; i < triangles.size(); i += 3) {
+    const auto& a = mesh.vertices[vertices[triangles[i]]].position;
+    const auto& b = mesh.vertices[vertices[triangles[i + 1]]].position;
+    const auto& c = mesh.vertices[vertices[triangles[i + 2]]].position;
+    const glm::vec3 normal = glm::cross(b - a, c - a);
+    const float area = glm::length(normal);
+    if (area > 0.0F) {
+      faces.push_back({normal / area, a});
+      axis += normal / area;
+    }
+  }
+
+  meshlet.coneApex = center;
+  meshlet.coneAxis = glm::vec3(0.0F, 0.0F, 1.0F);
+  meshlet.coneCutoff = 1.0F;
+  const float axisLength = glm::length(axis);
+  if (faces.empty() || axisLength == 0.0F) {
+    return;
+  }
+  axis /= axisLength;
+
+  // Normals spread over more than about a hemisphere cannot be culled
+  float minDot = 1.0F;
+  for (const auto& [normal, corner] : faces) {
+    minDot = std::min(minDot, glm::dot(normal, axis));
+  }
+  constexpr float minConeDot = 0.1F;
+  if (minDot <= minConeDot) {
+    return;
+  }
+
+  // Move the apex back along the axis until every triangle's plane is in
+  // front of it
+  float maxT = 0.0F;
+  for (const auto& [normal, corner] : faces) {
+    const float t = glm::dot(center - corner, normal) / glm::dot(axis, normal);
+    maxT = std::max(maxT, t);
+  }
+  meshlet.coneApex = center - (axis * maxT);
+  meshlet.coneAxis = axis;
+  meshlet.coneCutoff = std::sqrt(1.0F - (minDot * minDot));
+}
+
+}  // namespace
+
+auto buildMeshlets(const MeshData& mesh) -> MeshletData
+{
+  MeshletData data;
+  std::vector<uint8_t> localIndex(mesh.vertices.size(), noLocalIndex);
+  Meshlet current {};
+
+  const auto finish = [&]
+  {
+    if (current.triangleCount == 0) {
+      return;
+    }
+    const auto vertices = std::span(data.vertices)
+                              .subspan(current.vertexOffset,
+                                       current.vertexCount);
+    computeBounds(current,
+                  mesh,
+                  vertices,
+                  std::span(data.triangles)
+                      .subspan(current.triangleOffset,
+                               std::size_t {current.triangleCount} * 3));
+    for (const auto v : vertices) {
+      localIndex[v] = noLocalIndex;
+    }
+    data.meshlets.push_back(current);
+    current = {};
+    current.vertexOffset = static_cast<uint32_t>(data.vertices.size());
+    current.triangleOffset = static_cast<uint32_t>(data.triangles.size());
+  };
+
+  for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+    const std::array<uint32_t, 3> corners = {
+        mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2]};
+    const auto added = std::ranges::count_if(
+        corners, [&](uint32_t v) { return localIndex[v] == noLocalIndex; });
+    if (current.vertexCount + static_cast<std::size_t>(added)
+            > maxMeshletVertices
+        || current.triangleCount + 1 > maxMeshletTriangles)
+    {
+      finish();
+    }
+
+    for (const auto v : corners) {
+      if (localIndex[v] == noLocalIndex) {
+        localIndex[v] = static_cast<uint8_t>(current.vertexCount++);
+        data.vertices.push_back(v);
+      }
+      data.triangles.push_back(localIndex[v]);
+    }
+    current.triangleCount++;
+  }
+  finish();
+
+  return data;
+}
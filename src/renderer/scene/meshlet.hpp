@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mesh.hpp"
+
+// Limits of one meshlet. 64 vertices and 124 triangles are what mesh
+// shading hardware favours, and also keep a meshlet's local indices in a
+// byte.
+constexpr std::size_t maxMeshletVertices = 64;
+constexpr std::size_t maxMeshletTriangles = 124;
+
+// A small cluster of a mesh's triangles with bounds to cull it by
+struct Meshlet
+{
+  uint32_t vertexOffset;  // Into MeshletData::vertices
+  uint32_t triangleOffset;  // Into MeshletData::triangles
+  uint32_t vertexCount;
+  uint32_t triangleCount;
+
+  // Bounding sphere, in mesh space
+  glm::vec3 center;
+  float radius;
+
+  // Normal cone: the meshlet faces away from a camera at position p, and
+  // can be culled, when dot(normalize(coneApex - p), coneAxis) >=
+  // coneCutoff. A cutoff of 1 never culls.
+  glm::vec3 coneApex;
+  glm::vec3 coneAxis;
+  float coneCutoff;
+};
+
+struct MeshletData
+{
+  std::vector<Meshlet> meshlets;
+  std::vector<uint32_t> vertices;  // Indices into the mesh's vertices
+  // Three bytes per triangle, each indexing the meshlet's vertices
+  std::vector<uint8_t> triangles;
+};
+
+// Splits mesh into meshlets by walking its triangles in order and starting
+// a new meshlet whenever one would exceed its limits, so meshes optimized
+// for the vertex cache give compact meshlets
+auto buildMeshlets(const MeshData& mesh) -> MeshletData;
@@ -8,15 +8,32 @@
 #include <vulkan/vulkan_enums.hpp>
 #include <vulkan/vulkan_structs.hpp>
 
+#include "assets/assetPack.hpp"
 #include "device.hpp"  // Include the Device class definition
 
-Shader::Shader(Device* device, const std::string& shaderPath)
+Shader::Shader(Device* device,
+               std::string_view module,
+               std::string_view entryPoint)
     : device(device)
 {
-  auto shaderCode = readFile(shaderPath);
+  const auto name = assetName(module, entryPoint);
+  const auto* pack = device->shaderPack;
+  if (pack != nullptr && pack->find(name, AssetType::eShader) != nullptr) {
+    shaderModule = createShaderModule(pack->shader(name));
+    return;
+  }
+
+  auto shaderCode = readFile("src/shaders/bin/" + std::string(module)
+                             + ".slang." + std::string(entryPoint) + ".spv");
   shaderModule = createShaderModule(shaderCode);
 }
 
+Shader::Shader(Device* device, std::span<const uint32_t> code)
+    : device(device)
+    , shaderModule(createShaderModule(code))
+{
+}
+
 Shader::~Shader()
 {
   if (shaderModule) {
@@ -24,12 +41,18 @@ Shader::~Shader()
   }
 }
 
-auto Shader::createShaderModule(const std::vector<char>& code)
+auto Shader::assetName(std::string_view module, std::string_view entryPoint)
+    -> std::string
+{
+  return std::string(module) + "." + std::string(entryPoint);
+}
+
+auto Shader::createShaderModule(std::span<const uint32_t> code)
     -> vk::ShaderModule
 {
   vk::ShaderModuleCreateInfo createInfo;
-  createInfo.codeSize = code.size();
-  createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+  createInfo.codeSize = code.size_bytes();
+  createInfo.pCode = code.data();
 
   try {
     return device->handle.createShaderModule(createInfo);
@@ -39,16 +62,16 @@ auto Shader::createShaderModule(const std::vector<char>& code)
 }
 
 vk::PipelineShaderStageCreateInfo Shader::getShaderStageCreateInfo(
-    vk::ShaderStageFlagBits stage, const std::string& entryPoint)
+    vk::ShaderStageFlagBits stage, const char* entryPoint)
 {
   vk::PipelineShaderStageCreateInfo shaderStage;
   shaderStage.stage = stage;
   shaderStage.module = shaderModule;
-  shaderStage.pName = entryPoint.c_str();
+  shaderStage.pName = entryPoint;
   return shaderStage;
 }
 
-auto Shader::readFile(const std::string& filePath) -> std::vector<char>
+auto Shader::readFile(const std::string& filePath) -> std::vector<uint32_t>
 {
   std::ifstream file(filePath, std::ios::ate | std::ios::binary);
 
@@ -57,10 +80,15 @@ auto Shader::readFile(const std::string& filePath) -> std::vector<char>
   }
 
   size_t fileSize = (size_t)file.tellg();
-  std::vector<char> buffer(fileSize);
+  if (fileSize % sizeof(uint32_t) != 0) {
+    throw std::runtime_error(std::string("invalid SPIR-V file: ") + filePath);
+  }
+  std::vector<uint32_t> buffer(fileSize / sizeof(uint32_t));
 
   file.seekg(0);
-  file.read(buffer.data(), static_cast<std::streamsize>(fileSize));
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  file.read(reinterpret_cast<char*>(buffer.data()),
+            static_cast<std::streamsize>(fileSize));
   file.close();
 
   return buffer;
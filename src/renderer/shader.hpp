@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <vulkan/vulkan.hpp>
@@ -11,18 +14,29 @@ class Device;
 class Shader
 {
 public:
-  Shader(Device* device, const std::string& shaderPath);
+  // The module compiled from entryPoint of <module>.slang, taken from the
+  // device's shader pack when one is open and read from src/shaders/bin
+  // otherwise
+  Shader(Device* device, std::string_view module, std::string_view entryPoint);
+  // code is only read while the module is created, so it may point into a
+  // mapped pack
+  Shader(Device* device, std::span<const uint32_t> code);
   ~Shader();
 
   vk::ShaderModule getShaderModule() const { return shaderModule; }
 
+  // pName points at entryPoint, which must outlive the returned struct
   vk::PipelineShaderStageCreateInfo getShaderStageCreateInfo(
-      vk::ShaderStageFlagBits stage, const std::string& entryPoint = "main");
+      vk::ShaderStageFlagBits stage, const char* entryPoint = "main");
+
+  // Name of an entry point's SPIR-V in an asset pack
+  static auto assetName(std::string_view module, std::string_view entryPoint)
+      -> std::string;
 
 private:
   Device* device;
   vk::ShaderModule shaderModule {VK_NULL_HANDLE};
 
-  vk::ShaderModule createShaderModule(const std::vector<char>& code);
-  std::vector<char> readFile(const std::string& filePath);
+  vk::ShaderModule createShaderModule(std::span<const uint32_t> code);
+  std::vector<uint32_t> readFile(const std::string& filePath);
 };
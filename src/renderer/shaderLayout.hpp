@@ -0,0 +1,50 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <glm/glm.hpp>
+
+// Layout of a struct as the shaders see it (std430 for storage buffers,
+// tightly packed for vertex input). Specialise this for every host type that
+// is uploaded to the GPU and assert the field offsets against the Slang
+// declaration, so a mismatch is caught at compile time rather than as
+// garbage on screen.
+template <typename T>
+struct ShaderLayout;
+
+template <typename T>
+concept ShaderCompatible = std::is_trivially_copyable_v<T>
+    && std::is_standard_layout_v<T> && requires {
+         { ShaderLayout<T>::stride } -> std::convertible_to<std::size_t>;
+       } && sizeof(T) == ShaderLayout<T>::stride;
+
+// uint, e.g. index buffers
+template <>
+struct ShaderLayout<uint32_t>
+{
+  static constexpr std::size_t stride = 4;
+};
+
+// 16-bit index buffers
+template <>
+struct ShaderLayout<uint16_t>
+{
+  static constexpr std::size_t stride = 2;
+};
+
+// float2
+template <>
+struct ShaderLayout<glm::vec2>
+{
+  static constexpr std::size_t stride = 8;
+};
+
+// float4
+template <>
+struct ShaderLayout<glm::vec4>
+{
+  static constexpr std::size_t stride = 16;
+};
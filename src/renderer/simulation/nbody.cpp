@@ -0,0 +1,181 @@
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "nbody.hpp"
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "../buffers/hostBuffer.hpp"
+#include "../shader.hpp"
+
+auto makeGalaxy(const NBodySettings& settings) -> GalaxyState
+{
+  const auto count = settings.particleCount;
+
+  // Disc galaxy: mass grows with radius, and every particle starts on a
+  // roughly circular orbit around the enclosed mass
+  std::mt19937 random(settings.seed);
+  std::uniform_real_distribution<float> unit(0.0F, 1.0F);
+  std::normal_distribution<float> thickness(0.0F, 0.02F);
+
+  GalaxyState galaxy {.positions = std::vector<glm::vec4>(count),
+                      .velocities = std::vector<glm::vec4>(count)};
+  const auto particleMass = 1.0F / static_cast<float>(count);
+  for (uint32_t i = 0; i < count; i++) {
+    const auto radius = 0.05F + (0.95F * std::sqrt(unit(random)));
+    const auto angle = 2.0F * std::numbers::pi_v<float> * unit(random);
+    const auto mass = particleMass * (0.5F + unit(random));
+
+    galaxy.positions[i] = {radius * std::cos(angle),
+                           radius * std::sin(angle),
+                           thickness(random),
+                           mass};
+
+    const auto enclosed = radius * radius;
+    const auto speed = std::sqrt(settings.gravity * enclosed / radius);
+    galaxy.velocities[i] = {
+        -speed * std::sin(angle), speed * std::cos(angle), 0, 0};
+  }
+  return galaxy;
+}
+
+NBody::NBody(Device& device,
+             VmaAllocator& allocator,
+             Compute& compute,
+             const NBodySettings& settings)
+    : settings(settings)
+    , compute(compute)
+{
+  createBuffers(device, allocator);
+
+  auto galaxy = makeGalaxy(settings);
+  const auto byteSize = settings.particleCount * sizeof(glm::vec4);
+  HostBuffer positionStaging(device.handle,
+                             allocator,
+                             byteSize,
+                             galaxy.positions.data(),
+                             vk::BufferUsageFlagBits::eTransferSrc);
+  HostBuffer velocityStaging(device.handle,
+                             allocator,
+                             byteSize,
+                             galaxy.velocities.data(),
+                             vk::BufferUsageFlagBits::eTransferSrc);
+
+  ComputeBatch upload;
+  upload.copy(positionStaging, *position[0], byteSize)
+      .copy(velocityStaging, *velocity[0], byteSize);
+  compute.submit(upload);
+
+  createKernel(device);
+}
+
+NBody::NBody(Device& device,
+             VmaAllocator& allocator,
+             Compute& compute,
+             const NBodySettings& settings,
+             const GalaxyView& galaxy,
+             StreamingUploader& uploader)
+    : settings(settings)
+    , compute(compute)
+{
+  if (galaxy.positions.size() != settings.particleCount
+      || galaxy.velocities.size() != settings.particleCount)
+  {
+    throw std::runtime_error("Baked galaxy does not match the particle count.");
+  }
+
+  createBuffers(device, allocator);
+
+  const auto positionStats =
+      uploader.upload(std::as_bytes(galaxy.positions), *position[0]);
+  loadStats = uploader.upload(std::as_bytes(galaxy.velocities), *velocity[0]);
+  loadStats += positionStats;
+
+  createKernel(device);
+}
+
+NBody::~NBody()
+{
+  compute.destroyKernel(kernel);
+}
+
+void NBody::step(ComputeBatch& batch)
+{
+  const auto next = 1 - current;
+
+  const Params params {.particleCount = settings.particleCount,
+                       .timeStep = settings.timeStep,
+                       .softening = settings.softening,
+                       .gravity = settings.gravity,
+                       .damping = settings.damping};
+
+  batch.dispatch(
+      kernel,
+      {{.binding = 0,
+        .buffer = position[current].get(),
+        .access = BufferAccess::eRead},
+       {.binding = 1,
+        .buffer = velocity[current].get(),
+        .access = BufferAccess::eRead},
+       {.binding = 2,
+        .buffer = position[next].get(),
+        .access = BufferAccess::eWrite},
+       {.binding = 3,
+        .buffer = velocity[next].get(),
+        .access = BufferAccess::eWrite}},
+      GroupCount::cover(settings.particleCount, tileSize),
+      params);
+
+  current = next;
+}
+
+void NBody::collide(ComputeBatch& batch,
+                    SpatialGrid& grid,
+                    const CollisionSettings& collision)
+{
+  // The other velocity buffer is overwritten by the next step anyway, so it
+  // takes the collided velocities and becomes the current one
+  const auto next = 1 - current;
+  grid.build(batch, *position[current], *velocity[current], particleCount());
+  grid.collide(batch, *velocity[next], collision);
+  std::swap(velocity[current], velocity[next]);
+}
+
+void NBody::createBuffers(Device& device, VmaAllocator& allocator)
+{
+  const auto byteSize = settings.particleCount * sizeof(glm::vec4);
+  const auto usage = vk::BufferUsageFlagBits::eStorageBuffer
+      | vk::BufferUsageFlagBits::eVertexBuffer;
+  for (auto& buffer : position) {
+    buffer = std::make_unique<DeviceBuffer>(
+        device.handle, allocator, byteSize, usage);
+  }
+  for (auto& buffer : velocity) {
+    buffer = std::make_unique<DeviceBuffer>(
+        device.handle, allocator, byteSize, usage);
+  }
+}
+
+void NBody::createKernel(Device& device)
+{
+  const auto shader = std::make_unique<Shader>(&device, "nbody", "main");
+  const auto stage =
+      shader->getShaderStageCreateInfo(vk::ShaderStageFlagBits::eCompute);
+
+  std::vector<vk::DescriptorSetLayoutBinding> bindings;
+  for (uint32_t binding = 0; binding < 4; binding++) {
+    bindings.push_back({.binding = binding,
+                        .descriptorType = vk::DescriptorType::eStorageBuffer,
+                        .descriptorCount = 1,
+                        .stageFlags = vk::ShaderStageFlagBits::eCompute});
+  }
+
+  kernel = compute.createKernel(stage, bindings, sizeof(Params), "nbody");
+}
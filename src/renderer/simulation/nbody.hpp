@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include "../buffers/deviceBuffer.hpp"
+#include "../compute.hpp"
+#include "../computeBatch.hpp"
+#include "../device.hpp"
+#include "../streamingUploader.hpp"
+#include "spatialGrid.hpp"
+#include "vk_mem_alloc.h"
+
+struct NBodySettings
+{
+  uint32_t particleCount = 64 * 1024;
+  float timeStep = 0.0005F;
+  float softening = 0.02F;
+  float gravity = 1.0F;
+  float damping = 1.0F;
+  uint32_t seed = 1;
+};
+
+// Initial positions and velocities of every particle, as NBody uploads them
+struct GalaxyState
+{
+  std::vector<glm::vec4> positions;
+  std::vector<glm::vec4> velocities;
+};
+
+// GalaxyState in memory owned elsewhere, such as a mapped asset pack
+struct GalaxyView
+{
+  std::span<const glm::vec4> positions;
+  std::span<const glm::vec4> velocities;
+};
+
+// A disc galaxy of settings.particleCount particles from settings.seed
+auto makeGalaxy(const NBodySettings& settings) -> GalaxyState;
+
+// All-pairs gravitational simulation of a rotating disc galaxy, integrated
+// on the GPU by nbody.slang.
+//
+// Positions (xyz, mass in w) and velocities (xyz, speed in w) live in two
+// pairs of storage buffers that are swapped every step, so a step never
+// reads what it writes and consecutive steps in one batch only need a
+// single barrier between them. The buffers are also usable as vertex
+// buffers for point sprite rendering.
+class NBody
+{
+public:
+  static constexpr uint32_t tileSize = 256;  // TILE_SIZE in nbody.slang
+
+  NBody(Device& device,
+        VmaAllocator& allocator,
+        Compute& compute,
+        const NBodySettings& settings = {});
+
+  // Starts from a galaxy made with the same settings and baked ahead of
+  // time, streamed straight from where it is mapped into the buffers
+  NBody(Device& device,
+        VmaAllocator& allocator,
+        Compute& compute,
+        const NBodySettings& settings,
+        const GalaxyView& galaxy,
+        StreamingUploader& uploader);
+  ~NBody();
+
+  NBody(const NBody&) = delete;
+  NBody& operator=(const NBody&) = delete;
+  NBody(NBody&&) = delete;
+  NBody& operator=(NBody&&) = delete;
+
+  // Enqueues one integration step. positions() and velocities() refer to
+  // its results once the batch has been submitted.
+  void step(ComputeBatch& batch);
+
+  // Enqueues soft-sphere collisions between particles closer than twice
+  // collision.particleRadius, so they behave like gas clouds that cannot
+  // pass through each other. grid is rebuilt over the current positions to
+  // find them.
+  void collide(ComputeBatch& batch,
+               SpatialGrid& grid,
+               const CollisionSettings& collision);
+
+  [[nodiscard]] auto positions() -> DeviceBuffer& { return *position[current]; }
+  [[nodiscard]] auto velocities() -> DeviceBuffer&
+  {
+    return *velocity[current];
+  }
+
+  [[nodiscard]] auto particleCount() const -> uint32_t
+  {
+    return settings.particleCount;
+  }
+
+  // Pairwise interactions evaluated per step
+  [[nodiscard]] auto interactionsPerStep() const -> uint64_t
+  {
+    return uint64_t {settings.particleCount} * settings.particleCount;
+  }
+
+  // Of the streamed upload, if the galaxy was baked
+  [[nodiscard]] auto getLoadStats() const -> const UploadProgress&
+  {
+    return loadStats;
+  }
+
+  NBodySettings settings;
+
+private:
+  // Matches Params in nbody.slang
+  struct Params
+  {
+    uint32_t particleCount;
+    float timeStep;
+    float softening;
+    float gravity;
+    float damping;
+  };
+
+  Compute& compute;
+  KernelHandle kernel;
+
+  std::array<std::unique_ptr<DeviceBuffer>, 2> position;
+  std::array<std::unique_ptr<DeviceBuffer>, 2> velocity;
+  uint32_t current = 0;
+  UploadProgress loadStats;
+
+  void createBuffers(Device& device, VmaAllocator& allocator);
+  void createKernel(Device& device);
+};
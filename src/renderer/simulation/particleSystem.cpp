@@ -0,0 +1,210 @@
+#include <array>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "particleSystem.hpp"
+
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "../shader.hpp"
+
+namespace
+{
+// Binding order of the globals in particles.slang
+enum Binding : uint32_t
+{
+  eParticles,
+  eDeadList,
+  eAliveLists,
+  eCounters,
+  eIndirectArgs,
+  eRenderPositions,
+  eRenderVelocities,
+  eEmitters,
+  eBindingCount,
+};
+}  // namespace
+
+ParticleSystem::ParticleSystem(Device& device,
+                               VmaAllocator& allocator,
+                               Compute& compute,
+                               const ParticleSystemSettings& settings)
+    : settings(settings)
+    , allocator(allocator)
+    , compute(compute)
+{
+  const vk::DeviceSize capacity = settings.capacity;
+  const auto storage = vk::BufferUsageFlagBits::eStorageBuffer;
+
+  particles = std::make_unique<DeviceBuffer>(
+      device.handle, allocator, capacity * 2 * sizeof(glm::vec4), storage);
+  deadList = std::make_unique<DeviceBuffer>(
+      device.handle, allocator, capacity * sizeof(uint32_t), storage);
+  aliveLists = std::make_unique<DeviceBuffer>(
+      device.handle, allocator, 2 * capacity * sizeof(uint32_t), storage);
+  counters = std::make_unique<DeviceBuffer>(
+      device.handle, allocator, 8 * sizeof(uint32_t), storage);
+  indirectArgs = std::make_unique<DeviceBuffer>(
+      device.handle,
+      allocator,
+      drawArgsOffset + sizeof(vk::DrawIndirectCommand),
+      storage | vk::BufferUsageFlagBits::eIndirectBuffer);
+  renderPositions = std::make_unique<DeviceBuffer>(
+      device.handle,
+      allocator,
+      capacity * sizeof(glm::vec4),
+      storage | vk::BufferUsageFlagBits::eVertexBuffer);
+  renderVelocities = std::make_unique<DeviceBuffer>(
+      device.handle,
+      allocator,
+      capacity * sizeof(glm::vec4),
+      storage | vk::BufferUsageFlagBits::eVertexBuffer);
+  emitterBuffer =
+      std::make_unique<HostBuffer>(device.handle,
+                                   allocator,
+                                   maxEmitters * sizeof(EmitterData),
+                                   nullptr,
+                                   storage);
+
+  // Every slot starts on the dead list
+  std::vector<uint32_t> freeSlots(settings.capacity);
+  std::iota(freeSlots.begin(), freeSlots.end(), 0U);
+  const std::array<uint32_t, 8> initialCounters = {settings.capacity};
+
+  HostBuffer freeSlotStaging(device.handle,
+                             allocator,
+                             freeSlots.size() * sizeof(uint32_t),
+                             freeSlots.data(),
+                             vk::BufferUsageFlagBits::eTransferSrc);
+  HostBuffer counterStaging(device.handle,
+                            allocator,
+                            sizeof(initialCounters),
+                            initialCounters.data(),
+                            vk::BufferUsageFlagBits::eTransferSrc);
+
+  ComputeBatch upload;
+  upload.copy(freeSlotStaging, *deadList, freeSlotStaging.size)
+      .copy(counterStaging, *counters, counterStaging.size)
+      .fill(*indirectArgs, 0);
+  compute.submit(upload);
+
+  std::vector<vk::DescriptorSetLayoutBinding> layoutBindings;
+  for (uint32_t binding = 0; binding < eBindingCount; binding++) {
+    layoutBindings.push_back(
+        {.binding = binding,
+         .descriptorType = vk::DescriptorType::eStorageBuffer,
+         .descriptorCount = 1,
+         .stageFlags = vk::ShaderStageFlagBits::eCompute});
+  }
+
+  auto createKernel = [&](const char* entryPoint) {
+    const auto shader =
+        std::make_unique<Shader>(&device, "particles", entryPoint);
+    return compute.createKernel(
+        shader->getShaderStageCreateInfo(vk::ShaderStageFlagBits::eCompute),
+        layoutBindings,
+        sizeof(Params),
+        entryPoint);
+  };
+
+  beginFrameKernel = createKernel("beginFrame");
+  emitKernel = createKernel("emit");
+  simulateKernel = createKernel("simulate");
+  endFrameKernel = createKernel("endFrame");
+}
+
+ParticleSystem::~ParticleSystem()
+{
+  compute.destroyKernel(beginFrameKernel);
+  compute.destroyKernel(emitKernel);
+  compute.destroyKernel(simulateKernel);
+  compute.destroyKernel(endFrameKernel);
+}
+
+void ParticleSystem::update(ComputeBatch& batch, float timeStep)
+{
+  if (emitters.size() > maxEmitters) {
+    throw std::runtime_error("Too many particle emitters.");
+  }
+  emitAccumulators.resize(emitters.size(), 0.0F);
+
+  // Turn rates into whole particles per frame, carrying the remainder
+  std::array<EmitterData, maxEmitters> emitterData {};
+  uint32_t requestedEmit = 0;
+  for (size_t i = 0; i < emitters.size(); i++) {
+    const auto& emitter = emitters[i];
+    emitAccumulators[i] += emitter.rate * timeStep;
+    const auto count = static_cast<uint32_t>(emitAccumulators[i]);
+    emitAccumulators[i] -= static_cast<float>(count);
+
+    emitterData[i] = {.position = emitter.position,
+                      .radius = emitter.radius,
+                      .direction = emitter.direction,
+                      .speed = emitter.speed,
+                      .lifetimeMin = emitter.lifetimeMin,
+                      .lifetimeMax = emitter.lifetimeMax,
+                      .firstEmit = requestedEmit,
+                      .emitCount = count};
+    requestedEmit += count;
+  }
+
+  if (!emitters.empty()) {
+    vmaCopyMemoryToAllocation(allocator,
+                              emitterData.data(),
+                              emitterBuffer->allocation,
+                              0,
+                              emitters.size() * sizeof(EmitterData));
+  }
+
+  const Params params {.capacity = settings.capacity,
+                       .current = current,
+                       .requestedEmit = requestedEmit,
+                       .emitterCount = static_cast<uint32_t>(emitters.size()),
+                       .seed = frame++,
+                       .timeStep = timeStep,
+                       .gravity = settings.gravity,
+                       .drag = settings.drag};
+  const auto pushConstants = std::as_bytes(std::span(&params, 1));
+
+  batch.dispatch(beginFrameKernel, bindings(), {}, pushConstants)
+      .dispatchIndirect(
+          emitKernel, bindings(), *indirectArgs, emitArgsOffset, pushConstants)
+      .dispatchIndirect(simulateKernel,
+                        bindings(),
+                        *indirectArgs,
+                        simulateArgsOffset,
+                        pushConstants)
+      .dispatch(endFrameKernel, bindings(), {}, pushConstants);
+
+  current = 1 - current;
+}
+
+auto ParticleSystem::drawItem() const -> DrawItem
+{
+  return {.vertexBuffers = {renderPositions->getHandle(),
+                            renderVelocities->getHandle()},
+          .command = {.type = DrawCommand::Type::eDrawIndirect,
+                      .count = 1,
+                      .arguments = indirectArgs->getHandle(),
+                      .argumentsOffset = drawArgsOffset,
+                      .stride = sizeof(vk::DrawIndirectCommand)}};
+}
+
+auto ParticleSystem::bindings() const -> std::vector<KernelBinding>
+{
+  // Every kernel binds the same set. The emitters are only written by the
+  // host, so they never need a barrier.
+  return {{.binding = eParticles, .buffer = particles.get()},
+          {.binding = eDeadList, .buffer = deadList.get()},
+          {.binding = eAliveLists, .buffer = aliveLists.get()},
+          {.binding = eCounters, .buffer = counters.get()},
+          {.binding = eIndirectArgs, .buffer = indirectArgs.get()},
+          {.binding = eRenderPositions, .buffer = renderPositions.get()},
+          {.binding = eRenderVelocities, .buffer = renderVelocities.get()},
+          {.binding = eEmitters,
+           .buffer = emitterBuffer.get(),
+           .access = BufferAccess::eRead}};
+}
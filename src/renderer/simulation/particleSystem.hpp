@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include "../buffers/deviceBuffer.hpp"
+#include "../buffers/hostBuffer.hpp"
+#include "../compute.hpp"
+#include "../computeBatch.hpp"
+#include "../device.hpp"
+#include "../renderQueue.hpp"
+#include "vk_mem_alloc.h"
+
+struct ParticleEmitter
+{
+  glm::vec3 position {0.0F};
+  float radius = 0.02F;
+  glm::vec3 direction {0.0F, 0.0F, 1.0F};
+  float speed = 1.0F;
+  float lifetimeMin = 1.0F;
+  float lifetimeMax = 2.0F;
+  float rate = 10000.0F;  // Particles per second
+};
+
+struct ParticleSystemSettings
+{
+  uint32_t capacity = 256 * 1024;
+  float gravity = 1.0F;
+  float drag = 0.2F;
+};
+
+// Particles that are spawned, simulated and killed entirely on the GPU.
+//
+// The live particle count never leaves the GPU: particles.slang keeps free
+// and live slots on append/consume lists with atomic counters and writes
+// the arguments for the emit and simulate dispatches and the final draw, so
+// the per-frame cost follows the live count rather than the capacity. The
+// host only decides how many particles each emitter asks for.
+//
+// Survivors are compacted into vertex buffers laid out like graphics.slang
+// VSInput, so drawItem() renders them with the point sprite pipeline.
+class ParticleSystem
+{
+public:
+  static constexpr uint32_t groupSize = 256;  // GROUP_SIZE in particles.slang
+  static constexpr uint32_t maxEmitters = 16;
+
+  ParticleSystem(Device& device,
+                 VmaAllocator& allocator,
+                 Compute& compute,
+                 const ParticleSystemSettings& settings = {});
+  ~ParticleSystem();
+
+  ParticleSystem(const ParticleSystem&) = delete;
+  ParticleSystem& operator=(const ParticleSystem&) = delete;
+  ParticleSystem(ParticleSystem&&) = delete;
+  ParticleSystem& operator=(ParticleSystem&&) = delete;
+
+  // Emission is requested at each emitter's rate; requests beyond the free
+  // capacity are dropped on the GPU.
+  std::vector<ParticleEmitter> emitters;
+
+  // Enqueues emission, simulation and draw argument generation for one
+  // frame. The emitter buffer is written immediately, so the previous
+  // batch must have completed.
+  void update(ComputeBatch& batch, float timeStep);
+
+  // The indirect draw of the live particles, for a pipeline with
+  // graphics.slang's vertex layout
+  [[nodiscard]] auto drawItem() const -> DrawItem;
+
+  [[nodiscard]] auto capacity() const -> uint32_t
+  {
+    return settings.capacity;
+  }
+
+  ParticleSystemSettings settings;
+
+private:
+  // Matches Emitter in particles.slang
+  struct EmitterData
+  {
+    glm::vec3 position;
+    float radius;
+    glm::vec3 direction;
+    float speed;
+    float lifetimeMin;
+    float lifetimeMax;
+    uint32_t firstEmit;
+    uint32_t emitCount;
+  };
+  static_assert(sizeof(EmitterData) == 48);
+
+  // Matches Params in particles.slang
+  struct Params
+  {
+    uint32_t capacity;
+    uint32_t current;
+    uint32_t requestedEmit;
+    uint32_t emitterCount;
+    uint32_t seed;
+    float timeStep;
+    float gravity;
+    float drag;
+  };
+
+  // Byte offsets into the indirect argument buffer
+  static constexpr vk::DeviceSize emitArgsOffset = 0;
+  static constexpr vk::DeviceSize simulateArgsOffset = 16;
+  static constexpr vk::DeviceSize drawArgsOffset = 32;
+
+  VmaAllocator& allocator;
+  Compute& compute;
+
+  KernelHandle beginFrameKernel;
+  KernelHandle emitKernel;
+  KernelHandle simulateKernel;
+  KernelHandle endFrameKernel;
+
+  std::unique_ptr<DeviceBuffer> particles;
+  std::unique_ptr<DeviceBuffer> deadList;
+  std::unique_ptr<DeviceBuffer> aliveLists;
+  std::unique_ptr<DeviceBuffer> counters;
+  std::unique_ptr<DeviceBuffer> indirectArgs;
+  std::unique_ptr<DeviceBuffer> renderPositions;
+  std::unique_ptr<DeviceBuffer> renderVelocities;
+  std::unique_ptr<HostBuffer> emitterBuffer;
+
+  std::vector<float> emitAccumulators;
+  uint32_t current = 0;
+  uint32_t frame = 0;
+
+  [[nodiscard]] auto bindings() const -> std::vector<KernelBinding>;
+};
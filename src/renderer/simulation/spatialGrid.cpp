@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "spatialGrid.hpp"
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "../shader.hpp"
+
+namespace
+{
+// Binding order of the globals in spatialGrid.slang
+enum Binding : uint32_t
+{
+  ePositions,
+  eVelocities,
+  eCellKeys,
+  eParticleIndices,
+  eCellStart,
+  eCellEnd,
+  eSortedPositions,
+  eSortedVelocities,
+  eVelocitiesOut,
+  eBindingCount,
+};
+}  // namespace
+
+SpatialGrid::SpatialGrid(Device& device,
+                         VmaAllocator& allocator,
+                         Compute& compute,
+                         const SpatialGridSettings& settings)
+    : settings(settings)
+    , device(device)
+    , allocator(allocator)
+    , compute(compute)
+    , radixSort(device, allocator, compute)
+{
+  if (settings.tableBits == 0 || settings.tableBits > 30) {
+    throw std::runtime_error("Spatial grid table bits out of range.");
+  }
+
+  const vk::DeviceSize tableSize =
+      (vk::DeviceSize {1} << settings.tableBits) * sizeof(uint32_t);
+  const auto storage = vk::BufferUsageFlagBits::eStorageBuffer;
+  cellStart = std::make_unique<DeviceBuffer>(
+      device.handle, allocator, tableSize, storage);
+  cellEnd = std::make_unique<DeviceBuffer>(
+      device.handle, allocator, tableSize, storage);
+
+  std::vector<vk::DescriptorSetLayoutBinding> layoutBindings;
+  for (uint32_t binding = 0; binding < eBindingCount; binding++) {
+    layoutBindings.push_back(
+        {.binding = binding,
+         .descriptorType = vk::DescriptorType::eStorageBuffer,
+         .descriptorCount = 1,
+         .stageFlags = vk::ShaderStageFlagBits::eCompute});
+  }
+
+  auto createKernel = [&](const char* entryPoint) {
+    const auto shader =
+        std::make_unique<Shader>(&device, "spatialGrid", entryPoint);
+    return compute.createKernel(
+        shader->getShaderStageCreateInfo(vk::ShaderStageFlagBits::eCompute),
+        layoutBindings,
+        sizeof(Params),
+        entryPoint);
+  };
+
+  hashKernel = createKernel("hashParticles");
+  cellBoundsKernel = createKernel("findCellBounds");
+  reorderKernel = createKernel("reorder");
+  collideKernel = createKernel("collide");
+}
+
+SpatialGrid::~SpatialGrid()
+{
+  compute.destroyKernel(hashKernel);
+  compute.destroyKernel(cellBoundsKernel);
+  compute.destroyKernel(reorderKernel);
+  compute.destroyKernel(collideKernel);
+}
+
+void SpatialGrid::build(ComputeBatch& batch,
+                        Buffer& positions,
+                        Buffer& velocities,
+                        uint32_t count)
+{
+  builtPositions = &positions;
+  builtVelocities = &velocities;
+  builtCount = count;
+
+  if (count == 0) {
+    return;
+  }
+
+  reserve(count);
+
+  // The output slot is unused until collide(); bind the sorted velocities
+  const auto groups = GroupCount::cover(count, groupSize);
+  const auto gridParams = params();
+  batch.dispatch(hashKernel, bindings(*sortedVelocities), groups, gridParams);
+  radixSort.sort(
+      batch, *cellKeys, *particleIndices, count, settings.tableBits);
+  batch.fill(*cellStart, 0xffffffffU)
+      .dispatch(
+          cellBoundsKernel, bindings(*sortedVelocities), groups, gridParams)
+      .dispatch(reorderKernel, bindings(*sortedVelocities), groups, gridParams);
+}
+
+void SpatialGrid::collide(ComputeBatch& batch,
+                          Buffer& velocitiesOut,
+                          const CollisionSettings& collision)
+{
+  if (builtCount == 0) {
+    return;
+  }
+  if (collision.particleRadius * 2.0F > settings.cellSize) {
+    throw std::runtime_error("Collision distance exceeds the grid cell size.");
+  }
+
+  batch.dispatch(collideKernel,
+                 bindings(velocitiesOut),
+                 GroupCount::cover(builtCount, groupSize),
+                 params(collision));
+}
+
+void SpatialGrid::reserve(uint32_t particles)
+{
+  if (particles <= capacity) {
+    return;
+  }
+
+  // Steps already in the batch may still use the replaced buffers
+  for (auto* buffer : {&cellKeys,
+                       &particleIndices,
+                       &sortedPositions,
+                       &sortedVelocities})
+  {
+    if (*buffer) {
+      compute.retire(std::move(*buffer));
+    }
+  }
+
+  // Grow geometrically so a slowly rising count rarely reallocates
+  capacity = std::max(particles, capacity * 2);
+
+  const vk::DeviceSize indexSize = capacity * sizeof(uint32_t);
+  const vk::DeviceSize vectorSize = capacity * sizeof(glm::vec4);
+  const auto storage = vk::BufferUsageFlagBits::eStorageBuffer;
+  cellKeys = std::make_unique<DeviceBuffer>(
+      device.handle, allocator, indexSize, storage);
+  particleIndices = std::make_unique<DeviceBuffer>(
+      device.handle, allocator, indexSize, storage);
+  sortedPositions = std::make_unique<DeviceBuffer>(
+      device.handle, allocator, vectorSize, storage);
+  sortedVelocities = std::make_unique<DeviceBuffer>(
+      device.handle, allocator, vectorSize, storage);
+}
+
+auto SpatialGrid::bindings(Buffer& velocitiesOut) const
+    -> std::vector<KernelBinding>
+{
+  return {{.binding = ePositions,
+           .buffer = builtPositions,
+           .access = BufferAccess::eRead},
+          {.binding = eVelocities,
+           .buffer = builtVelocities,
+           .access = BufferAccess::eRead},
+          {.binding = eCellKeys, .buffer = cellKeys.get()},
+          {.binding = eParticleIndices, .buffer = particleIndices.get()},
+          {.binding = eCellStart, .buffer = cellStart.get()},
+          {.binding = eCellEnd, .buffer = cellEnd.get()},
+          {.binding = eSortedPositions, .buffer = sortedPositions.get()},
+          {.binding = eSortedVelocities, .buffer = sortedVelocities.get()},
+          {.binding = eVelocitiesOut, .buffer = &velocitiesOut}};
+}
+
+auto SpatialGrid::params(const CollisionSettings& collision) const -> Params
+{
+  return {.count = builtCount,
+          .tableMask = (1U << settings.tableBits) - 1,
+          .cellSize = settings.cellSize,
+          .particleRadius = collision.particleRadius,
+          .stiffness = collision.stiffness,
+          .damping = collision.damping,
+          .timeStep = collision.timeStep};
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "../buffers/buffer.hpp"
+#include "../buffers/deviceBuffer.hpp"
+#include "../compute.hpp"
+#include "../computeBatch.hpp"
+#include "../device.hpp"
+#include "../primitives/radixSort.hpp"
+#include "vk_mem_alloc.h"
+
+struct SpatialGridSettings
+{
+  float cellSize = 0.02F;  // At least the interaction distance
+  uint32_t tableBits = 18;  // Hash table of 2^tableBits cells
+};
+
+struct CollisionSettings
+{
+  float particleRadius = 0.01F;  // Contact at twice this, <= cellSize
+  float stiffness = 500.0F;
+  float damping = 2.0F;
+  float timeStep = 1.0F / 60.0F;
+};
+
+// Uniform grid hashed into a fixed-size table, rebuilt on the GPU every
+// frame for neighbor queries.
+//
+// build() hashes each particle's cell, sorts the (hash, index) pairs with
+// RadixSort, records where every hash's run starts and ends, and gathers
+// positions and velocities into sorted order. Neighbor kernels then only
+// visit the particles in the 27 cells around each particle, so with the
+// cell size at the interaction distance their cost grows linearly with the
+// particle count rather than quadratically.
+//
+// Positions and velocities are float4 buffers with xyz in use, as written
+// by NBody and ParticleSystem.
+class SpatialGrid
+{
+public:
+  static constexpr uint32_t groupSize = 256;  // GROUP_SIZE in spatialGrid.slang
+
+  SpatialGrid(Device& device,
+              VmaAllocator& allocator,
+              Compute& compute,
+              const SpatialGridSettings& settings = {});
+  ~SpatialGrid();
+
+  SpatialGrid(const SpatialGrid&) = delete;
+  SpatialGrid& operator=(const SpatialGrid&) = delete;
+  SpatialGrid(SpatialGrid&&) = delete;
+  SpatialGrid& operator=(SpatialGrid&&) = delete;
+
+  // Enqueues the grid build for the first count particles. The buffers are
+  // read again by the neighbor kernels, so they must stay alive until the
+  // batch is submitted.
+  void build(ComputeBatch& batch,
+             Buffer& positions,
+             Buffer& velocities,
+             uint32_t count);
+
+  // Enqueues soft-sphere collisions between the particles of the last
+  // build, writing the new velocities in the original particle order.
+  // velocitiesOut must not be the velocities passed to build().
+  void collide(ComputeBatch& batch,
+               Buffer& velocitiesOut,
+               const CollisionSettings& collision = {});
+
+  // Sorted index of the first particle of every hash bucket, or
+  // 0xffffffff when the bucket is empty, and one past the last
+  [[nodiscard]] auto cellStarts() -> DeviceBuffer& { return *cellStart; }
+  [[nodiscard]] auto cellEnds() -> DeviceBuffer& { return *cellEnd; }
+
+  SpatialGridSettings settings;
+
+private:
+  // Matches Params in spatialGrid.slang
+  struct Params
+  {
+    uint32_t count;
+    uint32_t tableMask;
+    float cellSize;
+    float particleRadius;
+    float stiffness;
+    float damping;
+    float timeStep;
+  };
+
+  Device& device;
+  VmaAllocator& allocator;
+  Compute& compute;
+  RadixSort radixSort;
+
+  KernelHandle hashKernel;
+  KernelHandle cellBoundsKernel;
+  KernelHandle reorderKernel;
+  KernelHandle collideKernel;
+
+  std::unique_ptr<DeviceBuffer> cellKeys;
+  std::unique_ptr<DeviceBuffer> particleIndices;
+  std::unique_ptr<DeviceBuffer> cellStart;
+  std::unique_ptr<DeviceBuffer> cellEnd;
+  std::unique_ptr<DeviceBuffer> sortedPositions;
+  std::unique_ptr<DeviceBuffer> sortedVelocities;
+  uint32_t capacity = 0;
+
+  // Inputs of the last build
+  Buffer* builtPositions = nullptr;
+  Buffer* builtVelocities = nullptr;
+  uint32_t builtCount = 0;
+
+  void reserve(uint32_t particles);
+  [[nodiscard]] auto bindings(Buffer& velocitiesOut) const
+      -> std::vector<KernelBinding>;
+  [[nodiscard]] auto params(const CollisionSettings& collision = {}) const
+      -> Params;
+};
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Compact typed reference to an element of a SlotMap<T>. A handle whose slot
+// has since been erased (and possibly reused) is detected as stale through
+// its generation.
+template <typename T>
+struct Handle
+{
+  static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+  uint32_t index = invalidIndex;
+  uint32_t generation = 0;
+
+  [[nodiscard]] auto isValid() const -> bool { return index != invalidIndex; }
+
+  auto operator<=>(const Handle&) const = default;
+};
+
+// Generational slot map. Elements are constructed in place in fixed-size
+// pages, so lookups are an index computation plus a generation compare, and
+// elements never move once created (Buffer relies on this: its address is
+// registered with VMA for defragmentation). Freed slots are reused LIFO to
+// keep the live set dense.
+//
+// Labels are optional debug names and are never consulted on lookup.
+template <typename T, size_t PageSize = 64>
+class SlotMap
+{
+public:
+  SlotMap() = default;
+  ~SlotMap() { clear(); }
+
+  SlotMap(const SlotMap&) = delete;
+  SlotMap& operator=(const SlotMap&) = delete;
+  SlotMap(SlotMap&&) = delete;
+  SlotMap& operator=(SlotMap&&) = delete;
+
+  template <typename... Args>
+  auto emplace(Args&&... args) -> Handle<T>
+  {
+    uint32_t index = 0;
+    if (!freeList.empty()) {
+      index = freeList.back();
+      freeList.pop_back();
+    } else {
+      index = capacity;
+      if (index % PageSize == 0) {
+        pages.push_back(std::make_unique<Slot[]>(PageSize));
+        labels.resize(labels.size() + PageSize);
+      }
+      capacity++;
+    }
+
+    auto& slot = slotAt(index);
+    try {
+      ::new (static_cast<void*>(slot.storage)) T(std::forward<Args>(args)...);
+    } catch (...) {
+      freeList.push_back(index);
+      throw;
+    }
+    slot.occupied = true;
+    count++;
+
+    return {.index = index, .generation = slot.generation};
+  }
+
+  void erase(Handle<T> handle)
+  {
+    auto& slot = checkedSlot(handle);
+    value(slot).~T();
+    slot.occupied = false;
+    slot.generation++;
+    labels[handle.index].clear();
+    freeList.push_back(handle.index);
+    count--;
+  }
+
+  // Throws std::out_of_range for stale or invalid handles.
+  auto get(Handle<T> handle) -> T& { return value(checkedSlot(handle)); }
+
+  auto get(Handle<T> handle) const -> const T&
+  {
+    return value(checkedSlot(handle));
+  }
+
+  // Returns nullptr for stale or invalid handles.
+  auto find(Handle<T> handle) -> T*
+  {
+    if (!contains(handle)) {
+      return nullptr;
+    }
+    return &value(slotAt(handle.index));
+  }
+
+  [[nodiscard]] auto contains(Handle<T> handle) const -> bool
+  {
+    if (handle.index >= capacity) {
+      return false;
+    }
+    const auto& slot = slotAt(handle.index);
+    return slot.occupied && slot.generation == handle.generation;
+  }
+
+  void setLabel(Handle<T> handle, std::string label)
+  {
+    checkedSlot(handle);
+    labels[handle.index] = std::move(label);
+  }
+
+  [[nodiscard]] auto label(Handle<T> handle) const -> const std::string&
+  {
+    checkedSlot(handle);
+    return labels[handle.index];
+  }
+
+  // fn is called with either (T&) or (Handle<T>, T&).
+  template <typename F>
+  void forEach(F&& fn)
+  {
+    for (uint32_t i = 0; i < capacity; i++) {
+      auto& slot = slotAt(i);
+      if (!slot.occupied) {
+        continue;
+      }
+      if constexpr (std::is_invocable_v<F&, Handle<T>, T&>) {
+        fn(Handle<T> {.index = i, .generation = slot.generation}, value(slot));
+      } else {
+        fn(value(slot));
+      }
+    }
+  }
+
+  void clear()
+  {
+    for (uint32_t i = 0; i < capacity; i++) {
+      auto& slot = slotAt(i);
+      if (slot.occupied) {
+        erase({.index = i, .generation = slot.generation});
+      }
+    }
+  }
+
+  [[nodiscard]] auto size() const -> size_t { return count; }
+
+  [[nodiscard]] auto empty() const -> bool { return count == 0; }
+
+private:
+  struct Slot
+  {
+    alignas(T) std::byte storage[sizeof(T)];
+    uint32_t generation = 0;
+    bool occupied = false;
+  };
+
+  std::vector<std::unique_ptr<Slot[]>> pages;
+  std::vector<std::string> labels;
+  std::vector<uint32_t> freeList;
+  uint32_t capacity = 0;
+  size_t count = 0;
+
+  auto slotAt(uint32_t index) -> Slot&
+  {
+    return pages[index / PageSize][index % PageSize];
+  }
+
+  auto slotAt(uint32_t index) const -> const Slot&
+  {
+    return pages[index / PageSize][index % PageSize];
+  }
+
+  auto checkedSlot(Handle<T> handle) -> Slot&
+  {
+    if (!contains(handle)) {
+      throw std::out_of_range("Stale or invalid resource handle.");
+    }
+    return slotAt(handle.index);
+  }
+
+  auto checkedSlot(Handle<T> handle) const -> const Slot&
+  {
+    if (!contains(handle)) {
+      throw std::out_of_range("Stale or invalid resource handle.");
+    }
+    return slotAt(handle.index);
+  }
+
+  static auto value(Slot& slot) -> T&
+  {
+    return *std::launder(reinterpret_cast<T*>(slot.storage));
+  }
+
+  static auto value(const Slot& slot) -> const T&
+  {
+    return *std::launder(reinterpret_cast<const T*>(slot.storage));
+  }
+};
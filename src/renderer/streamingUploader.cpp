@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#include "streamingUploader.hpp"
+
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+auto secondsSince(Clock::time_point start) -> double
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Reads one byte per page so that page faults (i.e. disk reads) are timed
+// separately from the copy into staging memory.
+void faultIn(std::span<const std::byte> range)
+{
+  constexpr size_t pageSize = 4096;
+  volatile std::byte sink {};
+  for (size_t offset = 0; offset < range.size(); offset += pageSize) {
+    sink = range[offset];
+  }
+  (void)sink;
+}
+}  // namespace
+
+StreamingUploader::StreamingUploader(vk::Device& device,
+                                     VmaAllocator& allocator,
+                                     uint32_t queueFamilyIndex,
+                                     vk::DeviceSize chunkSize)
+    : device(device)
+    , allocator(allocator)
+    , chunkSize(chunkSize)
+{
+  device.getQueue(queueFamilyIndex, 0, &queue);
+
+  commandPool = device.createCommandPool(
+      {.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+       .queueFamilyIndex = queueFamilyIndex});
+
+  const auto commandBuffers = device.allocateCommandBuffers(
+      {.commandPool = commandPool,
+       .level = vk::CommandBufferLevel::ePrimary,
+       .commandBufferCount = static_cast<uint32_t>(slotCount)});
+
+  for (size_t i = 0; i < slotCount; i++) {
+    slots[i].staging =
+        std::make_unique<HostBuffer>(device,
+                                     allocator,
+                                     chunkSize,
+                                     nullptr,
+                                     vk::BufferUsageFlagBits::eTransferSrc);
+    slots[i].commandBuffer = commandBuffers[i];
+    slots[i].fence =
+        device.createFence({.flags = vk::FenceCreateFlagBits::eSignaled});
+  }
+}
+
+StreamingUploader::~StreamingUploader()
+{
+  for (auto& slot : slots) {
+    (void)device.waitForFences(slot.fence, vk::True, UINT64_MAX);
+    device.destroyFence(slot.fence);
+    device.freeCommandBuffers(commandPool, slot.commandBuffer);
+    slot.staging.reset();
+  }
+  device.destroyCommandPool(commandPool);
+}
+
+auto StreamingUploader::upload(const MappedFile& file,
+                               Buffer& destination,
+                               vk::DeviceSize dstOffset,
+                               const ProgressCallback& progress)
+    -> UploadProgress
+{
+  file.adviseSequential();
+  return upload(file.bytes(), destination, dstOffset, progress, &file);
+}
+
+auto StreamingUploader::upload(std::span<const std::byte> source,
+                               Buffer& destination,
+                               vk::DeviceSize dstOffset,
+                               const ProgressCallback& progress,
+                               const MappedFile* file) -> UploadProgress
+{
+  if (dstOffset + source.size() > destination.size) {
+    throw std::runtime_error("Upload does not fit in destination buffer.");
+  }
+
+  UploadProgress stats {.totalBytes = source.size()};
+  const auto start = Clock::now();
+
+  if (file != nullptr) {
+    file->prefetch(0, 2 * chunkSize);
+  }
+
+  size_t chunkIndex = 0;
+  for (size_t offset = 0; offset < source.size(); offset += chunkSize) {
+    const auto length = std::min<size_t>(chunkSize, source.size() - offset);
+    const auto chunk = source.subspan(offset, length);
+    auto& slot = slots[chunkIndex++ % slotCount];
+
+    // The slot is free once the copy submitted from it two chunks ago is done
+    auto waitStart = Clock::now();
+    if (device.waitForFences(slot.fence, vk::True, UINT64_MAX)
+        != vk::Result::eSuccess)
+    {
+      throw std::runtime_error("Failed to wait for fence.");
+    }
+    stats.waitSeconds += secondsSince(waitStart);
+    device.resetFences(slot.fence);
+
+    // Keep the OS reading ahead of us while this chunk is consumed
+    if (file != nullptr) {
+      file->prefetch(offset + 2 * chunkSize, chunkSize);
+    }
+
+    auto readStart = Clock::now();
+    faultIn(chunk);
+    stats.readSeconds += secondsSince(readStart);
+
+    auto copyStart = Clock::now();
+    vmaCopyMemoryToAllocation(
+        allocator, chunk.data(), slot.staging->allocation, 0, length);
+    stats.copySeconds += secondsSince(copyStart);
+
+    slot.commandBuffer.begin(
+        {.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+    slot.commandBuffer.copyBuffer(
+        slot.staging->getHandle(),
+        destination.getHandle(),
+        {{.srcOffset = 0, .dstOffset = dstOffset + offset, .size = length}});
+
+    vk::MemoryBarrier memoryBarrier {
+        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .dstAccessMask =
+            vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite};
+    slot.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                       vk::PipelineStageFlagBits::eAllCommands,
+                                       {},
+                                       memoryBarrier,
+                                       nullptr,
+                                       nullptr);
+    slot.commandBuffer.end();
+
+    queue.submit(vk::SubmitInfo {.commandBufferCount = 1,
+                                 .pCommandBuffers = &slot.commandBuffer},
+                 slot.fence);
+
+    // The source pages are in staging memory now and will not be read again
+    if (file != nullptr) {
+      file->release(offset, length);
+    }
+
+    stats.bytesUploaded += length;
+    stats.seconds = secondsSince(start);
+    if (progress) {
+      progress(stats);
+    }
+  }
+
+  auto waitStart = Clock::now();
+  for (const auto& slot : slots) {
+    if (device.waitForFences(slot.fence, vk::True, UINT64_MAX)
+        != vk::Result::eSuccess)
+    {
+      throw std::runtime_error("Failed to wait for fence.");
+    }
+  }
+  stats.waitSeconds += secondsSince(waitStart);
+  stats.seconds = secondsSince(start);
+
+  return stats;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include "buffers/buffer.hpp"
+#include "buffers/hostBuffer.hpp"
+#include "mappedFile.hpp"
+#include "vk_mem_alloc.h"
+
+struct UploadProgress
+{
+  size_t bytesUploaded = 0;
+  size_t totalBytes = 0;
+  double seconds = 0.0;
+  // Time spent faulting source pages in from the file
+  double readSeconds = 0.0;
+  // Time spent copying resident pages into staging memory
+  double copySeconds = 0.0;
+  // Time spent waiting for a staging slot to be released by the GPU
+  double waitSeconds = 0.0;
+
+  [[nodiscard]] auto megabytesPerSecond() const -> double
+  {
+    return seconds > 0.0 ? static_cast<double>(bytesUploaded) / 1.0e6 / seconds
+                         : 0.0;
+  }
+
+  // Totals of uploads done one after the other
+  auto operator+=(const UploadProgress& other) -> UploadProgress&
+  {
+    bytesUploaded += other.bytesUploaded;
+    totalBytes += other.totalBytes;
+    seconds += other.seconds;
+    readSeconds += other.readSeconds;
+    copySeconds += other.copySeconds;
+    waitSeconds += other.waitSeconds;
+    return *this;
+  }
+};
+
+// Streams large files into device buffers through a double-buffered staging
+// area. While the GPU transfers one chunk out of a staging slot, the next
+// chunk is read from the mapped file into the other slot, and the OS is asked
+// to read ahead the one after that.
+class StreamingUploader
+{
+public:
+  using ProgressCallback = std::function<void(const UploadProgress&)>;
+
+  StreamingUploader(vk::Device& device,
+                    VmaAllocator& allocator,
+                    uint32_t queueFamilyIndex,
+                    vk::DeviceSize chunkSize = 8ULL * 1024 * 1024);
+  ~StreamingUploader();
+
+  StreamingUploader(const StreamingUploader&) = delete;
+  StreamingUploader& operator=(const StreamingUploader&) = delete;
+  StreamingUploader(StreamingUploader&&) = delete;
+  StreamingUploader& operator=(StreamingUploader&&) = delete;
+
+  // Copies the whole file into destination at dstOffset and blocks until the
+  // last chunk has landed. progress is called after every chunk.
+  auto upload(const MappedFile& file,
+              Buffer& destination,
+              vk::DeviceSize dstOffset = 0,
+              const ProgressCallback& progress = {}) -> UploadProgress;
+
+  // Same, for any range of host memory.
+  auto upload(std::span<const std::byte> source,
+              Buffer& destination,
+              vk::DeviceSize dstOffset = 0,
+              const ProgressCallback& progress = {},
+              const MappedFile* file = nullptr) -> UploadProgress;
+
+private:
+  static constexpr size_t slotCount = 2;
+
+  struct Slot
+  {
+    std::unique_ptr<HostBuffer> staging;
+    vk::CommandBuffer commandBuffer;
+    vk::Fence fence;
+  };
+
+  vk::Device& device;
+  VmaAllocator& allocator;
+  vk::DeviceSize chunkSize;
+  vk::Queue queue;
+  vk::CommandPool commandPool;
+  std::array<Slot, slotCount> slots;
+};
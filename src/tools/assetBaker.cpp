@@ -0,0 +1,111 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/base.h>
+#include <vulkan/vulkan.hpp>
+
+#include "assets/assetWriter.hpp"
+#include "images/proceduralTextures.hpp"
+#include "mappedFile.hpp"
+#include "scene/clusterScene.hpp"
+#include "scene/gpuScene.hpp"
+#include "scene/mesh.hpp"
+#include "shader.hpp"
+#include "simulation/nbody.hpp"
+
+namespace
+{
+
+// Splits <module>.slang.<entry point>.spv into its pack name
+auto shaderName(const std::filesystem::path& path) -> std::string
+{
+  constexpr std::string_view marker = ".slang.";
+  const auto stem = path.stem().string();
+  const auto separator = stem.find(marker);
+  if (path.extension() != ".spv" || separator == std::string::npos) {
+    throw std::runtime_error("Not a compiled shader: " + path.string());
+  }
+  return Shader::assetName(stem.substr(0, separator),
+                           stem.substr(separator + marker.size()));
+}
+
+}  // namespace
+
+// Usage: asset-baker <output pack> [SPIR-V files...]
+//
+// Bakes the renderer's meshes, textures, galaxy and shaders into an asset
+// pack the renderer maps at startup, so loading them is a straight copy:
+//
+//   cube, sphere  GpuScene meshes, with their levels of detail optimized
+//                 and packed
+//   moon          ClusterScene mesh, optimized, split into meshlets and
+//                 packed
+//   particle,     the renderer's textures with their full mip chains
+//   gradient
+//   galaxy        NBody's initial state for the default settings, which the
+//                 renderer streams into its buffers
+//   module.entry  each <module>.slang.<entry>.spv given, which Shader
+//                 creates its modules from
+int main(int argc, char** argv)
+{
+  if (argc < 2) {
+    fmt::println(stderr, "Usage: {} <output pack> [SPIR-V files...]", argv[0]);
+    return 1;
+  }
+
+  try {
+    AssetWriter writer;
+    writer.addSceneMesh("cube", buildSceneMesh(makeCube()));
+    writer.addSceneMesh("sphere", buildSceneMesh(makeIcosphere(2)));
+
+    writer.addClusterMesh("moon", buildClusterMesh(makeIcosphere(5)));
+
+    const auto addTexture = [&](const char* name,
+                                uint32_t width,
+                                uint32_t height,
+                                std::span<const std::array<uint8_t, 4>> texels)
+    {
+      const auto chain = makeMipChain(width, height, texels);
+      std::vector<std::span<const std::byte>> levels;
+      for (const auto& level : chain) {
+        levels.emplace_back(level);
+      }
+      writer.addTexture(name,
+                        {.width = width, .height = height},
+                        vk::Format::eR8G8B8A8Unorm,
+                        levels);
+    };
+    // Sizes as the renderer generates them without a pack
+    constexpr uint32_t spriteSize = 256;
+    addTexture(
+        "particle", spriteSize, spriteSize, makeParticleSprite(spriteSize));
+    constexpr uint32_t rampSize = 256;
+    addTexture("gradient", rampSize, 1, makeSpeedRamp(rampSize));
+
+    writer.addGalaxy("galaxy", makeGalaxy({}));
+
+    // Mapped until written
+    std::vector<std::unique_ptr<MappedFile>> shaders;
+    for (int i = 2; i < argc; i++) {
+      shaders.push_back(std::make_unique<MappedFile>(argv[i]));
+      writer.addShader(shaderName(argv[i]), shaders.back()->bytes());
+    }
+
+    const auto size = writer.write(argv[1]);
+    fmt::println(
+        "Baked {} assets into {} ({} KB)", writer.size(), argv[1], size / 1024);
+  } catch (const std::exception& error) {
+    fmt::println(stderr, "asset-baker: {}", error.what());
+    return 1;
+  }
+  return 0;
+}